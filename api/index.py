@@ -6,6 +6,8 @@ from flask_sock import Sock
 import json
 from datetime import datetime
 
+import sensor_packet
+
 # Carrega as variáveis de ambiente do arquivo .env
 load_dotenv()
 
@@ -22,6 +24,159 @@ db_config = {
 }
 
 
+boots = sensor_packet.BootTracker()
+
+
+def store_feature_packet(header, payload):
+    features = sensor_packet.parse_features(payload)
+    timestamp = (header['capture_time_us'] + boots.offset_us(header)) // 1000
+    duration_ms = header['sample_count'] * 1000 // header['sample_rate_hz']
+
+    conn = mysql.connector.connect(**db_config)
+    cursor = conn.cursor()
+    try:
+        cursor.execute(
+            "INSERT INTO mic_features (timestamp, duration_ms, rms, peak, zcr, band0_db, band1_db, band2_db, band3_db) "
+            "VALUES (%s, %s, %s, %s, %s, %s, %s, %s, %s)",
+            (timestamp, duration_ms, features['rms'], features['peak'], features['zcr'], *features['bands_db'])
+        )
+        conn.commit()
+    finally:
+        cursor.close()
+        conn.close()
+
+
+def store_heartbeat_packet(header, payload):
+    stats = sensor_packet.parse_heartbeat(payload)
+    timestamp = (header['capture_time_us'] + boots.offset_us(header)) // 1000
+    duration_ms = stats['blocks'] * sensor_packet.SAMPLES_PER_BLOCK * 1000 // header['sample_rate_hz']
+
+    conn = mysql.connector.connect(**db_config)
+    cursor = conn.cursor()
+    try:
+        cursor.execute(
+            "INSERT INTO mic_heartbeat (timestamp, duration_ms, floor_rms, rms_min, rms_mean, rms_max, peak, events) "
+            "VALUES (%s, %s, %s, %s, %s, %s, %s, %s)",
+            (timestamp, duration_ms, stats['floor_rms'], stats['rms_min'], stats['rms_mean'],
+             stats['rms_max'], stats['peak'], stats['events'])
+        )
+        conn.commit()
+    finally:
+        cursor.close()
+        conn.close()
+
+
+def store_timing_packet(header, payload):
+    summaries = sensor_packet.parse_timing(payload)
+    timestamp = (header['capture_time_us'] + boots.offset_us(header)) // 1000
+
+    conn = mysql.connector.connect(**db_config)
+    cursor = conn.cursor()
+    try:
+        cursor.executemany(
+            "INSERT INTO mic_timing (boot_id, timestamp, metric, count, min_ns, max_ns, p50_ns, p99_ns, p999_ns, overflow) "
+            "VALUES (%s, %s, %s, %s, %s, %s, %s, %s, %s, %s)",
+            [(header['boot_id'], timestamp, metric, *(s[f] for f in sensor_packet.TIMING_SUMMARY_FIELDS))
+             for metric, s in summaries.items()]
+        )
+        conn.commit()
+    finally:
+        cursor.close()
+        conn.close()
+
+
+def store_telemetry_packet(header, payload):
+    stats = sensor_packet.parse_telemetry(payload)
+    timestamp = (header['capture_time_us'] + boots.offset_us(header)) // 1000
+    columns = ('boot_id', 'timestamp', 'uptime_ms') + sensor_packet.TELEMETRY_FIELDS + ('send_latency',)
+    values = (header['boot_id'], timestamp, header['capture_time_us'] // 1000,
+              *(stats[f] for f in sensor_packet.TELEMETRY_FIELDS), json.dumps(stats['send_latency']))
+
+    conn = mysql.connector.connect(**db_config)
+    cursor = conn.cursor()
+    try:
+        cursor.execute(
+            f"INSERT INTO telemetry ({', '.join(columns)}) VALUES ({', '.join(['%s'] * len(columns))})",
+            values
+        )
+        conn.commit()
+    finally:
+        cursor.close()
+        conn.close()
+
+
+def store_packet(raw_data, frame_flags=0):
+    header = sensor_packet.parse_header(raw_data)
+    # O BACKFILL do quadro vale para os pacotes dentro dele.
+    header['flags'] |= frame_flags & sensor_packet.FLAG_BACKFILL
+    if header['type'] in (sensor_packet.PACKET_TYPE_AUDIO, sensor_packet.PACKET_TYPE_FEATURES) \
+            and not header['flags'] & sensor_packet.FLAG_BACKFILL:
+        previous = boots.check_quality(header)
+        if previous is not None:
+            names = sensor_packet.QUALITY_NAMES
+            print(f"ℹ️ Boot {header['boot_id']:08x}: qualidade do áudio "
+                  f"{names[previous]} -> {names[header['quality']]} na sequência {header['sequence']}")
+    if header['type'] == sensor_packet.PACKET_TYPE_FEATURES:
+        # Uma janela cobre vários blocos, então a sequência não é contínua.
+        store_feature_packet(header, raw_data[sensor_packet.HEADER_SIZE:])
+        return
+    if header['type'] == sensor_packet.PACKET_TYPE_HEARTBEAT:
+        store_heartbeat_packet(header, raw_data[sensor_packet.HEADER_SIZE:])
+        return
+    if header['type'] == sensor_packet.PACKET_TYPE_TIMING:
+        store_timing_packet(header, raw_data[sensor_packet.HEADER_SIZE:])
+        return
+    if header['type'] == sensor_packet.PACKET_TYPE_TELEMETRY:
+        store_telemetry_packet(header, raw_data[sensor_packet.HEADER_SIZE:])
+        return
+    if header['type'] != sensor_packet.PACKET_TYPE_AUDIO:
+        raise sensor_packet.PacketError(f"Tipo de pacote desconhecido: {header['type']}")
+
+    # Pacotes reenviados pelo spool chegam fora de ordem, intercalados com os
+    # ao vivo; entram pelo timestamp de captura e não contam para buracos.
+    if not header['flags'] & sensor_packet.FLAG_BACKFILL:
+        gap = boots.check_gap(header)
+        # No modo com portão o silêncio entre eventos não é perda.
+        if gap and not header['flags'] & sensor_packet.FLAG_EVENT_START:
+            print(f"⚠️ Boot {header['boot_id']:08x}: {gap} blocos perdidos antes da sequência {header['sequence']}")
+
+    samples = sensor_packet.decode_samples(header, raw_data[sensor_packet.HEADER_SIZE:])
+    rows = sensor_packet.sample_rows(header, samples, boots.offset_us(header))
+
+    conn = mysql.connector.connect(**db_config)
+    cursor = conn.cursor()
+    try:
+        cursor.executemany("INSERT INTO data (sample, timestamp, type) VALUES (%s, %s, %s)", rows)
+        conn.commit()
+    finally:
+        cursor.close()
+        conn.close()
+
+
+def store_binary_message(raw_data):
+    """Um decodificador para tudo: quadros multiplexados e pacotes avulsos."""
+    frame, records = sensor_packet.parse_frame(raw_data)
+    rows = []
+    for record_type, value in records:
+        sample_type = sensor_packet.RECORD_SENSOR_TYPES.get(record_type)
+        if sample_type is None:
+            store_packet(value, frame['flags'])
+            continue
+        timestamp, sample = sensor_packet.parse_scalar(value)
+        rows.append((sample, timestamp, sample_type))
+    if not rows:
+        return
+
+    conn = mysql.connector.connect(**db_config)
+    cursor = conn.cursor()
+    try:
+        cursor.executemany("INSERT INTO data (sample, timestamp, type) VALUES (%s, %s, %s)", rows)
+        conn.commit()
+    finally:
+        cursor.close()
+        conn.close()
+
+
 @sock.route('/ws')
 def websocket(ws):
     print("Conectou")
@@ -30,6 +185,17 @@ def websocket(ws):
         if raw_data is None:
             break
 
+        if isinstance(raw_data, (bytes, bytearray)):
+            # Quadros binários (áudio, estatísticas e leituras), sem resposta
+            # para não gerar tráfego de volta a cada bloco.
+            try:
+                store_binary_message(bytes(raw_data))
+            except sensor_packet.PacketError as e:
+                print("⚠️ Pacote binário inválido:", e)
+            except mysql.connector.Error as err:
+                print("Erro ao gravar pacote binário:", err)
+            continue
+
         try:
             brute_data = json.loads(raw_data) # Dados sem formato
             data = brute_data.get("data", [])
@@ -103,6 +269,36 @@ def get_mic():
         conn.close()
 
 
+@app.route('/microphone/features', methods=['GET'])
+def get_mic_features():
+    try:
+        conn = mysql.connector.connect(**db_config)
+        cursor = conn.cursor(dictionary=True)
+        cursor.execute("SELECT * FROM mic_features ORDER BY timestamp ASC")
+        dados = cursor.fetchall()
+        return jsonify(dados)
+    except mysql.connector.Error as err:
+        return jsonify({'error': str(err)}), 500
+    finally:
+        cursor.close()
+        conn.close()
+
+
+@app.route('/telemetry', methods=['GET'])
+def get_telemetry():
+    try:
+        conn = mysql.connector.connect(**db_config)
+        cursor = conn.cursor(dictionary=True)
+        cursor.execute("SELECT * FROM telemetry ORDER BY timestamp ASC")
+        dados = cursor.fetchall()
+        return jsonify(dados)
+    except mysql.connector.Error as err:
+        return jsonify({'error': str(err)}), 500
+    finally:
+        cursor.close()
+        conn.close()
+
+
 @app.route('/luminosity', methods=['GET'])
 def get_lum():
     try:
@@ -0,0 +1,339 @@
+import struct
+import time
+
+# Espelha SensorPacketHeader em esp/main/sensor_manager.h (little-endian)
+HEADER_FORMAT = '<BBBBHHIIQq'
+HEADER_SIZE = struct.calcsize(HEADER_FORMAT)
+
+PACKET_VERSION = 1
+SAMPLES_PER_BLOCK = 500  # NOISE_SAMPLES_PER_PACKET
+PACKET_TYPE_AUDIO = 1
+PACKET_TYPE_FEATURES = 2
+PACKET_TYPE_HEARTBEAT = 3
+PACKET_TYPE_TIMING = 4
+PACKET_TYPE_TELEMETRY = 5
+
+FLAG_EVENT_START = 0x10
+FLAG_BACKFILL = 0x20
+
+# Espelha SensorFrameHeader/SensorRecordHeader em esp/main/sensor_frame.h
+FRAME_VERSION = 2
+FRAME_HEADER_FORMAT = '<BBBBI'
+FRAME_HEADER_SIZE = struct.calcsize(FRAME_HEADER_FORMAT)
+RECORD_HEADER_FORMAT = '<BBH'
+RECORD_HEADER_SIZE = struct.calcsize(RECORD_HEADER_FORMAT)
+# Registros escalares (SensorScalarRecord): timestamp UTC em ms e valor
+SCALAR_FORMAT = '<qi'
+SCALAR_SIZE = struct.calcsize(SCALAR_FORMAT)
+RECORD_SENSOR_TYPES = {
+    16: 'luminosity',   # SENSOR_RECORD_LUMINOSITY
+    17: 'temperature',  # SENSOR_RECORD_TEMPERATURE
+    18: 'humidity',     # SENSOR_RECORD_HUMIDITY
+}
+
+# Espelha AudioFeatures em esp/main/audio_features.h
+FEATURES_FORMAT = '<HHH4h'
+FEATURES_SIZE = struct.calcsize(FEATURES_FORMAT)
+
+# Espelha NoiseGateStats em esp/main/noise_gate.h (RMS em 1/16 LSB)
+HEARTBEAT_FORMAT = '<7H'
+HEARTBEAT_SIZE = struct.calcsize(HEARTBEAT_FORMAT)
+
+# Espelha TimingSummary em esp/main/timing_hist.h (tempos em ns)
+TIMING_SUMMARY_FORMAT = '<7I'
+TIMING_SUMMARY_SIZE = struct.calcsize(TIMING_SUMMARY_FORMAT)
+TIMING_SUMMARY_FIELDS = ('count', 'min_ns', 'max_ns', 'p50_ns', 'p99_ns', 'p999_ns', 'overflow')
+
+# Espelha TelemetryStats em esp/main/telemetry.h
+TELEMETRY_LATENCY_BUCKETS = 20
+TELEMETRY_FORMAT = f'<12I3HbB{TELEMETRY_LATENCY_BUCKETS}I'
+TELEMETRY_SIZE = struct.calcsize(TELEMETRY_FORMAT)
+TELEMETRY_FIELDS = (
+    'produced', 'sent', 'drop_ring', 'drop_pool',
+    # Quadros do DMA do ADC descartados pelo driver (pool cheio)
+    'drop_adc',
+    # Fila da task escritora cheia, por classe (ws_class_t)
+    'drop_queue_audio', 'drop_queue_stats', 'drop_queue_env',
+    'drop_ws_offline', 'drop_ws_error',
+    'heap_free', 'heap_min_free', 'ring_high_water', 'pool_min_free', 'reconnects', 'rssi',
+    'quality',
+)
+
+# quality_level_t em esp/main/quality_ctl.h (campo quality do cabeçalho)
+QUALITY_FULL = 0
+QUALITY_NAMES = ('completo', '4 kHz', '4 kHz ADPCM', 'características')
+
+CODEC_MASK = 0x0F
+CODEC_RAW = 0
+CODEC_ADPCM = 1
+CODEC_RICE = 2
+
+# Delta + Rice, igual a esp/main/rice_codec.c
+RICE_PARTITION = 32
+RICE_ESCAPE = 24
+RICE_ESCAPE_BITS = 17
+
+# IMA-ADPCM, igual a esp/main/adpcm.c
+ADPCM_INDEX_TABLE = [-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8]
+ADPCM_STEP_TABLE = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767,
+]
+ADPCM_BLOCK_HEADER = '<hBB'
+ADC_MIDPOINT = 2048
+
+
+class PacketError(ValueError):
+    pass
+
+
+def parse_header(raw):
+    if len(raw) < HEADER_SIZE:
+        raise PacketError("Pacote menor que o cabeçalho")
+
+    (version, packet_type, flags, quality, sample_count, sample_rate_hz,
+     boot_id, sequence, capture_time_us, epoch_offset_us) = struct.unpack_from(HEADER_FORMAT, raw)
+
+    if version != PACKET_VERSION:
+        raise PacketError(f"Versão de pacote desconhecida: {version}")
+
+    return {
+        'version': version,
+        'type': packet_type,
+        'flags': flags,
+        'quality': quality,
+        'sample_count': sample_count,
+        'sample_rate_hz': sample_rate_hz,
+        'boot_id': boot_id,
+        'sequence': sequence,
+        'capture_time_us': capture_time_us,
+        'epoch_offset_us': epoch_offset_us,
+    }
+
+
+def parse_frame(raw):
+    """Separa uma mensagem binária em registros (tipo, valor). Os tipos
+    PACKET_TYPE_* trazem o pacote inteiro; os de RECORD_SENSOR_TYPES, um
+    escalar. Um pacote avulso (versão 1) vira um quadro de um registro."""
+    if not raw:
+        raise PacketError("Mensagem vazia")
+    if raw[0] == PACKET_VERSION:
+        header = parse_header(raw)
+        return {'flags': header['flags'], 'boot_id': header['boot_id']}, [(header['type'], raw)]
+    if raw[0] != FRAME_VERSION:
+        raise PacketError(f"Versão de quadro desconhecida: {raw[0]}")
+    if len(raw) < FRAME_HEADER_SIZE:
+        raise PacketError("Quadro menor que o cabeçalho")
+
+    _version, count, flags, _reserved, boot_id = struct.unpack_from(FRAME_HEADER_FORMAT, raw)
+    records = []
+    pos = FRAME_HEADER_SIZE
+    for _ in range(count):
+        if pos + RECORD_HEADER_SIZE > len(raw):
+            raise PacketError("Registro truncado")
+        record_type, _reserved, length = struct.unpack_from(RECORD_HEADER_FORMAT, raw, pos)
+        pos += RECORD_HEADER_SIZE
+        if pos + length > len(raw):
+            raise PacketError("Valor de registro truncado")
+        records.append((record_type, raw[pos:pos + length]))
+        pos += length
+    return {'flags': flags, 'boot_id': boot_id}, records
+
+
+def parse_scalar(value):
+    if len(value) < SCALAR_SIZE:
+        raise PacketError("Registro escalar truncado")
+    timestamp_ms, sample = struct.unpack_from(SCALAR_FORMAT, value)
+    return timestamp_ms, sample
+
+
+def adpcm_decode(predictor, index, codes, count):
+    samples = []
+    for i in range(count):
+        code = codes[i // 2] >> 4 if i & 1 else codes[i // 2] & 0x0F
+        step = ADPCM_STEP_TABLE[index]
+        vpdiff = step >> 3
+        if code & 4:
+            vpdiff += step
+        if code & 2:
+            vpdiff += step >> 1
+        if code & 1:
+            vpdiff += step >> 2
+        predictor = predictor - vpdiff if code & 8 else predictor + vpdiff
+        predictor = max(-32768, min(32767, predictor))
+        index = max(0, min(88, index + ADPCM_INDEX_TABLE[code]))
+        samples.append(predictor)
+    return samples
+
+
+def decode_adpcm_payload(count, payload):
+    block_size = struct.calcsize(ADPCM_BLOCK_HEADER)
+    if len(payload) < block_size + (count + 1) // 2:
+        raise PacketError("Payload ADPCM truncado")
+    predictor, index, _ = struct.unpack_from(ADPCM_BLOCK_HEADER, payload)
+    pcm = adpcm_decode(predictor, index, payload[block_size:], count)
+    # Desfaz a centralização feita no ESP32 (12 bits sem sinal -> PCM 16 bits)
+    return [max(0, min(4095, round(v / 16) + ADC_MIDPOINT)) for v in pcm]
+
+
+class BitReader:
+    def __init__(self, data, pos=0):
+        self.data = data
+        self.bit = pos * 8
+
+    def read(self, bits):
+        value = 0
+        for _ in range(bits):
+            byte = self.bit >> 3
+            if byte >= len(self.data):
+                raise PacketError("Payload Rice truncado")
+            value = (value << 1) | ((self.data[byte] >> (7 - (self.bit & 7))) & 1)
+            self.bit += 1
+        return value
+
+    def read_unary(self):
+        q = 0
+        while self.read(1):
+            q += 1
+        return q
+
+
+def decode_rice_payload(count, payload):
+    if count == 0:
+        return []
+    if len(payload) < 2:
+        raise PacketError("Payload Rice truncado")
+    samples = [struct.unpack_from('<h', payload)[0]]
+    reader = BitReader(payload, 2)
+
+    start = 1
+    while start < count:
+        k = reader.read(4)
+        for _ in range(min(RICE_PARTITION, count - start)):
+            q = reader.read_unary()
+            u = reader.read(RICE_ESCAPE_BITS) if q >= RICE_ESCAPE else (q << k) | reader.read(k)
+            delta = (u >> 1) ^ -(u & 1)
+            # Mesmo estouro de int16 que o C
+            samples.append(((samples[-1] + delta + 32768) & 0xFFFF) - 32768)
+        start += RICE_PARTITION
+    return samples
+
+
+def decode_samples(header, payload):
+    count = header['sample_count']
+    codec = header['flags'] & CODEC_MASK
+
+    if codec == CODEC_ADPCM:
+        return decode_adpcm_payload(count, payload)
+    if codec == CODEC_RICE:
+        return decode_rice_payload(count, payload)
+    if codec != CODEC_RAW:
+        raise PacketError(f"Codec desconhecido: {codec}")
+
+    if len(payload) < count * 2:
+        raise PacketError("Payload menor que sample_count")
+    return list(struct.unpack_from(f'<{count}h', payload))
+
+
+def parse_features(payload):
+    if len(payload) < FEATURES_SIZE:
+        raise PacketError("Payload de características truncado")
+    rms, peak, zcr, *bands = struct.unpack_from(FEATURES_FORMAT, payload)
+    return {
+        'rms': rms,
+        'peak': peak,
+        'zcr': zcr,
+        # Décimos de dB -> dB
+        'bands_db': [b / 10 for b in bands],
+    }
+
+
+def parse_heartbeat(payload):
+    if len(payload) < HEARTBEAT_SIZE:
+        raise PacketError("Payload de heartbeat truncado")
+    floor, rms_min, rms_mean, rms_max, peak, events, blocks = struct.unpack_from(HEARTBEAT_FORMAT, payload)
+    return {
+        'floor_rms': floor / 16,
+        'rms_min': rms_min / 16,
+        'rms_mean': rms_mean / 16,
+        'rms_max': rms_max / 16,
+        'peak': peak,
+        'events': events,
+        'blocks': blocks,
+    }
+
+
+def parse_timing(payload):
+    """Histogramas do callback de amostragem: intervalo e duração."""
+    if len(payload) < 2 * TIMING_SUMMARY_SIZE:
+        raise PacketError("Payload de tempos truncado")
+    summaries = {}
+    for i, name in enumerate(('interval', 'callback')):
+        values = struct.unpack_from(TIMING_SUMMARY_FORMAT, payload, i * TIMING_SUMMARY_SIZE)
+        summaries[name] = dict(zip(TIMING_SUMMARY_FIELDS, values))
+    return summaries
+
+
+def parse_telemetry(payload):
+    """Contadores acumulados desde o boot; send_latency[i] conta envios que
+    levaram de 2^i a 2^(i+1) us."""
+    if len(payload) < TELEMETRY_SIZE:
+        raise PacketError("Payload de telemetria truncado")
+    values = struct.unpack_from(TELEMETRY_FORMAT, payload)
+    stats = dict(zip(TELEMETRY_FIELDS, values))
+    stats['send_latency'] = list(values[-TELEMETRY_LATENCY_BUCKETS:])
+    return stats
+
+
+class BootTracker:
+    """Guarda, por boot_id, o último número de sequência e o offset usado
+    para converter o relógio monotônico do ESP32 em horário UTC."""
+
+    def __init__(self):
+        self.boots = {}
+
+    def offset_us(self, header):
+        # Sem NTP no dispositivo, ancora o relógio monotônico no horário de
+        # chegada do primeiro pacote do boot.
+        boot = self.boots.setdefault(header['boot_id'], {'last_sequence': None, 'offset_us': None})
+        if header['epoch_offset_us'] != 0:
+            boot['offset_us'] = header['epoch_offset_us']
+        elif boot['offset_us'] is None:
+            boot['offset_us'] = int(time.time() * 1_000_000) - header['capture_time_us']
+        return boot['offset_us']
+
+    def check_quality(self, header):
+        """Retorna o nível anterior se o nível de qualidade mudou, senão None.
+        Numa mudança a contagem de sequência recomeça: no nível de
+        características uma janela cobre vários blocos."""
+        boot = self.boots.setdefault(header['boot_id'], {'last_sequence': None, 'offset_us': None})
+        previous = boot.get('quality', QUALITY_FULL)
+        boot['quality'] = header['quality']
+        if previous == header['quality']:
+            return None
+        boot['last_sequence'] = None
+        return previous
+
+    def check_gap(self, header):
+        """Retorna quantos blocos faltam entre o pacote anterior e este."""
+        boot = self.boots.setdefault(header['boot_id'], {'last_sequence': None, 'offset_us': None})
+        last = boot['last_sequence']
+        boot['last_sequence'] = header['sequence']
+        if last is None or header['sequence'] <= last:
+            return 0
+        return header['sequence'] - last - 1
+
+
+def sample_rows(header, samples, offset_us, sample_type="microphone"):
+    """Linhas (sample, timestamp_ms, type) com o instante exato de cada amostra."""
+    start_us = header['capture_time_us'] + offset_us
+    period_us = 1_000_000 / header['sample_rate_hz']
+    return [
+        (sample, int((start_us + i * period_us) // 1000), sample_type)
+        for i, sample in enumerate(samples)
+    ]
@@ -4,3 +4,72 @@ CREATE TABLE data (
     timestamp BIGINT NOT NULL,
     type ENUM('microphone', 'temperature', 'humidity', 'luminosity')
 );
+
+-- Janelas de características do microfone (modo MIC_STREAM_FEATURES)
+CREATE TABLE mic_features (
+    id INT AUTO_INCREMENT PRIMARY KEY,
+    timestamp BIGINT NOT NULL,
+    duration_ms INT NOT NULL,
+    rms SMALLINT UNSIGNED NOT NULL,
+    peak SMALLINT UNSIGNED NOT NULL,
+    zcr SMALLINT UNSIGNED NOT NULL,
+    band0_db FLOAT NOT NULL,
+    band1_db FLOAT NOT NULL,
+    band2_db FLOAT NOT NULL,
+    band3_db FLOAT NOT NULL
+);
+
+-- Heartbeats do modo com portão (MIC_STREAM_GATED); RMS em LSB do ADC
+CREATE TABLE mic_heartbeat (
+    id INT AUTO_INCREMENT PRIMARY KEY,
+    timestamp BIGINT NOT NULL,
+    duration_ms INT NOT NULL,
+    floor_rms FLOAT NOT NULL,
+    rms_min FLOAT NOT NULL,
+    rms_mean FLOAT NOT NULL,
+    rms_max FLOAT NOT NULL,
+    peak SMALLINT UNSIGNED NOT NULL,
+    events SMALLINT UNSIGNED NOT NULL
+);
+
+-- Jitter da amostragem e duração do callback (MIC_TIMING_STATS), em ns
+CREATE TABLE mic_timing (
+    id INT AUTO_INCREMENT PRIMARY KEY,
+    boot_id INT UNSIGNED NOT NULL,
+    timestamp BIGINT NOT NULL,
+    metric ENUM('interval', 'callback') NOT NULL,
+    count INT UNSIGNED NOT NULL,
+    min_ns INT UNSIGNED NOT NULL,
+    max_ns INT UNSIGNED NOT NULL,
+    p50_ns INT UNSIGNED NOT NULL,
+    p99_ns INT UNSIGNED NOT NULL,
+    p999_ns INT UNSIGNED NOT NULL,
+    overflow INT UNSIGNED NOT NULL
+);
+
+-- Quadros de telemetria do firmware; contadores acumulados desde o boot
+CREATE TABLE telemetry (
+    id INT AUTO_INCREMENT PRIMARY KEY,
+    boot_id INT UNSIGNED NOT NULL,
+    timestamp BIGINT NOT NULL,
+    uptime_ms BIGINT NOT NULL,
+    produced INT UNSIGNED NOT NULL,
+    sent INT UNSIGNED NOT NULL,
+    drop_ring INT UNSIGNED NOT NULL,
+    drop_pool INT UNSIGNED NOT NULL,
+    drop_adc INT UNSIGNED NOT NULL,
+    drop_queue_audio INT UNSIGNED NOT NULL,
+    drop_queue_stats INT UNSIGNED NOT NULL,
+    drop_queue_env INT UNSIGNED NOT NULL,
+    drop_ws_offline INT UNSIGNED NOT NULL,
+    drop_ws_error INT UNSIGNED NOT NULL,
+    heap_free INT UNSIGNED NOT NULL,
+    heap_min_free INT UNSIGNED NOT NULL,
+    ring_high_water SMALLINT UNSIGNED NOT NULL,
+    pool_min_free SMALLINT UNSIGNED NOT NULL,
+    reconnects SMALLINT UNSIGNED NOT NULL,
+    rssi TINYINT NOT NULL,
+    quality TINYINT UNSIGNED NOT NULL,
+    send_latency JSON NOT NULL,
+    INDEX (boot_id, timestamp)
+);
@@ -7,6 +7,8 @@
 #include <stdio.h>
 
 #include "esp_websocket_client.h"
+#include "esp_websocket_mask.h"
+#include "esp_websocket_tls.h"
 #include "esp_transport.h"
 #include "esp_transport_tcp.h"
 #include "esp_transport_ssl.h"
@@ -21,7 +23,10 @@
 #include "esp_tls_crypto.h"
 #include "esp_system.h"
 #include <errno.h>
+#include <limits.h>
+#include <sys/random.h>
 #include <arpa/inet.h>
+#include <sys/socket.h>
 
 static const char *TAG = "websocket_client";
 
@@ -38,6 +43,13 @@ static const char *TAG = "websocket_client";
 #define WEBSOCKET_KEEP_ALIVE_IDLE       (5)
 #define WEBSOCKET_KEEP_ALIVE_INTERVAL   (5)
 #define WEBSOCKET_KEEP_ALIVE_COUNT      (3)
+#define WEBSOCKET_FRAME_HEADER_MAX_LEN  (14)    // 2 + 8 (extended length) + 4 (mask key)
+#define WEBSOCKET_MASK_BIT              (0x80)
+#define WEBSOCKET_IOV_GATHER_LEN        (128)   // iovecs up to this size are copied next to the frame header
+#define WEBSOCKET_CONTROL_PAYLOAD_MAX   (125)   // RFC 6455, 5.5
+#define WEBSOCKET_TX_HEADROOM           (16)    // room for the frame header in front of the payload in tx_buffer, keeps the payload word aligned
+#define WEBSOCKET_RECORD_HEADER_LEN     (2)     // big-endian length in front of each coalesced record
+#define WEBSOCKET_READ_POLL_MS          (1000)
 
 #define ESP_WS_CLIENT_MEM_CHECK(TAG, a, action) if (!(a)) {                                         \
         ESP_LOGE(TAG,"%s(%d): %s", __FUNCTION__, __LINE__, "Memory exhausted");                     \
@@ -100,6 +112,7 @@ typedef struct {
     bool                        skip_cert_common_name_check;
     const char                  *cert_common_name;
     esp_err_t                   (*crt_bundle_attach)(void *conf);
+    bool                        tls_session_resumption;
     esp_transport_handle_t      ext_transport;
 } websocket_config_storage_t;
 
@@ -114,10 +127,13 @@ typedef enum {
 
 struct esp_websocket_client {
     esp_event_loop_handle_t     event_handle;
+    esp_websocket_event_callback_t event_callback;  // replaces event_handle when set
+    void                        *event_callback_arg;
     TaskHandle_t                task_handle;
     esp_websocket_error_codes_t error_handle;
     esp_transport_list_handle_t transport_list;
     esp_transport_handle_t      transport;
+    esp_transport_handle_t      parent_transport;   // tcp/ssl below the ws transport, NULL with ext_transport
     websocket_config_storage_t *config;
     websocket_client_state_t    state;
     uint64_t                    keepalive_tick_ms;
@@ -125,16 +141,33 @@ struct esp_websocket_client {
     uint64_t                    ping_tick_ms;
     uint64_t                    pingpong_tick_ms;
     int                         wait_timeout_ms;
+    int                         reconnect_backoff_ms;   // first delay after a drop, 0 to always wait wait_timeout_ms
+    int                         reconnect_delay_ms;     // current delay with a backoff
+    uint64_t                    connected_tick_ms;
     bool                        run;
     bool                        wait_for_pong_resp;
     bool                        selected_for_destroying;
     EventGroupHandle_t          status_bits;
-    SemaphoreHandle_t           lock;
+    SemaphoreHandle_t           lock;       // state machine: state transitions, connect, abort
+    SemaphoreHandle_t           tx_lock;    // frames written to the transport, and closing it
+    bool                        full_duplex;    // reads may run concurrently with writes (plain TCP only)
+    volatile bool               tx_failed;      // a write failed; the client task aborts the connection
+    int                         tx_error;
+    int                         tx_errno;
+    SemaphoreHandle_t           pong_lock;      // the PONG waiting for tx_lock
+    bool                        pong_pending;
+    int                         pong_len;
+    char                        pong_payload[WEBSOCKET_CONTROL_PAYLOAD_MAX];
     size_t                      errormsg_size;
     char                        *errormsg_buffer;
     char                        *rx_buffer;
     char                        *tx_buffer;
     int                         buffer_size;
+    uint8_t                     *coalesce_buffer;       // WEBSOCKET_TX_HEADROOM, then the queued records; NULL if coalescing is off
+    int                         coalesce_len;           // bytes of records queued, guarded by tx_lock
+    int                         coalesce_size;
+    int                         coalesce_delay_ms;
+    uint64_t                    coalesce_tick_ms;       // when the oldest queued record was added
     bool                        last_fin;
     ws_transport_opcodes_t      last_opcode;
     int                         payload_len;
@@ -156,7 +189,7 @@ static esp_err_t esp_websocket_new_buf(esp_websocket_client_handle_t client, boo
             free(client->tx_buffer);
         }
 
-        client->tx_buffer = calloc(1, client->buffer_size);
+        client->tx_buffer = calloc(1, WEBSOCKET_TX_HEADROOM + client->buffer_size);
         ESP_WS_CLIENT_MEM_CHECK(TAG, client->tx_buffer, return ESP_ERR_NO_MEM);
     } else {
         if (client->rx_buffer) {
@@ -215,6 +248,11 @@ static esp_err_t esp_websocket_client_dispatch_event(esp_websocket_client_handle
     event_data.error_handle.error_type = client->error_handle.error_type;
     event_data.error_handle.esp_ws_handshake_status_code = client->error_handle.esp_ws_handshake_status_code;
 
+    if (client->event_callback) {
+        // Straight from the client task: no copy of event_data, no queue, data_ptr still points into rx_buffer
+        client->event_callback(client->event_callback_arg, event, &event_data);
+        return ESP_OK;
+    }
 
     if ((err = esp_event_post_to(client->event_handle,
                                  WEBSOCKET_EVENTS, event,
@@ -226,19 +264,45 @@ static esp_err_t esp_websocket_client_dispatch_event(esp_websocket_client_handle
     return esp_event_loop_run(client->event_handle, 0);
 }
 
+static int esp_websocket_client_reconnect_delay(esp_websocket_client_handle_t client)
+{
+    if (client->reconnect_backoff_ms <= 0) {
+        return client->wait_timeout_ms;
+    }
+    return client->reconnect_delay_ms < client->wait_timeout_ms ? client->reconnect_delay_ms : client->wait_timeout_ms;
+}
+
 static esp_err_t esp_websocket_client_abort_connection(esp_websocket_client_handle_t client, esp_websocket_error_type_t error_type)
 {
     ESP_WS_CLIENT_STATE_CHECK(TAG, client, return ESP_FAIL);
+    if (client->reconnect_backoff_ms > 0) {
+        // Losing a connection that had been up for longer than the longest delay starts the backoff over;
+        // a server that accepts and then drops the connection right away keeps backing off
+        if (client->state == WEBSOCKET_STATE_CONNECTED && _tick_get_ms() - client->connected_tick_ms >= client->wait_timeout_ms) {
+            client->reconnect_delay_ms = 0;
+        }
+        client->reconnect_delay_ms = client->reconnect_delay_ms ? client->reconnect_delay_ms * 2 : client->reconnect_backoff_ms;
+        if (client->reconnect_delay_ms > client->wait_timeout_ms) {
+            client->reconnect_delay_ms = client->wait_timeout_ms;
+        }
+    }
+    // Senders re-check the state once they hold tx_lock, so none of them writes to the closed transport
+    xSemaphoreTakeRecursive(client->tx_lock, portMAX_DELAY);
     esp_transport_close(client->transport);
+    // queued records go down with the connection, like data in the socket's send buffer
+    client->coalesce_len = 0;
 
     if (!client->config->auto_reconnect) {
         client->run = false;
         client->state = WEBSOCKET_STATE_UNKNOW;
     } else {
         client->reconnect_tick_ms = _tick_get_ms();
-        ESP_LOGI(TAG, "Reconnect after %d ms", client->wait_timeout_ms);
+        ESP_LOGI(TAG, "Reconnect after %d ms", esp_websocket_client_reconnect_delay(client));
         client->state = WEBSOCKET_STATE_WAIT_TIMEOUT;
     }
+    client->tx_failed = false;
+    client->pong_pending = false;
+    xSemaphoreGiveRecursive(client->tx_lock);
     client->error_handle.error_type = error_type;
     esp_websocket_client_dispatch_event(client, WEBSOCKET_EVENT_DISCONNECTED, NULL, 0);
     return ESP_OK;
@@ -248,9 +312,12 @@ static esp_err_t esp_websocket_client_error(esp_websocket_client_handle_t client
 static esp_err_t esp_websocket_client_error(esp_websocket_client_handle_t client, const char *format, ...)
 {
     va_list myargs;
+    va_list sizeargs;
     va_start(myargs, format);
+    va_copy(sizeargs, myargs);   // a va_list cannot be walked twice
 
-    size_t needed_size = vsnprintf(NULL, 0, format, myargs);
+    size_t needed_size = vsnprintf(NULL, 0, format, sizeargs);
+    va_end(sizeargs);
     needed_size++; // null terminator
 
     if (needed_size > client->errormsg_size) {
@@ -439,7 +506,14 @@ static void destroy_and_free_resources(esp_websocket_client_handle_t client)
         esp_transport_list_destroy(client->transport_list);
     }
     vSemaphoreDelete(client->lock);
+    if (client->tx_lock) {
+        vSemaphoreDelete(client->tx_lock);
+    }
+    if (client->pong_lock) {
+        vSemaphoreDelete(client->pong_lock);
+    }
     free(client->tx_buffer);
+    free(client->coalesce_buffer);
     free(client->rx_buffer);
     free(client->errormsg_buffer);
     if (client->status_bits) {
@@ -481,6 +555,114 @@ static esp_err_t set_websocket_transport_optional_settings(esp_websocket_client_
     return ESP_ERR_INVALID_ARG;
 }
 
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+// The same settings as the esp_transport_ssl setters below, for the transport that resumes sessions
+static esp_transport_handle_t esp_websocket_client_create_resumable_ssl_transport(esp_websocket_client_handle_t client)
+{
+    esp_tls_cfg_t cfg = {
+        .use_global_ca_store = client->config->use_global_ca_store,
+        .skip_common_name = client->config->skip_cert_common_name_check,
+        .common_name = client->config->cert_common_name,
+        .if_name = client->if_name,
+    };
+    if (client->keep_alive_cfg.keep_alive_enable) {
+        cfg.keep_alive_cfg = (tls_keep_alive_cfg_t *)&client->keep_alive_cfg;
+    }
+    if (!client->config->use_global_ca_store && client->config->cert) {
+        cfg.cacert_buf = (const unsigned char *)client->config->cert;
+        // PEM lengths include the terminating NULL-character
+        cfg.cacert_bytes = client->config->cert_len ? client->config->cert_len : strlen(client->config->cert) + 1;
+    }
+    if (client->config->client_cert) {
+        cfg.clientcert_buf = (const unsigned char *)client->config->client_cert;
+        cfg.clientcert_bytes = client->config->client_cert_len ? client->config->client_cert_len : strlen(client->config->client_cert) + 1;
+    }
+    if (client->config->client_key) {
+        cfg.clientkey_buf = (const unsigned char *)client->config->client_key;
+        cfg.clientkey_bytes = client->config->client_key_len ? client->config->client_key_len : strlen(client->config->client_key) + 1;
+#if CONFIG_ESP_TLS_USE_DS_PERIPHERAL
+    } else if (client->config->client_ds_data) {
+        cfg.ds_data = client->config->client_ds_data;
+#endif
+    }
+    if (client->config->crt_bundle_attach) {
+#ifdef CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+        cfg.crt_bundle_attach = client->config->crt_bundle_attach;
+#else //CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+        ESP_LOGE(TAG, "crt_bundle_attach configured but not enabled in menuconfig: Please enable MBEDTLS_CERTIFICATE_BUNDLE option");
+#endif
+    }
+    return esp_websocket_tls_init(&cfg);
+}
+#endif
+
+static esp_transport_handle_t esp_websocket_client_create_ssl_transport(esp_websocket_client_handle_t client)
+{
+    if (client->config->tls_session_resumption) {
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+        return esp_websocket_client_create_resumable_ssl_transport(client);
+#else
+        ESP_LOGW(TAG, "tls_session_resumption needs CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS, every connection does a full handshake");
+#endif
+    }
+    esp_transport_handle_t ssl = esp_transport_ssl_init();
+    if (ssl == NULL) {
+        return NULL;
+    }
+    if (client->keep_alive_cfg.keep_alive_enable) {
+        esp_transport_ssl_set_keep_alive(ssl, &client->keep_alive_cfg);
+    }
+    if (client->if_name) {
+        esp_transport_ssl_set_interface_name(ssl, client->if_name);
+    }
+
+    if (client->config->use_global_ca_store == true) {
+        esp_transport_ssl_enable_global_ca_store(ssl);
+    } else if (client->config->cert) {
+        if (!client->config->cert_len) {
+            esp_transport_ssl_set_cert_data(ssl, client->config->cert, strlen(client->config->cert));
+        } else {
+            esp_transport_ssl_set_cert_data_der(ssl, client->config->cert, client->config->cert_len);
+        }
+    }
+    if (client->config->client_cert) {
+        if (!client->config->client_cert_len) {
+            esp_transport_ssl_set_client_cert_data(ssl, client->config->client_cert, strlen(client->config->client_cert));
+        } else {
+            esp_transport_ssl_set_client_cert_data_der(ssl, client->config->client_cert, client->config->client_cert_len);
+        }
+    }
+    if (client->config->client_key) {
+        if (!client->config->client_key_len) {
+            esp_transport_ssl_set_client_key_data(ssl, client->config->client_key, strlen(client->config->client_key));
+        } else {
+            esp_transport_ssl_set_client_key_data_der(ssl, client->config->client_key, client->config->client_key_len);
+        }
+#if CONFIG_ESP_TLS_USE_DS_PERIPHERAL
+    } else if (client->config->client_ds_data) {
+        esp_transport_ssl_set_ds_data(ssl, client->config->client_ds_data);
+#endif
+    }
+    if (client->config->crt_bundle_attach) {
+#ifdef CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+        esp_transport_ssl_crt_bundle_attach(ssl, client->config->crt_bundle_attach);
+#else //CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+        ESP_LOGE(TAG, "crt_bundle_attach configured but not enabled in menuconfig: Please enable MBEDTLS_CERTIFICATE_BUNDLE option");
+#endif
+    }
+    if (client->config->skip_cert_common_name_check) {
+        esp_transport_ssl_skip_common_name_check(ssl);
+    }
+    if (client->config->cert_common_name) {
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+        esp_transport_ssl_set_common_name(ssl, client->config->cert_common_name);
+#else
+        ESP_LOGE(TAG, "cert_common_name requires ESP-IDF 5.1.0 or later");
+#endif
+    }
+    return ssl;
+}
+
 static esp_err_t esp_websocket_client_create_transport(esp_websocket_client_handle_t client)
 {
     if (!client->config->scheme) {
@@ -501,6 +683,8 @@ static esp_err_t esp_websocket_client_create_transport(esp_websocket_client_hand
 
         esp_transport_set_default_port(tcp, WEBSOCKET_TCP_DEFAULT_PORT);
         esp_transport_list_add(client->transport_list, tcp, "_tcp"); // need to save to transport list, for cleanup
+        client->parent_transport = tcp;
+        client->full_duplex = true;
         if (client->keep_alive_cfg.keep_alive_enable) {
             esp_transport_tcp_set_keep_alive(tcp, &client->keep_alive_cfg);
         }
@@ -515,62 +699,12 @@ static esp_err_t esp_websocket_client_create_transport(esp_websocket_client_hand
         esp_transport_list_add(client->transport_list, ws, WS_OVER_TCP_SCHEME);
         ESP_WS_CLIENT_ERR_OK_CHECK(TAG, set_websocket_transport_optional_settings(client, WS_OVER_TCP_SCHEME), return ESP_FAIL;)
     } else if (strcasecmp(client->config->scheme, WS_OVER_TLS_SCHEME) == 0) {
-        esp_transport_handle_t ssl = esp_transport_ssl_init();
+        esp_transport_handle_t ssl = esp_websocket_client_create_ssl_transport(client);
         ESP_WS_CLIENT_MEM_CHECK(TAG, ssl, return ESP_ERR_NO_MEM);
 
         esp_transport_set_default_port(ssl, WEBSOCKET_SSL_DEFAULT_PORT);
         esp_transport_list_add(client->transport_list, ssl, "_ssl"); // need to save to transport list, for cleanup
-        if (client->keep_alive_cfg.keep_alive_enable) {
-            esp_transport_ssl_set_keep_alive(ssl, &client->keep_alive_cfg);
-        }
-        if (client->if_name) {
-            esp_transport_ssl_set_interface_name(ssl, client->if_name);
-        }
-
-        if (client->config->use_global_ca_store == true) {
-            esp_transport_ssl_enable_global_ca_store(ssl);
-        } else if (client->config->cert) {
-            if (!client->config->cert_len) {
-                esp_transport_ssl_set_cert_data(ssl, client->config->cert, strlen(client->config->cert));
-            } else {
-                esp_transport_ssl_set_cert_data_der(ssl, client->config->cert, client->config->cert_len);
-            }
-        }
-        if (client->config->client_cert) {
-            if (!client->config->client_cert_len) {
-                esp_transport_ssl_set_client_cert_data(ssl, client->config->client_cert, strlen(client->config->client_cert));
-            } else {
-                esp_transport_ssl_set_client_cert_data_der(ssl, client->config->client_cert, client->config->client_cert_len);
-            }
-        }
-        if (client->config->client_key) {
-            if (!client->config->client_key_len) {
-                esp_transport_ssl_set_client_key_data(ssl, client->config->client_key, strlen(client->config->client_key));
-            } else {
-                esp_transport_ssl_set_client_key_data_der(ssl, client->config->client_key, client->config->client_key_len);
-            }
-#if CONFIG_ESP_TLS_USE_DS_PERIPHERAL
-        } else if (client->config->client_ds_data) {
-            esp_transport_ssl_set_ds_data(ssl, client->config->client_ds_data);
-#endif
-        }
-        if (client->config->crt_bundle_attach) {
-#ifdef CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
-            esp_transport_ssl_crt_bundle_attach(ssl, client->config->crt_bundle_attach);
-#else //CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
-            ESP_LOGE(TAG, "crt_bundle_attach configured but not enabled in menuconfig: Please enable MBEDTLS_CERTIFICATE_BUNDLE option");
-#endif
-        }
-        if (client->config->skip_cert_common_name_check) {
-            esp_transport_ssl_skip_common_name_check(ssl);
-        }
-        if (client->config->cert_common_name) {
-#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
-            esp_transport_ssl_set_common_name(ssl, client->config->cert_common_name);
-#else
-            ESP_LOGE(TAG, "cert_common_name requires ESP-IDF 5.1.0 or later");
-#endif
-        }
+        client->parent_transport = ssl;
 
         esp_transport_handle_t wss = esp_transport_ws_init(ssl);
         ESP_WS_CLIENT_MEM_CHECK(TAG, wss, return ESP_ERR_NO_MEM);
@@ -586,12 +720,188 @@ static esp_err_t esp_websocket_client_create_transport(esp_websocket_client_hand
     return ESP_OK;
 }
 
+static int esp_websocket_client_frame_header(uint8_t *header, ws_transport_opcodes_t opcode, size_t len, const uint8_t *mask)
+{
+    int header_len = 0;
+    header[header_len++] = (uint8_t)opcode;
+    if (len <= 125) {
+        header[header_len++] = WEBSOCKET_MASK_BIT | (uint8_t)len;
+    } else if (len <= UINT16_MAX) {
+        header[header_len++] = WEBSOCKET_MASK_BIT | 126;
+        header[header_len++] = (uint8_t)(len >> 8);
+        header[header_len++] = (uint8_t)len;
+    } else {
+        header[header_len++] = WEBSOCKET_MASK_BIT | 127;
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            header[header_len++] = (uint8_t)((uint64_t)len >> shift);
+        }
+    }
+    memcpy(header + header_len, mask, 4);
+    return header_len + 4;
+}
+
+static int esp_websocket_client_write_all(esp_websocket_client_handle_t client, const uint8_t *data, int len, int timeout_ms)
+{
+    int written = 0;
+    while (written < len) {
+        int wlen = esp_transport_write(client->parent_transport, (const char *)data + written, len - written, timeout_ms);
+        if (wlen <= 0) {
+            return wlen < 0 ? wlen : -1;   // 0 means the write timed out
+        }
+        written += wlen;
+    }
+    return written;
+}
+
+// Writes one frame whose payload goes to `payload`, which has WEBSOCKET_TX_HEADROOM bytes in front of it:
+// `data` is copied and masked there in a single pass (in place if it is already there), right behind the
+// header, so header and payload go out in one transport write.
+static int esp_websocket_client_write_frame(esp_websocket_client_handle_t client, ws_transport_opcodes_t opcode, uint8_t *payload,
+        const uint8_t *data, int len, int timeout_ms)
+{
+    uint8_t header[WEBSOCKET_FRAME_HEADER_MAX_LEN];
+    uint8_t mask[4];
+
+    getrandom(mask, sizeof(mask), 0);
+    int header_len = esp_websocket_client_frame_header(header, opcode, len, mask);
+    memcpy(payload - header_len, header, header_len);
+    esp_websocket_client_copy_mask(payload, data, len, mask, 0);
+    int wlen = esp_websocket_client_write_all(client, payload - header_len, header_len + len, timeout_ms);
+    return (wlen < 0) ? wlen : len;
+}
+
+// Sends one frame staged in tx_buffer
+static int esp_websocket_client_send_frame(esp_websocket_client_handle_t client, ws_transport_opcodes_t opcode, const uint8_t *data, int len, int timeout_ms)
+{
+    return esp_websocket_client_write_frame(client, opcode, (uint8_t *)client->tx_buffer + WEBSOCKET_TX_HEADROOM, data, len, timeout_ms);
+}
+
+// Called with tx_lock held when a frame could not be written. The client task may be inside
+// esp_transport_read() on the same connection, so it is the one to abort it: shutting the socket
+// down wakes it up, and it reports the error once it gets there.
+static void esp_websocket_client_tx_failed(esp_websocket_client_handle_t client, int ret)
+{
+    ESP_LOGE(TAG, "esp_transport_write() returned %d, errno=%d", ret, errno);
+    if (client->tx_failed) {
+        return;
+    }
+    client->tx_error = ret;
+    client->tx_errno = errno;
+    client->tx_failed = true;
+    int sock = esp_transport_get_socket(client->transport);
+    if (sock >= 0) {
+        shutdown(sock, SHUT_RDWR);
+    }
+}
+
+// Takes tx_lock for a frame, failing if the connection went away while waiting for it
+static bool esp_websocket_client_tx_begin(esp_websocket_client_handle_t client, TickType_t timeout)
+{
+    if (xSemaphoreTakeRecursive(client->tx_lock, timeout) != pdPASS) {
+        ESP_LOGE(TAG, "Could not lock ws-client within %" PRIu32 " timeout", timeout);
+        return false;
+    }
+    if (!esp_websocket_client_is_connected(client)) {
+        ESP_LOGE(TAG, "Websocket client is not connected");
+        xSemaphoreGiveRecursive(client->tx_lock);
+        return false;
+    }
+    return true;
+}
+
+// Releases tx_lock, first writing the PONG queued by the client task if there is one
+static void esp_websocket_client_tx_end(esp_websocket_client_handle_t client)
+{
+    if (client->pong_pending) {
+        char payload[WEBSOCKET_CONTROL_PAYLOAD_MAX];
+        int len = -1;
+        xSemaphoreTake(client->pong_lock, portMAX_DELAY);
+        if (client->pong_pending) {
+            len = client->pong_len;
+            memcpy(payload, client->pong_payload, len);
+            client->pong_pending = false;
+        }
+        xSemaphoreGive(client->pong_lock);
+        if (len >= 0 && client->state == WEBSOCKET_STATE_CONNECTED && !client->tx_failed) {
+            int wlen = esp_transport_ws_send_raw(client->transport, WS_TRANSPORT_OPCODES_PONG | WS_TRANSPORT_OPCODES_FIN, payload, len,
+                                                 client->config->network_timeout_ms);
+            if (wlen < 0) {
+                esp_websocket_client_tx_failed(client, wlen);
+            }
+        }
+    }
+    xSemaphoreGiveRecursive(client->tx_lock);
+}
+
+// Answers a PING without making the receive path wait for tx_lock: if a frame is being sent, its
+// sender writes the PONG right after it. Only the latest PING is answered (RFC 6455, 5.5.3).
+static void esp_websocket_client_queue_pong(esp_websocket_client_handle_t client, const char *data, int len)
+{
+    if (len > WEBSOCKET_CONTROL_PAYLOAD_MAX) {
+        len = WEBSOCKET_CONTROL_PAYLOAD_MAX;
+    }
+    xSemaphoreTake(client->pong_lock, portMAX_DELAY);
+    if (len > 0) {
+        memcpy(client->pong_payload, data, len);
+    }
+    client->pong_len = len;
+    client->pong_pending = true;
+    xSemaphoreGive(client->pong_lock);
+    if (xSemaphoreTakeRecursive(client->tx_lock, 0) == pdPASS) {
+        esp_websocket_client_tx_end(client);
+    }
+}
+
+// Sends the queued records as one binary frame. Called with tx_lock held.
+static int esp_websocket_client_coalesce_flush_locked(esp_websocket_client_handle_t client, int timeout_ms)
+{
+    int len = client->coalesce_len;
+    if (len == 0) {
+        return 0;
+    }
+    client->coalesce_len = 0;
+    uint8_t *payload = client->coalesce_buffer + WEBSOCKET_TX_HEADROOM;
+    int wlen;
+    if (client->parent_transport) {
+        wlen = esp_websocket_client_write_frame(client, WS_TRANSPORT_OPCODES_BINARY | WS_TRANSPORT_OPCODES_FIN, payload, payload, len, timeout_ms);
+    } else {
+        wlen = esp_transport_ws_send_raw(client->transport, WS_TRANSPORT_OPCODES_BINARY | WS_TRANSPORT_OPCODES_FIN, (char *)payload, len, timeout_ms);
+    }
+    if (wlen < 0 || (wlen == 0 && len != 0)) {
+        esp_websocket_client_tx_failed(client, wlen);
+        return -1;
+    }
+    return len;
+}
+
+static bool esp_websocket_client_coalesce_due(esp_websocket_client_handle_t client)
+{
+    return client->coalesce_len > 0 && _tick_get_ms() - client->coalesce_tick_ms >= client->coalesce_delay_ms;
+}
+
+// The client task polls the socket sooner than every second when queued records fall due before that
+static int esp_websocket_client_read_poll_ms(esp_websocket_client_handle_t client)
+{
+    if (client->coalesce_buffer == NULL) {
+        return WEBSOCKET_READ_POLL_MS;
+    }
+    int poll_ms = client->coalesce_delay_ms;
+    if (client->coalesce_len > 0) {
+        poll_ms -= (int)(_tick_get_ms() - client->coalesce_tick_ms);
+    }
+    if (poll_ms > WEBSOCKET_READ_POLL_MS) {
+        return WEBSOCKET_READ_POLL_MS;
+    }
+    return poll_ms > 0 ? poll_ms : 1;
+}
+
 static int esp_websocket_client_send_with_exact_opcode(esp_websocket_client_handle_t client, ws_transport_opcodes_t opcode, const uint8_t *data, int len, TickType_t timeout)
 {
     int ret = -1;
     int need_write = len;
     int wlen = 0, widx = 0;
     bool contained_fin = opcode & WS_TRANSPORT_OPCODES_FIN;
+    int timeout_ms = (timeout == portMAX_DELAY) ? -1 : timeout * portTICK_PERIOD_MS;
 
     if (client == NULL || len < 0 || (data == NULL && len > 0)) {
         ESP_LOGE(TAG, "Invalid arguments");
@@ -608,11 +918,16 @@ static int esp_websocket_client_send_with_exact_opcode(esp_websocket_client_hand
         return -1;
     }
 
-    if (xSemaphoreTakeRecursive(client->lock, timeout) != pdPASS) {
-        ESP_LOGE(TAG, "Could not lock ws-client within %" PRIu32 " timeout", timeout);
+    if (!esp_websocket_client_tx_begin(client, timeout)) {
         return -1;
     }
 
+    // Queued records go out ahead of a new message, keeping their order with it
+    if ((opcode & ~WS_TRANSPORT_OPCODES_FIN) != WS_TRANSPORT_OPCODES_CONT &&
+            esp_websocket_client_coalesce_flush_locked(client, timeout_ms) < 0) {
+        goto unlock_and_return;
+    }
+
     if (esp_websocket_new_buf(client, true) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to setup tx buffer");
         goto unlock_and_return;
@@ -625,22 +940,17 @@ static int esp_websocket_client_send_with_exact_opcode(esp_websocket_client_hand
         } else if (contained_fin) {
             opcode = opcode | WS_TRANSPORT_OPCODES_FIN;
         }
-        memcpy(client->tx_buffer, data + widx, need_write);
-        // send with ws specific way and specific opcode
-        wlen = esp_transport_ws_send_raw(client->transport, opcode, (char *)client->tx_buffer, need_write,
-                                         (timeout == portMAX_DELAY) ? -1 : timeout * portTICK_PERIOD_MS);
+        if (client->parent_transport) {
+            wlen = esp_websocket_client_send_frame(client, opcode, data + widx, need_write, timeout_ms);
+        } else {
+            memcpy(client->tx_buffer, data + widx, need_write);
+            // send with ws specific way and specific opcode
+            wlen = esp_transport_ws_send_raw(client->transport, opcode, (char *)client->tx_buffer, need_write, timeout_ms);
+        }
         if (wlen < 0 || (wlen == 0 && need_write != 0)) {
             ret = wlen;
             esp_websocket_free_buf(client, true);
-            esp_tls_error_handle_t error_handle = esp_transport_get_error_handle(client->transport);
-            if (error_handle) {
-                esp_websocket_client_error(client, "esp_transport_write() returned %d, transport_error=%s, tls_error_code=%i, tls_flags=%i, errno=%d",
-                                           ret, esp_err_to_name(error_handle->last_error), error_handle->esp_tls_error_code,
-                                           error_handle->esp_tls_flags, errno);
-            } else {
-                esp_websocket_client_error(client, "esp_transport_write() returned %d, errno=%d", ret, errno);
-            }
-            esp_websocket_client_abort_connection(client, WEBSOCKET_ERROR_TYPE_TCP_TRANSPORT);
+            esp_websocket_client_tx_failed(client, ret);
             goto unlock_and_return;
         }
         opcode = 0;
@@ -651,7 +961,122 @@ static int esp_websocket_client_send_with_exact_opcode(esp_websocket_client_hand
     ret = widx;
 
 unlock_and_return:
-    xSemaphoreGiveRecursive(client->lock);
+    esp_websocket_client_tx_end(client);
+    return ret;
+}
+
+static int esp_websocket_client_send_iov_fragmented(esp_websocket_client_handle_t client, ws_transport_opcodes_t opcode,
+        const esp_websocket_iovec_t *iov, int iovcnt, TickType_t timeout)
+{
+    if (!esp_websocket_client_tx_begin(client, timeout)) {
+        return -1;
+    }
+    int ret = 0;
+    if (iovcnt == 0) {
+        ret = esp_websocket_client_send_with_exact_opcode(client, opcode | WS_TRANSPORT_OPCODES_FIN, NULL, 0, timeout);
+    }
+    for (int i = 0; i < iovcnt && ret >= 0; i++) {
+        ws_transport_opcodes_t frame_opcode = (i == 0) ? opcode : WS_TRANSPORT_OPCODES_CONT;
+        if (i == iovcnt - 1) {
+            frame_opcode |= WS_TRANSPORT_OPCODES_FIN;
+        }
+        int wlen = esp_websocket_client_send_with_exact_opcode(client, frame_opcode, iov[i].data, iov[i].len, timeout);
+        ret = (wlen < 0) ? wlen : ret + wlen;
+    }
+    esp_websocket_client_tx_end(client);
+    return ret;
+}
+
+static int esp_websocket_client_send_iov_with_opcode(esp_websocket_client_handle_t client, ws_transport_opcodes_t opcode,
+        const esp_websocket_iovec_t *iov, int iovcnt, TickType_t timeout)
+{
+    uint8_t gather[WEBSOCKET_FRAME_HEADER_MAX_LEN + WEBSOCKET_IOV_GATHER_LEN];
+    size_t total = 0;
+
+    if (client == NULL || iovcnt < 0 || (iov == NULL && iovcnt > 0)) {
+        ESP_LOGE(TAG, "Invalid arguments");
+        return -1;
+    }
+    for (int i = 0; i < iovcnt; i++) {
+        if ((iov[i].data == NULL && iov[i].len > 0) || iov[i].len > INT_MAX - total) {
+            ESP_LOGE(TAG, "Invalid arguments");
+            return -1;
+        }
+        total += iov[i].len;
+    }
+
+    if (!esp_websocket_client_is_connected(client)) {
+        ESP_LOGE(TAG, "Websocket client is not connected");
+        return -1;
+    }
+
+    if (client->transport == NULL) {
+        ESP_LOGE(TAG, "Invalid transport");
+        return -1;
+    }
+
+    if (client->parent_transport == NULL) {
+        // The frame header can only be written below the ws transport we created ourselves
+        return esp_websocket_client_send_iov_fragmented(client, opcode, iov, iovcnt, timeout);
+    }
+
+    if (!esp_websocket_client_tx_begin(client, timeout)) {
+        return -1;
+    }
+
+    int ret = -1;
+    int wlen = 0;
+    int timeout_ms = (timeout == portMAX_DELAY) ? -1 : timeout * portTICK_PERIOD_MS;
+    if (esp_websocket_client_coalesce_flush_locked(client, timeout_ms) < 0) {
+        esp_websocket_client_tx_end(client);
+        return -1;
+    }
+    uint8_t mask[4];
+    getrandom(mask, sizeof(mask), 0);
+    int gathered = esp_websocket_client_frame_header(gather, opcode | WS_TRANSPORT_OPCODES_FIN, total, mask);
+    size_t offset = 0;
+
+    for (int i = 0; i < iovcnt; i++) {
+        uint8_t *data = iov[i].data;
+        size_t len = iov[i].len;
+        if (len <= sizeof(gather) - gathered) {
+            // Small pieces (record headers and the like) share one write with the frame header
+            esp_websocket_client_copy_mask(gather + gathered, data, len, mask, offset);
+            gathered += len;
+            offset += len;
+            continue;
+        }
+        if (gathered > 0) {
+            wlen = esp_websocket_client_write_all(client, gather, gathered, timeout_ms);
+            if (wlen <= 0) {
+                goto write_error;
+            }
+            gathered = 0;
+        }
+        // Large buffers go out from where they are: masked in place, written, unmasked
+        esp_websocket_client_copy_mask(data, data, len, mask, offset);
+        wlen = esp_websocket_client_write_all(client, data, len, timeout_ms);
+        esp_websocket_client_copy_mask(data, data, len, mask, offset);
+        if (wlen <= 0) {
+            goto write_error;
+        }
+        offset += len;
+    }
+    if (gathered > 0) {
+        wlen = esp_websocket_client_write_all(client, gather, gathered, timeout_ms);
+        if (wlen <= 0) {
+            goto write_error;
+        }
+    }
+    ret = (int)total;
+    goto unlock_and_return;
+
+write_error:
+    ret = wlen;
+    esp_websocket_client_tx_failed(client, ret);
+
+unlock_and_return:
+    esp_websocket_client_tx_end(client);
     return ret;
 }
 
@@ -687,6 +1112,12 @@ esp_websocket_client_handle_t esp_websocket_client_init(const esp_websocket_clie
     client->lock = xSemaphoreCreateRecursiveMutex();
     ESP_WS_CLIENT_MEM_CHECK(TAG, client->lock, goto _websocket_init_fail);
 
+    client->tx_lock = xSemaphoreCreateRecursiveMutex();
+    ESP_WS_CLIENT_MEM_CHECK(TAG, client->tx_lock, goto _websocket_init_fail);
+
+    client->pong_lock = xSemaphoreCreateMutex();
+    ESP_WS_CLIENT_MEM_CHECK(TAG, client->pong_lock, goto _websocket_init_fail);
+
     client->config = calloc(1, sizeof(websocket_config_storage_t));
     ESP_WS_CLIENT_MEM_CHECK(TAG, client->config, goto _websocket_init_fail);
 
@@ -704,6 +1135,7 @@ esp_websocket_client_handle_t esp_websocket_client_init(const esp_websocket_clie
     } else {
         client->wait_timeout_ms = config->reconnect_timeout_ms;
     }
+    client->reconnect_backoff_ms = config->reconnect_backoff_ms;
 
     // configure ssl related parameters
     if (config->cert_common_name != NULL && config->skip_cert_common_name_check) {
@@ -724,6 +1156,7 @@ esp_websocket_client_handle_t esp_websocket_client_init(const esp_websocket_clie
     client->config->skip_cert_common_name_check = config->skip_cert_common_name_check;
     client->config->cert_common_name = config->cert_common_name;
     client->config->crt_bundle_attach = config->crt_bundle_attach;
+    client->config->tls_session_resumption = config->tls_session_resumption;
     client->config->ext_transport = config->ext_transport;
 
     if (config->uri) {
@@ -760,7 +1193,7 @@ esp_websocket_client_handle_t esp_websocket_client_init(const esp_websocket_clie
     ESP_WS_CLIENT_MEM_CHECK(TAG, client->rx_buffer, {
         goto _websocket_init_fail;
     });
-    client->tx_buffer = malloc(buffer_size);
+    client->tx_buffer = malloc(WEBSOCKET_TX_HEADROOM + buffer_size);
     ESP_WS_CLIENT_MEM_CHECK(TAG, client->tx_buffer, {
         goto _websocket_init_fail;
     });
@@ -771,6 +1204,20 @@ esp_websocket_client_handle_t esp_websocket_client_init(const esp_websocket_clie
     });
     xEventGroupSetBits(client->status_bits, STOPPED_BIT);
 
+    if (config->coalesce_delay_ms > 0) {
+        int coalesce_size = config->coalesce_size > 0 ? config->coalesce_size : buffer_size;
+        if (coalesce_size <= WEBSOCKET_RECORD_HEADER_LEN) {
+            ESP_LOGE(TAG, "coalesce_size of %d bytes leaves no room for records", coalesce_size);
+            goto _websocket_init_fail;
+        }
+        client->coalesce_buffer = malloc(WEBSOCKET_TX_HEADROOM + coalesce_size);
+        ESP_WS_CLIENT_MEM_CHECK(TAG, client->coalesce_buffer, {
+            goto _websocket_init_fail;
+        });
+        client->coalesce_size = coalesce_size;
+        client->coalesce_delay_ms = config->coalesce_delay_ms;
+    }
+
     client->buffer_size = buffer_size;
     return client;
 
@@ -933,7 +1380,14 @@ static esp_err_t esp_websocket_client_recv(esp_websocket_client_handle_t client)
         return ESP_FAIL;
     }
     do {
+        // Over TLS reads and writes share one session context, so they cannot overlap
+        if (!client->full_duplex) {
+            xSemaphoreTakeRecursive(client->tx_lock, portMAX_DELAY);
+        }
         rlen = esp_transport_read(client->transport, client->rx_buffer, client->buffer_size, client->config->network_timeout_ms);
+        if (!client->full_duplex) {
+            xSemaphoreGiveRecursive(client->tx_lock);
+        }
         if (rlen < 0) {
             esp_websocket_free_buf(client, false);
             esp_tls_error_handle_t error_handle = esp_transport_get_error_handle(client->transport);
@@ -963,10 +1417,8 @@ static esp_err_t esp_websocket_client_recv(esp_websocket_client_handle_t client)
 
     // if a PING message received -> send out the PONG, this will not work for PING messages with payload longer than buffer len
     if (client->last_opcode == WS_TRANSPORT_OPCODES_PING) {
-        const char *data = (client->payload_len == 0) ? NULL : client->rx_buffer;
         ESP_LOGD(TAG, "Sending PONG with payload len=%d", client->payload_len);
-        esp_transport_ws_send_raw(client->transport, WS_TRANSPORT_OPCODES_PONG | WS_TRANSPORT_OPCODES_FIN, data, client->payload_len,
-                                  client->config->network_timeout_ms);
+        esp_websocket_client_queue_pong(client, client->rx_buffer, client->payload_len);
     } else if (client->last_opcode == WS_TRANSPORT_OPCODES_PONG) {
         client->wait_for_pong_resp = false;
     } else if (client->last_opcode == WS_TRANSPORT_OPCODES_CLOSE) {
@@ -1038,17 +1490,26 @@ static void esp_websocket_client_task(void *pv)
             ESP_LOGD(TAG, "Transport connected to %s://%s:%d", client->config->scheme, client->config->host, client->config->port);
 
             client->state = WEBSOCKET_STATE_CONNECTED;
+            client->connected_tick_ms = _tick_get_ms();
             client->wait_for_pong_resp = false;
             client->error_handle.error_type = WEBSOCKET_ERROR_TYPE_NONE;
             esp_websocket_client_dispatch_event(client, WEBSOCKET_EVENT_CONNECTED, NULL, 0);
             break;
         case WEBSOCKET_STATE_CONNECTED:
+            if (client->tx_failed) {
+                esp_websocket_client_error(client, "esp_transport_write() returned %d, errno=%d", client->tx_error, client->tx_errno);
+                esp_websocket_client_abort_connection(client, WEBSOCKET_ERROR_TYPE_TCP_TRANSPORT);
+                break;
+            }
             if ((CLOSE_FRAME_SENT_BIT & xEventGroupGetBits(client->status_bits)) == 0) { // only send and check for PING
                 // if closing hasn't been initiated
-                if (_tick_get_ms() - client->ping_tick_ms > client->config->ping_interval_sec * 1000) {
+                // a frame being sent postpones the PING rather than the next read
+                if (_tick_get_ms() - client->ping_tick_ms > client->config->ping_interval_sec * 1000 &&
+                        xSemaphoreTakeRecursive(client->tx_lock, 0) == pdPASS) {
                     client->ping_tick_ms = _tick_get_ms();
                     ESP_LOGD(TAG, "Sending PING...");
                     esp_transport_ws_send_raw(client->transport, WS_TRANSPORT_OPCODES_PING | WS_TRANSPORT_OPCODES_FIN, NULL, 0, client->config->network_timeout_ms);
+                    esp_websocket_client_tx_end(client);
 
                     if (!client->wait_for_pong_resp && client->config->pingpong_timeout_sec) {
                         client->pingpong_tick_ms = _tick_get_ms();
@@ -1066,6 +1527,17 @@ static void esp_websocket_client_task(void *pv)
             }
 
 
+            // a PONG that found tx_lock taken and was not picked up by its holder
+            if (client->pong_pending && xSemaphoreTakeRecursive(client->tx_lock, 0) == pdPASS) {
+                esp_websocket_client_tx_end(client);
+            }
+
+            // records whose time budget ran out; a sender holding tx_lock sends them before its own frame
+            if (esp_websocket_client_coalesce_due(client) && xSemaphoreTakeRecursive(client->tx_lock, 0) == pdPASS) {
+                esp_websocket_client_coalesce_flush_locked(client, client->config->network_timeout_ms);
+                esp_websocket_client_tx_end(client);
+            }
+
             if (read_select == 0) {
                 ESP_LOGV(TAG, "Read poll timeout: skipping esp_transport_read()...");
                 break;
@@ -1080,7 +1552,7 @@ static void esp_websocket_client_task(void *pv)
             break;
         case WEBSOCKET_STATE_WAIT_TIMEOUT:
 
-            if (_tick_get_ms() - client->reconnect_tick_ms > client->wait_timeout_ms) {
+            if (_tick_get_ms() - client->reconnect_tick_ms >= esp_websocket_client_reconnect_delay(client)) {
                 client->state = WEBSOCKET_STATE_INIT;
                 client->reconnect_tick_ms = _tick_get_ms();
                 ESP_LOGD(TAG, "Reconnecting...");
@@ -1090,7 +1562,9 @@ static void esp_websocket_client_task(void *pv)
             // if closing not initiated by the client echo the close message back
             if ((CLOSE_FRAME_SENT_BIT & xEventGroupGetBits(client->status_bits)) == 0) {
                 ESP_LOGD(TAG, "Closing initiated by the server, sending close frame");
+                xSemaphoreTakeRecursive(client->tx_lock, portMAX_DELAY);
                 esp_transport_ws_send_raw(client->transport, WS_TRANSPORT_OPCODES_CLOSE | WS_TRANSPORT_OPCODES_FIN, NULL, 0, client->config->network_timeout_ms);
+                xSemaphoreGiveRecursive(client->tx_lock);
                 xEventGroupSetBits(client->status_bits, CLOSE_FRAME_SENT_BIT);
             }
             break;
@@ -1100,7 +1574,7 @@ static void esp_websocket_client_task(void *pv)
         }
         xSemaphoreGiveRecursive(client->lock);
         if (WEBSOCKET_STATE_CONNECTED == client->state) {
-            read_select = esp_transport_poll_read(client->transport, 1000); //Poll every 1000ms
+            read_select = esp_transport_poll_read(client->transport, esp_websocket_client_read_poll_ms(client));
             if (read_select < 0) {
                 esp_tls_error_handle_t error_handle = esp_transport_get_error_handle(client->transport);
                 if (error_handle) {
@@ -1115,8 +1589,12 @@ static void esp_websocket_client_task(void *pv)
                 xSemaphoreGiveRecursive(client->lock);
             }
         } else if (WEBSOCKET_STATE_WAIT_TIMEOUT == client->state) {
-            // waiting for reconnecting...
-            vTaskDelay(client->wait_timeout_ms / 2 / portTICK_PERIOD_MS);
+            // waiting for reconnecting..., at most half of wait_timeout_ms at a time so that stop() is not held up
+            int remaining_ms = esp_websocket_client_reconnect_delay(client) - (int)(_tick_get_ms() - client->reconnect_tick_ms);
+            if (remaining_ms > client->wait_timeout_ms / 2) {
+                remaining_ms = client->wait_timeout_ms / 2;
+            }
+            vTaskDelay(remaining_ms > 0 ? remaining_ms / portTICK_PERIOD_MS + 1 : 1);
         } else if (WEBSOCKET_STATE_CLOSING == client->state &&
                    (CLOSE_FRAME_SENT_BIT & xEventGroupGetBits(client->status_bits))) {
             ESP_LOGD(TAG, " Waiting for TCP connection to be closed by the server");
@@ -1155,6 +1633,10 @@ esp_err_t esp_websocket_client_start(esp_websocket_client_handle_t client)
     }
 
     client->transport = client->config->ext_transport;
+    client->parent_transport = NULL;
+    client->full_duplex = false;
+    client->reconnect_delay_ms = 0;
+    client->coalesce_len = 0;
     if (!client->transport) {
         if (esp_websocket_client_create_transport(client) != ESP_OK) {
             ESP_LOGE(TAG, "Failed to create websocket transport");
@@ -1271,6 +1753,11 @@ int esp_websocket_client_send_bin(esp_websocket_client_handle_t client, const ch
     return esp_websocket_client_send_with_opcode(client, WS_TRANSPORT_OPCODES_BINARY, (const uint8_t *)data, len, timeout);
 }
 
+int esp_websocket_client_send_bin_iov(esp_websocket_client_handle_t client, const esp_websocket_iovec_t *iov, int iovcnt, TickType_t timeout)
+{
+    return esp_websocket_client_send_iov_with_opcode(client, WS_TRANSPORT_OPCODES_BINARY, iov, iovcnt, timeout);
+}
+
 int esp_websocket_client_send_bin_partial(esp_websocket_client_handle_t client, const char *data, int len, TickType_t timeout)
 {
     return esp_websocket_client_send_with_exact_opcode(client, WS_TRANSPORT_OPCODES_BINARY, (const uint8_t *)data, len, timeout);
@@ -1286,12 +1773,79 @@ int esp_websocket_client_send_with_opcode(esp_websocket_client_handle_t client,
     return esp_websocket_client_send_with_exact_opcode(client, opcode | WS_TRANSPORT_OPCODES_FIN, data, len, timeout);
 }
 
+int esp_websocket_client_send_coalesced(esp_websocket_client_handle_t client, const char *data, int len, TickType_t timeout)
+{
+    if (client == NULL || len < 0 || (data == NULL && len > 0)) {
+        ESP_LOGE(TAG, "Invalid arguments");
+        return -1;
+    }
+    if (client->coalesce_buffer == NULL) {
+        ESP_LOGE(TAG, "Coalescing is disabled, set coalesce_delay_ms");
+        return -1;
+    }
+    if (len > client->coalesce_size - WEBSOCKET_RECORD_HEADER_LEN || len > UINT16_MAX) {
+        ESP_LOGE(TAG, "Record of %d bytes does not fit in coalesce_size", len);
+        return -1;
+    }
+    if (!esp_websocket_client_is_connected(client)) {
+        ESP_LOGE(TAG, "Websocket client is not connected");
+        return -1;
+    }
+    if (!esp_websocket_client_tx_begin(client, timeout)) {
+        return -1;
+    }
+
+    int ret = -1;
+    int timeout_ms = (timeout == portMAX_DELAY) ? -1 : timeout * portTICK_PERIOD_MS;
+    if (client->coalesce_len + WEBSOCKET_RECORD_HEADER_LEN + len > client->coalesce_size &&
+            esp_websocket_client_coalesce_flush_locked(client, timeout_ms) < 0) {
+        goto unlock_and_return;
+    }
+    if (client->coalesce_len == 0) {
+        client->coalesce_tick_ms = _tick_get_ms();
+    }
+    uint8_t *record = client->coalesce_buffer + WEBSOCKET_TX_HEADROOM + client->coalesce_len;
+    record[0] = (uint8_t)(len >> 8);
+    record[1] = (uint8_t)len;
+    if (len > 0) {
+        memcpy(record + WEBSOCKET_RECORD_HEADER_LEN, data, len);
+    }
+    client->coalesce_len += WEBSOCKET_RECORD_HEADER_LEN + len;
+    ret = len;
+    // a full buffer, or a budget that ran out while the client task could not get tx_lock
+    if ((client->coalesce_size - client->coalesce_len <= WEBSOCKET_RECORD_HEADER_LEN || esp_websocket_client_coalesce_due(client)) &&
+            esp_websocket_client_coalesce_flush_locked(client, timeout_ms) < 0) {
+        ret = -1;
+    }
+
+unlock_and_return:
+    esp_websocket_client_tx_end(client);
+    return ret;
+}
+
+esp_err_t esp_websocket_client_flush(esp_websocket_client_handle_t client, TickType_t timeout)
+{
+    if (client == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (client->coalesce_buffer == NULL || client->coalesce_len == 0) {
+        return ESP_OK;
+    }
+    if (!esp_websocket_client_tx_begin(client, timeout)) {
+        return ESP_FAIL;
+    }
+    int timeout_ms = (timeout == portMAX_DELAY) ? -1 : timeout * portTICK_PERIOD_MS;
+    int ret = esp_websocket_client_coalesce_flush_locked(client, timeout_ms);
+    esp_websocket_client_tx_end(client);
+    return ret < 0 ? ESP_FAIL : ESP_OK;
+}
+
 bool esp_websocket_client_is_connected(esp_websocket_client_handle_t client)
 {
     if (client == NULL) {
         return false;
     }
-    return client->state == WEBSOCKET_STATE_CONNECTED;
+    return client->state == WEBSOCKET_STATE_CONNECTED && !client->tx_failed;
 }
 
 size_t esp_websocket_client_get_ping_interval_sec(esp_websocket_client_handle_t client)
@@ -1373,3 +1927,19 @@ esp_err_t esp_websocket_register_events(esp_websocket_client_handle_t client,
     }
     return esp_event_handler_register_with(client->event_handle, WEBSOCKET_EVENTS, event, event_handler, event_handler_arg);
 }
+
+esp_err_t esp_websocket_register_callback(esp_websocket_client_handle_t client,
+        esp_websocket_event_callback_t callback,
+        void *callback_arg)
+{
+    if (client == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (client->status_bits && (STOPPED_BIT & xEventGroupGetBits(client->status_bits)) == 0) {
+        ESP_LOGE(TAG, "The callback can only be changed while the client is stopped");
+        return ESP_ERR_INVALID_STATE;
+    }
+    client->event_callback = callback;
+    client->event_callback_arg = callback_arg;
+    return ESP_OK;
+}
@@ -0,0 +1,55 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "esp_websocket_mask.h"
+
+// Word accesses through these types are allowed to alias the byte buffers; the unaligned one lets the
+// compiler pick a safe access sequence on targets without unaligned loads (e.g. Xtensa).
+typedef uint32_t __attribute__((__may_alias__)) ws_word_t;
+typedef uint32_t __attribute__((__may_alias__, __aligned__(1))) ws_unaligned_word_t;
+
+void esp_websocket_client_copy_mask(uint8_t *dst, const uint8_t *src, size_t len, const uint8_t *mask, size_t offset)
+{
+    size_t i = 0;
+
+    // Bytes up to the first word boundary of dst
+    for (; i < len && ((uintptr_t)(dst + i) & 3); i++) {
+        dst[i] = src[i] ^ mask[(offset + i) & 3];
+    }
+    if (len - i >= 4) {
+        // Mask key rotated so that its first byte lines up with dst + i, in memory order
+        uint8_t rotated[4];
+        uint32_t key;
+        for (int k = 0; k < 4; k++) {
+            rotated[k] = mask[(offset + i + k) & 3];
+        }
+        memcpy(&key, rotated, sizeof(key));
+
+        if (((uintptr_t)(src + i) & 3) == 0) {
+            const ws_word_t *s = (const ws_word_t *)(src + i);
+            ws_word_t *d = (ws_word_t *)(dst + i);
+            for (; len - i >= 16; i += 16, s += 4, d += 4) {
+                d[0] = s[0] ^ key;
+                d[1] = s[1] ^ key;
+                d[2] = s[2] ^ key;
+                d[3] = s[3] ^ key;
+            }
+            for (; len - i >= 4; i += 4) {
+                *d++ = *s++ ^ key;
+            }
+        } else {
+            const ws_unaligned_word_t *s = (const ws_unaligned_word_t *)(src + i);
+            ws_word_t *d = (ws_word_t *)(dst + i);
+            for (; len - i >= 4; i += 4) {
+                *d++ = *s++ ^ key;
+            }
+        }
+    }
+    for (; i < len; i++) {
+        dst[i] = src[i] ^ mask[(offset + i) & 3];
+    }
+}
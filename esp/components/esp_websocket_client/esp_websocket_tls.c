@@ -0,0 +1,182 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include "esp_log.h"
+#include "esp_websocket_tls.h"
+
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+
+static const char *TAG = "websocket_tls";
+
+typedef struct {
+    esp_tls_cfg_t               cfg;
+    esp_tls_t                   *tls;
+    int                         sockfd;
+    esp_tls_client_session_t    *session;   // of the last connection, offered in the next handshake
+} websocket_tls_t;
+
+static void websocket_tls_forget_session(websocket_tls_t *ctx)
+{
+    if (ctx->session) {
+        esp_tls_free_client_session(ctx->session);
+        ctx->session = NULL;
+    }
+}
+
+static int websocket_tls_poll(websocket_tls_t *ctx, bool read, int timeout_ms)
+{
+    fd_set set;
+    fd_set errset;
+    FD_ZERO(&set);
+    FD_ZERO(&errset);
+    FD_SET(ctx->sockfd, &set);
+    FD_SET(ctx->sockfd, &errset);
+    struct timeval timeout = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_usec = (timeout_ms % 1000) * 1000,
+    };
+    int ret = select(ctx->sockfd + 1, read ? &set : NULL, read ? NULL : &set, &errset, timeout_ms < 0 ? NULL : &timeout);
+    if (ret > 0 && FD_ISSET(ctx->sockfd, &errset)) {
+        int sock_errno = 0;
+        socklen_t len = sizeof(sock_errno);
+        getsockopt(ctx->sockfd, SOL_SOCKET, SO_ERROR, &sock_errno, &len);
+        ESP_LOGE(TAG, "poll error on fd %d, errno=%d", ctx->sockfd, sock_errno);
+        return -1;
+    }
+    return ret;
+}
+
+static int websocket_tls_connect(esp_transport_handle_t t, const char *host, int port, int timeout_ms)
+{
+    websocket_tls_t *ctx = esp_transport_get_context_data(t);
+    ctx->tls = esp_tls_init();
+    if (ctx->tls == NULL) {
+        return -1;
+    }
+    ctx->cfg.timeout_ms = timeout_ms;
+    ctx->cfg.client_session = ctx->session;
+    if (esp_tls_conn_new_sync(host, strlen(host), port, &ctx->cfg, ctx->tls) <= 0) {
+        esp_tls_error_handle_t error_handle = NULL;
+        if (esp_tls_get_error_handle(ctx->tls, &error_handle) == ESP_OK && error_handle) {
+            ESP_LOGE(TAG, "Failed to open a new connection to %s:%d, esp_tls error=%s, tls_error_code=0x%x",
+                     host, port, esp_err_to_name(error_handle->last_error), error_handle->esp_tls_error_code);
+        }
+        esp_tls_conn_destroy(ctx->tls);
+        ctx->tls = NULL;
+        // do not offer it again in case it is what the server failed on
+        websocket_tls_forget_session(ctx);
+        return -1;
+    }
+    esp_tls_get_conn_sockfd(ctx->tls, &ctx->sockfd);
+    return 0;
+}
+
+static int websocket_tls_poll_read(esp_transport_handle_t t, int timeout_ms)
+{
+    websocket_tls_t *ctx = esp_transport_get_context_data(t);
+    if (ctx->tls == NULL) {
+        return -1;
+    }
+    // records already decrypted do not show on the socket
+    if (esp_tls_get_bytes_avail(ctx->tls) > 0) {
+        return 1;
+    }
+    return websocket_tls_poll(ctx, true, timeout_ms);
+}
+
+static int websocket_tls_poll_write(esp_transport_handle_t t, int timeout_ms)
+{
+    websocket_tls_t *ctx = esp_transport_get_context_data(t);
+    if (ctx->tls == NULL) {
+        return -1;
+    }
+    return websocket_tls_poll(ctx, false, timeout_ms);
+}
+
+static int websocket_tls_read(esp_transport_handle_t t, char *buffer, int len, int timeout_ms)
+{
+    websocket_tls_t *ctx = esp_transport_get_context_data(t);
+    int poll = websocket_tls_poll_read(t, timeout_ms);
+    if (poll <= 0) {
+        return poll;
+    }
+    int ret = esp_tls_conn_read(ctx->tls, buffer, len);
+    if (ret == ESP_TLS_ERR_SSL_WANT_READ || ret == ESP_TLS_ERR_SSL_WANT_WRITE) {
+        return 0;
+    }
+    if (ret == 0) {
+        ESP_LOGD(TAG, "Connection closed by the server");
+        return -1;
+    }
+    return ret < 0 ? -1 : ret;
+}
+
+static int websocket_tls_write(esp_transport_handle_t t, const char *buffer, int len, int timeout_ms)
+{
+    websocket_tls_t *ctx = esp_transport_get_context_data(t);
+    int poll = websocket_tls_poll_write(t, timeout_ms);
+    if (poll <= 0) {
+        return poll;
+    }
+    int ret = esp_tls_conn_write(ctx->tls, buffer, len);
+    if (ret == ESP_TLS_ERR_SSL_WANT_READ || ret == ESP_TLS_ERR_SSL_WANT_WRITE) {
+        return 0;
+    }
+    return ret < 0 ? -1 : ret;
+}
+
+static int websocket_tls_close(esp_transport_handle_t t)
+{
+    websocket_tls_t *ctx = esp_transport_get_context_data(t);
+    if (ctx->tls == NULL) {
+        return 0;
+    }
+    // Exported at close rather than after the handshake: a TLS 1.3 server sends its ticket later,
+    // and mbedTLS lets a session be exported only once
+    esp_tls_client_session_t *session = esp_tls_get_client_session(ctx->tls);
+    if (session) {
+        websocket_tls_forget_session(ctx);
+        ctx->session = session;
+    }
+    int ret = esp_tls_conn_destroy(ctx->tls);
+    ctx->tls = NULL;
+    ctx->sockfd = -1;
+    return ret;
+}
+
+static int websocket_tls_destroy(esp_transport_handle_t t)
+{
+    websocket_tls_t *ctx = esp_transport_get_context_data(t);
+    websocket_tls_close(t);
+    websocket_tls_forget_session(ctx);
+    free(ctx);
+    return 0;
+}
+
+esp_transport_handle_t esp_websocket_tls_init(const esp_tls_cfg_t *cfg)
+{
+    esp_transport_handle_t t = esp_transport_init();
+    if (t == NULL) {
+        return NULL;
+    }
+    websocket_tls_t *ctx = calloc(1, sizeof(websocket_tls_t));
+    if (ctx == NULL) {
+        esp_transport_destroy(t);
+        return NULL;
+    }
+    ctx->cfg = *cfg;
+    ctx->sockfd = -1;
+    esp_transport_set_context_data(t, ctx);
+    esp_transport_set_func(t, websocket_tls_connect, websocket_tls_read, websocket_tls_write, websocket_tls_close,
+                           websocket_tls_poll_read, websocket_tls_poll_write, websocket_tls_destroy);
+    return t;
+}
+
+#endif
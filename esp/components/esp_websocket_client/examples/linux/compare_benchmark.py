@@ -0,0 +1,87 @@
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Unlicense OR CC0-1.0
+"""Compare outputs of the benchmark suite of the host example.
+
+Reads the JSON lines that CONFIG_WEBSOCKET_BENCHMARK_SUITE prints (other lines, such as logs, are
+skipped) from one or more runs of a baseline and of the current version, takes the median throughput
+and p99 latency of each case over the runs, and prints the change of each metric. A case regresses when
+its throughput drops or its p99 send latency grows by more than the tolerance, when it makes more heap
+allocations per send, or when its sends fail or do not reach the sink. The exit status is 1 if any case
+regressed, so the script can gate updating the component version in idf_component.yml.
+"""
+import argparse
+import json
+import statistics
+import sys
+
+KEY = ('api', 'payload', 'buffer_size', 'timeout_ms')
+
+
+def load(paths):
+    runs = {}
+    for path in paths:
+        with open(path) as f:
+            for line in f:
+                if not line.startswith('{'):
+                    continue
+                try:
+                    case = json.loads(line)
+                except ValueError:
+                    continue
+                if 'api' in case:
+                    runs.setdefault(tuple(case[k] for k in KEY), []).append(case)
+    # one noisy run should not decide a case: medians for the timings, the worst run for the counts
+    return {key: {
+        'mb_s': statistics.median(c['mb_s'] for c in cases),
+        'p99_us': statistics.median(c['p99_us'] for c in cases),
+        'allocs_per_send': max(c['allocs_per_send'] for c in cases),
+        'failed': max(c['failed'] for c in cases),
+        'delivered': all(c['delivered'] for c in cases),
+    } for key, cases in runs.items()}
+
+
+def change(old, new):
+    return (new - old) * 100 / old if old else 0.0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--baseline', nargs='+', required=True, help='outputs of the baseline version')
+    parser.add_argument('--current', nargs='+', required=True, help='outputs of the version to check')
+    parser.add_argument('--tolerance', type=float, default=15, help='allowed throughput drop, in percent')
+    parser.add_argument('--latency-tolerance', type=float, default=50, help='allowed p99 latency growth, in percent')
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+    regressions = 0
+    print(f"{'api':<10} {'payload':>7} {'buffer':>6} {'timeout':>7}  {'MB/s':>8} {'change':>7}  "
+          f"{'p99 us':>8} {'change':>7}  {'allocs/send':>14}")
+    for key in sorted(baseline):
+        old = baseline[key]
+        new = current.get(key)
+        if new is None:
+            print(f'{key[0]:<10} {key[1]:>7} {key[2]:>6} {key[3]:>7}  missing')
+            regressions += 1
+            continue
+        mb_s = change(old['mb_s'], new['mb_s'])
+        p99 = change(old['p99_us'], new['p99_us'])
+        reasons = []
+        if mb_s < -args.tolerance:
+            reasons.append('throughput')
+        if p99 > args.latency_tolerance:
+            reasons.append('p99')
+        if new['allocs_per_send'] > old['allocs_per_send'] + 0.01:
+            reasons.append('allocations')
+        if new['failed'] > old['failed'] or not new['delivered']:
+            reasons.append('failed sends')
+        regressions += bool(reasons)
+        print(f"{key[0]:<10} {key[1]:>7} {key[2]:>6} {key[3]:>7}  {new['mb_s']:8.1f} {mb_s:+6.1f}%  "
+              f"{new['p99_us']:8.2f} {p99:+6.1f}%  {old['allocs_per_send']:5.2f} -> {new['allocs_per_send']:<5.2f}"
+              f"{'  REGRESSION: ' + ', '.join(reasons) if reasons else ''}")
+    print(f'{regressions} of {len(baseline)} cases regressed')
+    sys.exit(1 if regressions else 0)
+
+
+if __name__ == '__main__':
+    main()
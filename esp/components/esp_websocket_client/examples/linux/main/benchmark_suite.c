@@ -0,0 +1,241 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <esp_log.h>
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_websocket_client.h"
+#include "benchmark_suite.h"
+#include "loopback_server.h"
+
+static const char *TAG = "benchmark_suite";
+
+#define BENCH_ROUNDS            (3)         // throughput is the best round's, latency is over all of them
+#define BENCH_ROUND_MS          (300)       // each round sends for this long...
+#define BENCH_MIN_SENDS         (200)       // ...but at least this often, for the percentiles
+#define BENCH_MAX_SENDS         (65536)     // per round
+#define BENCH_WARMUP_SENDS      (16)
+#define BENCH_DRAIN_MS          (10000)
+#define BENCH_MAX_PAYLOAD       (65536)
+
+static const int s_payload_sizes[] = { 64, 256, 1024, 4096, 16384, 65536 };
+static const int s_buffer_sizes[] = { 1024, 4096, 16384 };
+static const int s_timeouts_ms[] = { -1, 10 };   // -1 for portMAX_DELAY
+
+static volatile uint64_t s_sink_bytes;          // data frame payload the sink has read
+static uint64_t s_allocations;
+static double s_latency_us[BENCH_ROUNDS * BENCH_MAX_SENDS];
+
+#if CONFIG_WEBSOCKET_BENCHMARK_SUITE
+// Counts the heap allocations of the whole process; CMakeLists.txt links with --wrap for these
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    __atomic_add_fetch(&s_allocations, 1, __ATOMIC_RELAXED);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    __atomic_add_fetch(&s_allocations, 1, __ATOMIC_RELAXED);
+    return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    __atomic_add_fetch(&s_allocations, 1, __ATOMIC_RELAXED);
+    return __real_realloc(ptr, size);
+}
+#endif
+
+static uint64_t allocations(void)
+{
+    return __atomic_load_n(&s_allocations, __ATOMIC_RELAXED);
+}
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+// Reads frames and throws them away, counting the payload of data frames; no unmasking
+static void *sink_task(void *arg)
+{
+    int listener = (int)(intptr_t)arg;
+    static uint8_t payload[16384];
+    for (;;) {
+        int sock = loopback_server_accept(listener);
+        if (sock < 0) {
+            break;
+        }
+        for (;;) {
+            uint8_t header[14];
+            if (loopback_server_recv_all(sock, header, 2) != 0) {
+                break;
+            }
+            int opcode = header[0] & 0x0F;
+            uint64_t len = header[1] & 0x7F;
+            int extended = len == 126 ? 2 : len == 127 ? 8 : 0;
+            if (loopback_server_recv_all(sock, header + 2, extended + 4) != 0) {
+                break;
+            }
+            if (extended) {
+                len = 0;
+                for (int i = 0; i < extended; i++) {
+                    len = len << 8 | header[2 + i];
+                }
+            }
+            uint64_t left = len;
+            while (left > 0) {
+                size_t chunk = left < sizeof(payload) ? left : sizeof(payload);
+                if (loopback_server_recv_all(sock, payload, chunk) != 0) {
+                    break;
+                }
+                left -= chunk;
+            }
+            if (left > 0) {
+                break;
+            }
+            if (opcode <= WS_TRANSPORT_OPCODES_BINARY) {
+                s_sink_bytes = s_sink_bytes + len;
+            }
+        }
+        close(sock);
+    }
+    return NULL;
+}
+
+static int send_one(esp_websocket_client_handle_t client, bool text, const char *data, int len, TickType_t timeout)
+{
+    return text ? esp_websocket_client_send_text(client, data, len, timeout)
+           : esp_websocket_client_send_bin(client, data, len, timeout);
+}
+
+static void run_case(esp_websocket_client_handle_t client, int buffer_size, bool text, int payload, int timeout_ms,
+                     const char *data)
+{
+    TickType_t timeout = timeout_ms < 0 ? portMAX_DELAY : timeout_ms / portTICK_PERIOD_MS;
+    uint64_t sent_bytes = 0;
+    for (int i = 0; i < BENCH_WARMUP_SENDS; i++) {
+        if (send_one(client, text, data, payload, timeout) == payload) {
+            sent_bytes += payload;
+        }
+    }
+
+    int sends = 0;
+    int failed = 0;
+    uint64_t allocs = allocations();
+    double best_rate = 0;       // sends per second of the least disturbed round
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        int round_sends = 0;
+        double start = now_us();
+        double end = start;
+        while (round_sends < BENCH_MAX_SENDS &&
+                (round_sends < BENCH_MIN_SENDS || end - start < BENCH_ROUND_MS * 1000)) {
+            double t = now_us();
+            int ret = send_one(client, text, data, payload, timeout);
+            end = now_us();
+            s_latency_us[sends + round_sends++] = end - t;
+            if (ret == payload) {
+                sent_bytes += payload;
+            } else {
+                failed++;
+            }
+        }
+        sends += round_sends;
+        if (round_sends * 1e6 / (end - start) > best_rate) {
+            best_rate = round_sends * 1e6 / (end - start);
+        }
+    }
+    allocs = allocations() - allocs;
+
+    // the next case starts with the sink idle, so that it does not pay for this one's backlog
+    double deadline = now_us() + BENCH_DRAIN_MS * 1000;
+    while (s_sink_bytes < sent_bytes && now_us() < deadline) {
+        vTaskDelay(1);
+    }
+    if (s_sink_bytes != sent_bytes) {
+        ESP_LOGE(TAG, "sink got %" PRIu64 " of %" PRIu64 " bytes", s_sink_bytes, sent_bytes);
+    }
+    bool delivered = s_sink_bytes == sent_bytes;
+    s_sink_bytes = 0;
+
+    qsort(s_latency_us, sends, sizeof(double), compare_double);
+    printf("{\"api\": \"%s\", \"payload\": %d, \"buffer_size\": %d, \"timeout_ms\": %d, \"sends\": %d, \"failed\": %d, "
+           "\"delivered\": %s, \"mb_s\": %.2f, \"sends_s\": %.0f, \"p50_us\": %.2f, \"p99_us\": %.2f, \"max_us\": %.2f, "
+           "\"allocs_per_send\": %.3f}\n",
+           text ? "send_text" : "send_bin", payload, buffer_size, timeout_ms, sends, failed,
+           delivered ? "true" : "false", best_rate * (sends - failed) / sends * payload / (1024 * 1024),
+           best_rate, s_latency_us[sends / 2], s_latency_us[sends * 99 / 100], s_latency_us[sends - 1],
+           (double)allocs / sends);
+}
+
+static void run_buffer_size(const char *uri, int buffer_size, const char *data)
+{
+    esp_websocket_client_config_t websocket_cfg = {
+        .uri = uri,
+        .buffer_size = buffer_size,
+    };
+    esp_websocket_client_handle_t client = esp_websocket_client_init(&websocket_cfg);
+    esp_websocket_client_start(client);
+    while (!esp_websocket_client_is_connected(client)) {
+        vTaskDelay(10 / portTICK_PERIOD_MS);
+    }
+    for (int t = 0; t < sizeof(s_timeouts_ms) / sizeof(s_timeouts_ms[0]); t++) {
+        for (int text = 0; text <= 1; text++) {
+            for (int p = 0; p < sizeof(s_payload_sizes) / sizeof(s_payload_sizes[0]); p++) {
+                run_case(client, buffer_size, text, s_payload_sizes[p], s_timeouts_ms[t], data);
+            }
+        }
+    }
+    esp_websocket_client_destroy(client);
+}
+
+void benchmark_suite_run(void)
+{
+    // per-frame debug logs would dominate the timings
+    esp_log_level_set("websocket_client", ESP_LOG_WARN);
+    esp_log_level_set("transport_ws", ESP_LOG_WARN);
+    esp_log_level_set("trans_tcp", ESP_LOG_WARN);
+
+    char uri[32];
+    int listener = loopback_server_start(sink_task, uri, sizeof(uri));
+    if (listener < 0) {
+        return;
+    }
+    // printable, so that send_text() carries the same bytes a text message would
+    char *data = malloc(BENCH_MAX_PAYLOAD);
+    if (data == NULL) {
+        loopback_server_stop(listener);
+        return;
+    }
+    memset(data, 'a', BENCH_MAX_PAYLOAD);
+    printf("{\"suite\": \"esp_websocket_client\", \"idf\": \"%s\", \"rounds\": %d, \"round_ms\": %d, \"min_sends\": %d}\n",
+           esp_get_idf_version(), BENCH_ROUNDS, BENCH_ROUND_MS, BENCH_MIN_SENDS);
+    for (int b = 0; b < sizeof(s_buffer_sizes) / sizeof(s_buffer_sizes[0]); b++) {
+        run_buffer_size(uri, s_buffer_sizes[b], data);
+    }
+    free(data);
+    loopback_server_stop(listener);
+}
@@ -0,0 +1,16 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+/**
+ * @brief Sweep the send path of the client and print one JSON line per case
+ *
+ * Sends to a websocket sink on loopback for every combination of payload size (64 B to 64 KB),
+ * buffer_size, text or binary and send timeout, and prints MB/s, sends per second, p50/p99/max
+ * latency of a send call and heap allocations per send. compare_benchmark.py compares two such
+ * outputs. Needs no external server.
+ */
+void benchmark_suite_run(void);
@@ -0,0 +1,217 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <linux/tcp.h>    // struct tcp_info with the segment counters
+#include <sys/socket.h>
+#include <esp_log.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_websocket_client.h"
+#include "coalesce_benchmark.h"
+#include "loopback_server.h"
+
+static const char *TAG = "coalesce_benchmark";
+
+#define BENCH_MESSAGES          (3000)
+#define BENCH_PAYLOAD           (24)        // sequence number, padding, send time, padding: a sensor reading
+#define BENCH_TIMEOUT_MS        (30000)
+#define TCP_IP_HEADER_LEN       (52)        // IPv4 and TCP headers with timestamps, per segment
+
+static volatile bool s_coalesced;           // how the server parses the frames of the next client
+static volatile int s_messages;
+static int s_frames;
+static int s_ws_bytes;                      // websocket headers and payloads
+static int s_segments;
+static int s_out_of_order;
+static double s_latency[BENCH_MESSAGES];
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void server_message(const uint8_t *message, int len, double now)
+{
+    if (len != BENCH_PAYLOAD) {
+        return;
+    }
+    uint32_t seq;
+    double sent;
+    memcpy(&seq, message, sizeof(seq));
+    memcpy(&sent, message + 8, sizeof(sent));
+    if (seq != s_messages) {
+        s_out_of_order++;
+    }
+    if (seq < BENCH_MESSAGES) {
+        s_latency[seq] = now - sent;
+    }
+    s_messages = s_messages + 1;
+}
+
+// Reads client frames: one message each, or length-prefixed records when coalesced
+static void *server_task(void *arg)
+{
+    int listener = (int)(intptr_t)arg;
+    static uint8_t payload[65536];
+    for (;;) {
+        int sock = loopback_server_accept(listener);
+        if (sock < 0) {
+            break;
+        }
+        for (;;) {
+            uint8_t header[14];
+            if (loopback_server_recv_all(sock, header, 2) != 0) {
+                break;
+            }
+            int opcode = header[0] & 0x0F;
+            uint64_t len = header[1] & 0x7F;
+            int extended = len == 126 ? 2 : len == 127 ? 8 : 0;
+            if (loopback_server_recv_all(sock, header + 2, extended + 4) != 0) {
+                break;
+            }
+            if (extended) {
+                len = 0;
+                for (int i = 0; i < extended; i++) {
+                    len = len << 8 | header[2 + i];
+                }
+            }
+            if (len > sizeof(payload) || loopback_server_recv_all(sock, payload, len) != 0) {
+                break;
+            }
+            for (int i = 0; i < len; i++) {
+                payload[i] ^= header[2 + extended + i % 4];
+            }
+            if (opcode == WS_TRANSPORT_OPCODES_CLOSE) {
+                uint8_t close_frame[] = { 0x88, 0x00 };
+                loopback_server_send_all(sock, close_frame, sizeof(close_frame));
+                break;
+            }
+            if (opcode != WS_TRANSPORT_OPCODES_BINARY) {
+                continue;
+            }
+            double now = now_ms();
+            s_frames++;
+            s_ws_bytes += 2 + extended + 4 + len;
+            if (!s_coalesced) {
+                server_message(payload, len, now);
+                continue;
+            }
+            for (int offset = 0; offset + 2 <= len;) {
+                int record_len = payload[offset] << 8 | payload[offset + 1];
+                offset += 2;
+                if (offset + record_len > len) {
+                    break;
+                }
+                server_message(payload + offset, record_len, now);
+                offset += record_len;
+            }
+        }
+        struct tcp_info info;
+        socklen_t info_len = sizeof(info);
+        if (getsockopt(sock, IPPROTO_TCP, TCP_INFO, &info, &info_len) == 0) {
+            s_segments = info.tcpi_segs_in;
+        }
+        close(sock);
+    }
+    return NULL;
+}
+
+static void run_one(const char *uri, int coalesce_delay_ms)
+{
+    esp_websocket_client_config_t websocket_cfg = {
+        .uri = uri,
+        .coalesce_delay_ms = coalesce_delay_ms,
+    };
+    s_coalesced = coalesce_delay_ms > 0;
+    s_messages = 0;
+    s_frames = 0;
+    s_ws_bytes = 0;
+    s_segments = 0;
+    s_out_of_order = 0;
+    memset(s_latency, 0, sizeof(s_latency));
+
+    esp_websocket_client_handle_t client = esp_websocket_client_init(&websocket_cfg);
+    esp_websocket_client_start(client);
+    while (!esp_websocket_client_is_connected(client)) {
+        vTaskDelay(10 / portTICK_PERIOD_MS);
+    }
+
+    uint8_t message[BENCH_PAYLOAD] = { 0 };
+    double start = now_ms();
+    for (uint32_t seq = 0; seq < BENCH_MESSAGES; seq++) {
+        double sent = now_ms();
+        memcpy(message, &seq, sizeof(seq));
+        memcpy(message + 8, &sent, sizeof(sent));
+        int ret = coalesce_delay_ms > 0 ?
+                  esp_websocket_client_send_coalesced(client, (const char *)message, sizeof(message), portMAX_DELAY) :
+                  esp_websocket_client_send_bin(client, (const char *)message, sizeof(message), portMAX_DELAY);
+        if (ret < 0) {
+            ESP_LOGE(TAG, "send %" PRIu32 " failed", seq);
+            break;
+        }
+        vTaskDelay(1);
+    }
+    double elapsed_s = (now_ms() - start) / 1000;
+    // urgent traffic would call this right after its send; here it hands over the last records
+    esp_websocket_client_flush(client, portMAX_DELAY);
+    double deadline = now_ms() + BENCH_TIMEOUT_MS;
+    while (s_messages < BENCH_MESSAGES && now_ms() < deadline) {
+        vTaskDelay(10 / portTICK_PERIOD_MS);
+    }
+    esp_websocket_client_close(client, 2000 / portTICK_PERIOD_MS);
+    esp_websocket_client_destroy(client);
+    // the server records the segment count once it sees the connection close
+    while (s_segments == 0 && now_ms() < deadline) {
+        vTaskDelay(10 / portTICK_PERIOD_MS);
+    }
+
+    int n = s_messages;
+    if (n < BENCH_MESSAGES || s_out_of_order) {
+        ESP_LOGE(TAG, "server got %d of %d messages, %d out of order", n, BENCH_MESSAGES, s_out_of_order);
+        return;
+    }
+    qsort(s_latency, n, sizeof(double), compare_double);
+    char mode[16];
+    snprintf(mode, sizeof(mode), coalesce_delay_ms > 0 ? "%d ms" : "off", coalesce_delay_ms);
+    printf("%-8s %7.0f msgs/s %7.0f frames/s   ws %5.1f B/msg   TCP %5d segments, %6.1f B/msg   latency p50 %6.2f  p99 %6.2f  max %6.2f ms\n",
+           mode, n / elapsed_s, s_frames / elapsed_s, (double)s_ws_bytes / n,
+           s_segments, (double)(s_ws_bytes + s_segments * TCP_IP_HEADER_LEN) / n,
+           s_latency[n / 2], s_latency[n * 99 / 100], s_latency[n - 1]);
+}
+
+void coalesce_benchmark_run(void)
+{
+    // per-frame debug logs would dominate the timings
+    esp_log_level_set("websocket_client", ESP_LOG_INFO);
+    esp_log_level_set("transport_ws", ESP_LOG_INFO);
+    esp_log_level_set("trans_tcp", ESP_LOG_INFO);
+
+    char uri[32];
+    int listener = loopback_server_start(server_task, uri, sizeof(uri));
+    if (listener < 0) {
+        return;
+    }
+    printf("coalesce %d messages of %d B, one per tick\n", BENCH_MESSAGES, BENCH_PAYLOAD);
+    run_one(uri, 0);
+    run_one(uri, 5);
+    run_one(uri, 20);
+    loopback_server_stop(listener);
+}
@@ -0,0 +1,16 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+/**
+ * @brief Compare small messages sent one frame each with esp_websocket_client_send_coalesced()
+ *
+ * Sends 24 B messages, one per tick for a few seconds, to a websocket server on loopback, first with
+ * esp_websocket_client_send_bin() and then coalesced with time budgets of 5 and 20 ms. Prints the
+ * frames per second and the bytes per message on the wire (websocket framing and TCP segments as the
+ * server counted them), and the latency from the send call to the server. Needs no external server.
+ */
+void coalesce_benchmark_run(void);
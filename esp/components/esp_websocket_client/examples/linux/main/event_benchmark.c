@@ -0,0 +1,186 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <esp_log.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_websocket_client.h"
+#include "event_benchmark.h"
+#include "loopback_server.h"
+
+static const char *TAG = "event_benchmark";
+
+#define BENCH_BURST             (200000)    // messages sent back to back
+#define BENCH_PACED             (2000)      // messages sent one per millisecond
+#define BENCH_BATCH             (64)        // burst messages per write
+#define BENCH_PAYLOAD           (16)        // sequence number, padding, send time
+#define BENCH_FRAME             (2 + BENCH_PAYLOAD)
+#define BENCH_TIMEOUT_MS        (60000)
+
+static volatile int s_received;
+static double s_burst_first_ms;
+static double s_burst_last_ms;
+static double s_latency[BENCH_PACED];
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+// Unmasked binary frame: sequence number, 4 bytes of padding, CLOCK_MONOTONIC time in ms
+static void build_frame(uint8_t *frame, uint32_t seq)
+{
+    double sent = now_ms();
+    frame[0] = 0x82;
+    frame[1] = BENCH_PAYLOAD;
+    memcpy(frame + 2, &seq, sizeof(seq));
+    memset(frame + 6, 0, 4);
+    memcpy(frame + 10, &sent, sizeof(sent));
+}
+
+// Serves one client per connection: the burst, then the paced messages once the burst has been received
+static void *server_task(void *arg)
+{
+    int listener = (int)(intptr_t)arg;
+    static uint8_t batch[BENCH_BATCH * BENCH_FRAME];
+    for (;;) {
+        int sock = loopback_server_accept(listener);
+        if (sock < 0) {
+            break;
+        }
+        uint32_t seq = 0;
+        while (seq < BENCH_BURST) {
+            int n = BENCH_BURST - seq < BENCH_BATCH ? BENCH_BURST - seq : BENCH_BATCH;
+            for (int i = 0; i < n; i++) {
+                build_frame(batch + i * BENCH_FRAME, seq++);
+            }
+            if (loopback_server_send_all(sock, batch, n * BENCH_FRAME) != 0) {
+                break;
+            }
+        }
+        double deadline = now_ms() + BENCH_TIMEOUT_MS;
+        while (s_received < BENCH_BURST && now_ms() < deadline) {
+            usleep(1000);
+        }
+        while (seq < BENCH_BURST + BENCH_PACED) {
+            build_frame(batch, seq++);
+            if (loopback_server_send_all(sock, batch, BENCH_FRAME) != 0) {
+                break;
+            }
+            usleep(1000);
+        }
+        // wait for the client to close
+        while (recv(sock, batch, sizeof(batch), 0) > 0) {
+        }
+        close(sock);
+    }
+    return NULL;
+}
+
+static void record(int32_t event_id, const esp_websocket_event_data_t *data)
+{
+    static uint8_t message[BENCH_PAYLOAD];
+    if (event_id != WEBSOCKET_EVENT_DATA || data->op_code != WS_TRANSPORT_OPCODES_BINARY ||
+            data->payload_len != BENCH_PAYLOAD) {
+        return;
+    }
+    // a message split across TCP segments arrives as several events
+    memcpy(message + data->payload_offset, data->data_ptr, data->data_len);
+    if (data->payload_offset + data->data_len < data->payload_len) {
+        return;
+    }
+    double now = now_ms();
+    uint32_t seq;
+    double sent;
+    memcpy(&seq, message, sizeof(seq));
+    memcpy(&sent, message + 8, sizeof(sent));
+    if (seq < BENCH_BURST) {
+        if (seq == 0) {
+            s_burst_first_ms = now;
+        }
+        s_burst_last_ms = now;
+    } else if (seq < BENCH_BURST + BENCH_PACED) {
+        s_latency[seq - BENCH_BURST] = now - sent;
+    }
+    s_received = s_received + 1;
+}
+
+static void event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data)
+{
+    record(event_id, (const esp_websocket_event_data_t *)event_data);
+}
+
+static void event_callback(void *arg, esp_websocket_event_id_t event_id, const esp_websocket_event_data_t *data)
+{
+    record(event_id, data);
+}
+
+static void run_one(const char *uri, bool direct)
+{
+    esp_websocket_client_config_t websocket_cfg = {
+        .uri = uri,
+    };
+    esp_websocket_client_handle_t client = esp_websocket_client_init(&websocket_cfg);
+    if (direct) {
+        esp_websocket_register_callback(client, event_callback, NULL);
+    } else {
+        esp_websocket_register_events(client, WEBSOCKET_EVENT_ANY, event_handler, NULL);
+    }
+    s_received = 0;
+    memset(s_latency, 0, sizeof(s_latency));
+    esp_websocket_client_start(client);
+
+    double deadline = now_ms() + BENCH_TIMEOUT_MS;
+    while (s_received < BENCH_BURST + BENCH_PACED && now_ms() < deadline) {
+        vTaskDelay(10 / portTICK_PERIOD_MS);
+    }
+    int received = s_received;
+    esp_websocket_client_close(client, 2000 / portTICK_PERIOD_MS);
+    esp_websocket_client_destroy(client);
+    if (received < BENCH_BURST + BENCH_PACED) {
+        ESP_LOGE(TAG, "received %d of %d messages", received, BENCH_BURST + BENCH_PACED);
+        return;
+    }
+
+    qsort(s_latency, BENCH_PACED, sizeof(double), compare_double);
+    printf("%-12s %9.0f msgs/s   latency p50 %7.1f us  p99 %7.1f us  max %7.1f us\n",
+           direct ? "callback" : "event loop", (BENCH_BURST - 1) / ((s_burst_last_ms - s_burst_first_ms) / 1000),
+           s_latency[BENCH_PACED / 2] * 1000, s_latency[BENCH_PACED * 99 / 100] * 1000, s_latency[BENCH_PACED - 1] * 1000);
+}
+
+void event_benchmark_run(void)
+{
+    // per-frame debug logs would dominate the timings
+    esp_log_level_set("websocket_client", ESP_LOG_INFO);
+    esp_log_level_set("transport_ws", ESP_LOG_INFO);
+    esp_log_level_set("trans_tcp", ESP_LOG_INFO);
+
+    char uri[32];
+    int listener = loopback_server_start(server_task, uri, sizeof(uri));
+    if (listener < 0) {
+        return;
+    }
+    printf("delivery     burst of %d      %d paced messages, send to handler\n", BENCH_BURST, BENCH_PACED);
+    for (int i = 0; i < 3; i++) {
+        run_one(uri, false);
+        run_one(uri, true);
+    }
+    loopback_server_stop(listener);
+}
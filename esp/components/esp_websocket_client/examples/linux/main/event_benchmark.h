@@ -0,0 +1,16 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+/**
+ * @brief Compare event delivery through the event loop with esp_websocket_register_callback()
+ *
+ * Runs a websocket server on loopback that sends 16 B binary messages, first as fast as it can and
+ * then one per millisecond, to a client registered either with esp_websocket_register_events() or
+ * with a direct callback. Prints the messages per second delivered from the burst and the latency from the
+ * server's send to the handler for the paced messages. Needs no external server.
+ */
+void event_benchmark_run(void);
@@ -0,0 +1,132 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <esp_log.h>
+#include "mbedtls/sha1.h"
+#include "mbedtls/base64.h"
+#include "loopback_server.h"
+
+static const char *TAG = "loopback_server";
+
+static pthread_t s_server;
+
+int loopback_server_send_all(int sock, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+    while (len > 0) {
+        ssize_t n = send(sock, p, len, 0);
+        if (n <= 0) {
+            return -1;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+int loopback_server_recv_all(int sock, void *data, size_t len)
+{
+    uint8_t *p = data;
+    while (len > 0) {
+        ssize_t n = recv(sock, p, len, 0);
+        if (n <= 0) {
+            return -1;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int server_handshake(int sock)
+{
+    char request[1024];
+    int len = 0;
+    while (len < sizeof(request) - 1) {
+        int n = recv(sock, request + len, sizeof(request) - 1 - len, 0);
+        if (n <= 0) {
+            return -1;
+        }
+        len += n;
+        request[len] = '\0';
+        if (strstr(request, "\r\n\r\n")) {
+            break;
+        }
+    }
+    char *key = strcasestr(request, "Sec-WebSocket-Key:");
+    if (key == NULL) {
+        return -1;
+    }
+    key += strlen("Sec-WebSocket-Key:");
+    while (*key == ' ') {
+        key++;
+    }
+    char concat[128];
+    int key_len = strcspn(key, "\r\n");
+    int concat_len = snprintf(concat, sizeof(concat), "%.*s258EAFA5-E914-47DA-95CA-C5AB0DC85B11", key_len, key);
+    unsigned char sha1[20];
+    unsigned char accept[32];
+    size_t accept_len;
+    mbedtls_sha1((unsigned char *)concat, concat_len, sha1);
+    mbedtls_base64_encode(accept, sizeof(accept), &accept_len, sha1, sizeof(sha1));
+
+    char response[256];
+    int response_len = snprintf(response, sizeof(response),
+                                "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                                "Sec-WebSocket-Accept: %.*s\r\n\r\n", (int)accept_len, accept);
+    return loopback_server_send_all(sock, response, response_len);
+}
+
+int loopback_server_accept(int listener)
+{
+    for (;;) {
+        int sock = accept(listener, NULL, NULL);
+        if (sock < 0) {
+            return -1;
+        }
+        if (server_handshake(sock) == 0) {
+            return sock;
+        }
+        close(sock);
+    }
+}
+
+int loopback_server_start(void *(*task)(void *), char *uri, size_t uri_len)
+{
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    socklen_t addr_len = sizeof(addr);
+    if (listener < 0 || bind(listener, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listener, 1) != 0 ||
+            getsockname(listener, (struct sockaddr *)&addr, &addr_len) != 0) {
+        ESP_LOGE(TAG, "cannot listen on loopback");
+        if (listener >= 0) {
+            close(listener);
+        }
+        return -1;
+    }
+    // a plain thread, so that the server runs beside the scheduler rather than competing with the client task
+    pthread_create(&s_server, NULL, task, (void *)(intptr_t)listener);
+    snprintf(uri, uri_len, "ws://127.0.0.1:%d", ntohs(addr.sin_port));
+    return listener;
+}
+
+void loopback_server_stop(int listener)
+{
+    shutdown(listener, SHUT_RDWR);
+    close(listener);
+    pthread_join(s_server, NULL);
+}
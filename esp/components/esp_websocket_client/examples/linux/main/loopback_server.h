@@ -0,0 +1,41 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stddef.h>
+
+/**
+ * @brief Start a websocket server thread on loopback for the benchmarks
+ *
+ * @param task      Thread function; it receives the listening socket and returns when accept() fails
+ * @param uri       Filled with the ws:// URI of the server
+ * @param uri_len   Size of uri
+ *
+ * @return The listening socket, to pass to loopback_server_stop(), or -1
+ */
+int loopback_server_start(void *(*task)(void *), char *uri, size_t uri_len);
+
+/**
+ * @brief Stop accepting connections and wait for the server thread to return
+ */
+void loopback_server_stop(int listener);
+
+/**
+ * @brief Accept one connection and answer its websocket upgrade request
+ *
+ * @return The connected socket, or -1 once the listener is stopped
+ */
+int loopback_server_accept(int listener);
+
+/**
+ * @brief Write all of data, returns 0 or -1
+ */
+int loopback_server_send_all(int sock, const void *data, size_t len);
+
+/**
+ * @brief Read exactly len bytes, returns 0 or -1
+ */
+int loopback_server_recv_all(int sock, void *data, size_t len);
@@ -0,0 +1,140 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <esp_log.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_websocket_client.h"
+#include "reconnect_benchmark.h"
+
+static const char *TAG = "reconnect_benchmark";
+
+#define RECONNECT_CYCLES        (50)
+#define RECONNECT_CERT_FILE     "server_cert.pem"
+#define RECONNECT_BACKOFF_MS    (5)
+// shorter than the time the server keeps a connection, so that every drop starts the backoff over
+#define RECONNECT_TIMEOUT_MS    (100)
+#define RECONNECT_RUN_MS        (60000)
+
+static double s_disconnected_ms;
+static double s_reconnect_ms[RECONNECT_CYCLES];
+static volatile int s_reconnects;
+static int s_resumed;
+static int s_full;
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void reconnect_callback(void *arg, esp_websocket_event_id_t event_id, const esp_websocket_event_data_t *data)
+{
+    switch (event_id) {
+    case WEBSOCKET_EVENT_DISCONNECTED:
+        s_disconnected_ms = now_ms();
+        break;
+    case WEBSOCKET_EVENT_CONNECTED:
+        if (s_disconnected_ms && s_reconnects < RECONNECT_CYCLES) {
+            s_reconnect_ms[s_reconnects++] = now_ms() - s_disconnected_ms;
+        }
+        break;
+    case WEBSOCKET_EVENT_DATA:
+        // the server reports how the handshake of this connection went
+        if (data->op_code == WS_TRANSPORT_OPCODES_TEXT) {
+            if (data->data_len == 7 && memcmp(data->data_ptr, "resumed", 7) == 0) {
+                s_resumed++;
+            } else if (data->data_len == 4 && memcmp(data->data_ptr, "full", 4) == 0) {
+                s_full++;
+            }
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static char *read_cert(void)
+{
+    FILE *f = fopen(RECONNECT_CERT_FILE, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *cert = calloc(1, len + 1);
+    if (cert && fread(cert, 1, len, f) != len) {
+        free(cert);
+        cert = NULL;
+    }
+    fclose(f);
+    return cert;
+}
+
+static void run_mode(const char *uri, const char *cert, bool resumption)
+{
+    s_disconnected_ms = 0;
+    s_reconnects = 0;
+    s_resumed = 0;
+    s_full = 0;
+
+    esp_websocket_client_config_t config = {
+        .uri = uri,
+        .cert_pem = cert,
+        .tls_session_resumption = resumption,
+        .reconnect_backoff_ms = RECONNECT_BACKOFF_MS,
+        .reconnect_timeout_ms = RECONNECT_TIMEOUT_MS,
+    };
+    esp_websocket_client_handle_t client = esp_websocket_client_init(&config);
+    if (client == NULL) {
+        ESP_LOGE(TAG, "Failed to create the client");
+        return;
+    }
+    esp_websocket_register_callback(client, reconnect_callback, NULL);
+    esp_websocket_client_start(client);
+    double start = now_ms();
+    while (s_reconnects < RECONNECT_CYCLES && now_ms() - start < RECONNECT_RUN_MS) {
+        vTaskDelay(10 / portTICK_PERIOD_MS);
+    }
+    esp_websocket_client_stop(client);
+    esp_websocket_client_destroy(client);
+
+    int n = s_reconnects;
+    if (n == 0) {
+        printf("%-10s no reconnects, is reconnect_server.py running at %s?\n", resumption ? "resumed" : "full", uri);
+        return;
+    }
+    qsort(s_reconnect_ms, n, sizeof(double), compare_double);
+    printf("%-10s %4d reconnects   p50 %8.2f  p99 %8.2f  max %8.2f ms   handshakes %d full, %d resumed\n",
+           resumption ? "resumption" : "full", n, s_reconnect_ms[n / 2], s_reconnect_ms[n * 99 / 100], s_reconnect_ms[n - 1],
+           s_full, s_resumed);
+}
+
+void reconnect_benchmark_run(const char *uri)
+{
+    char *cert = read_cert();
+    if (cert == NULL) {
+        ESP_LOGE(TAG, "Could not read %s, start reconnect_server.py in this directory first", RECONNECT_CERT_FILE);
+        return;
+    }
+    esp_log_level_set("websocket_client", ESP_LOG_WARN);
+    esp_log_level_set("transport_ws", ESP_LOG_WARN);
+    printf("handshake  disconnected -> connected, including the %d ms backoff\n", RECONNECT_BACKOFF_MS);
+    run_mode(uri, cert, false);
+    run_mode(uri, cert, true);
+    free(cert);
+}
@@ -0,0 +1,18 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+/**
+ * @brief Time reconnects to a wss:// server with and without TLS session resumption
+ *
+ * Connects to reconnect_server.py, which drops every connection shortly after the handshake, and
+ * measures from each WEBSOCKET_EVENT_DISCONNECTED to the next WEBSOCKET_EVENT_CONNECTED, first with
+ * full handshakes and then with tls_session_resumption. The server's certificate is read from
+ * server_cert.pem in the current directory.
+ *
+ * @param uri   wss:// URI of reconnect_server.py, e.g. "wss://localhost:8765"
+ */
+void reconnect_benchmark_run(const char *uri);
@@ -0,0 +1,118 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <esp_log.h>
+#include "esp_websocket_client.h"
+#include "esp_websocket_mask.h"
+#include "send_benchmark.h"
+
+static const char *TAG = "send_benchmark";
+
+#define BENCH_BYTES_PER_RUN     (16 * 1024 * 1024)
+#define BENCH_HEADER_LEN        (32)    // e.g. a packet header sent in front of the samples
+
+#define MASK_BENCH_BYTES        (256 * 1024 * 1024)
+
+static const int s_payload_sizes[] = { 64, 256, 1032, 4096, 16384 };
+static const int s_frame_sizes[] = { 1024, 4096, 16384 };
+
+static double now_sec(clockid_t clock)
+{
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void run_one(esp_websocket_client_handle_t client, bool use_iov, int size, uint8_t *buf)
+{
+    int count = BENCH_BYTES_PER_RUN / size;
+    esp_websocket_iovec_t iov[2] = {
+        { .data = buf, .len = BENCH_HEADER_LEN },
+        { .data = buf + BENCH_HEADER_LEN, .len = size - BENCH_HEADER_LEN },
+    };
+
+    double wall = now_sec(CLOCK_MONOTONIC);
+    double cpu = now_sec(CLOCK_THREAD_CPUTIME_ID);
+    for (int i = 0; i < count; i++) {
+        int ret = use_iov ? esp_websocket_client_send_bin_iov(client, iov, 2, portMAX_DELAY)
+                  : esp_websocket_client_send_bin(client, (const char *)buf, size, portMAX_DELAY);
+        if (ret != size) {
+            ESP_LOGE(TAG, "send failed at %d/%d", i, count);
+            return;
+        }
+    }
+    wall = now_sec(CLOCK_MONOTONIC) - wall;
+    cpu = now_sec(CLOCK_THREAD_CPUTIME_ID) - cpu;
+
+    double mb = (double)count * size / (1024 * 1024);
+    printf("%-13s %6d B  %8.1f MB/s  %8.0f sends/s  %7.2f ms CPU/MB\n",
+           use_iov ? "send_bin_iov" : "send_bin", size, mb / wall, count / wall, cpu * 1000 / mb);
+}
+
+// What a send cost before: memcpy() into tx_buffer, then esp_transport_ws masks the buffer byte by byte
+// before the write and unmasks it again afterwards
+static void copy_then_mask(uint8_t *dst, const uint8_t *src, size_t len, const uint8_t *mask)
+{
+    memcpy(dst, src, len);
+    for (size_t i = 0; i < len; ++i) {
+        dst[i] = (dst[i] ^ mask[i % 4]);
+    }
+    for (size_t i = 0; i < len; ++i) {
+        dst[i] = (dst[i] ^ mask[i % 4]);
+    }
+}
+
+static void run_mask_one(const char *name, bool fused, int size, uint8_t *dst, const uint8_t *src)
+{
+    static const uint8_t mask[4] = { 0x12, 0x34, 0x56, 0x78 };
+    int count = MASK_BENCH_BYTES / size;
+
+    double cpu = now_sec(CLOCK_THREAD_CPUTIME_ID);
+    for (int i = 0; i < count; i++) {
+        if (fused) {
+            esp_websocket_client_copy_mask(dst, src, size, mask, 0);
+        } else {
+            copy_then_mask(dst, src, size, mask);
+        }
+        __asm__ volatile("" ::: "memory");
+    }
+    cpu = now_sec(CLOCK_THREAD_CPUTIME_ID) - cpu;
+
+    double mb = (double)count * size / (1024 * 1024);
+    printf("%-13s %6d B  %8.0f MB/s  %8.1f ns/frame\n",
+           name, size, mb / cpu, cpu * 1e9 / count);
+}
+
+void send_benchmark_mask(void)
+{
+    static uint8_t src[16384 + 1];
+    static uint8_t dst[16384 + 16];
+    for (int i = 0; i < sizeof(src); i++) {
+        src[i] = (uint8_t)i;
+    }
+    printf("staging       frame    throughput     time (CPU)\n");
+    for (int i = 0; i < sizeof(s_frame_sizes) / sizeof(s_frame_sizes[0]); i++) {
+        run_mask_one("memcpy+mask", false, s_frame_sizes[i], dst + 16, src);
+        run_mask_one("copy_mask", true, s_frame_sizes[i], dst + 16, src);
+        // user data is not necessarily word aligned
+        run_mask_one("copy_mask/u", true, s_frame_sizes[i], dst + 16, src + 1);
+    }
+}
+
+void send_benchmark_run(esp_websocket_client_handle_t client)
+{
+    static uint8_t buf[16384];
+    for (int i = 0; i < sizeof(buf); i++) {
+        buf[i] = (uint8_t)i;
+    }
+    printf("API           payload  throughput     rate          sender CPU\n");
+    for (int i = 0; i < sizeof(s_payload_sizes) / sizeof(s_payload_sizes[0]); i++) {
+        run_one(client, false, s_payload_sizes[i], buf);
+        run_one(client, true, s_payload_sizes[i], buf);
+    }
+}
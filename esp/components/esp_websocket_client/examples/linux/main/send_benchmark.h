@@ -0,0 +1,25 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include "esp_websocket_client.h"
+
+/**
+ * @brief Compare esp_websocket_client_send_bin() with esp_websocket_client_send_bin_iov()
+ *
+ * Sends 16 MB per payload size and API to a connected client and prints throughput and the CPU
+ * time the sending thread spent per MB. Point CONFIG_WEBSOCKET_URI at a local sink so that the
+ * network is not the bottleneck.
+ */
+void send_benchmark_run(esp_websocket_client_handle_t client);
+
+/**
+ * @brief Time staging a frame payload in tx_buffer
+ *
+ * Compares the fused copy-and-mask pass with memcpy() followed by the byte-wise mask and unmask
+ * esp_transport_ws applies, for 1, 4 and 16 KB frames. Needs no connection.
+ */
+void send_benchmark_mask(void);
@@ -0,0 +1,151 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <esp_log.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_websocket_client.h"
+#include "stress_test.h"
+
+static const char *TAG = "stress_test";
+
+#define STRESS_SECONDS          (10)
+#define STRESS_PAYLOAD          (1032)
+#define STRESS_MAX_SENDS        (4 * 1024 * 1024)
+#define STRESS_MAX_PINGS        (64 * 1024)
+#define STRESS_MAX_DOWNLINK     (64 * 1024)
+
+static uint8_t s_downlink[STRESS_MAX_DOWNLINK];
+static uint8_t s_expected[STRESS_MAX_DOWNLINK];
+static double s_ping_delay[STRESS_MAX_PINGS];
+static int s_pings;
+static int s_downlink_ok;
+static int s_downlink_bad;
+static int s_disconnects;
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// Same pattern as stress_server.py: the sequence number, then bytes counting up from it
+static void fill_pattern(uint8_t *buf, int len, uint32_t seq)
+{
+    if (len < 4) {
+        for (int i = 0; i < len; i++) {
+            buf[i] = (uint8_t)i;
+        }
+        return;
+    }
+    memcpy(buf, &seq, sizeof(seq));
+    for (int i = 4; i < len; i++) {
+        buf[i] = (uint8_t)(seq + (i - 4) % 256);
+    }
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void print_percentiles(const char *name, double *values, int count)
+{
+    if (count == 0) {
+        return;
+    }
+    qsort(values, count, sizeof(double), compare_double);
+    printf("%-24s p50 %8.3f  p99 %8.3f  max %8.3f ms  (n=%d)\n",
+           name, values[count / 2], values[(long)count * 99 / 100], values[count - 1], count);
+}
+
+static void stress_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data)
+{
+    esp_websocket_event_data_t *data = (esp_websocket_event_data_t *)event_data;
+    if (event_id == WEBSOCKET_EVENT_DISCONNECTED) {
+        s_disconnects++;
+        return;
+    }
+    if (event_id != WEBSOCKET_EVENT_DATA) {
+        return;
+    }
+    if (data->op_code == WS_TRANSPORT_OPCODES_PING && data->data_len == 12 && s_pings < STRESS_MAX_PINGS) {
+        // the server stamps each ping with its CLOCK_MONOTONIC time in seconds
+        double sent;
+        memcpy(&sent, data->data_ptr + 4, sizeof(sent));
+        s_ping_delay[s_pings++] = now_ms() - sent * 1000;
+        return;
+    }
+    if (data->op_code != WS_TRANSPORT_OPCODES_BINARY || data->payload_len > STRESS_MAX_DOWNLINK) {
+        return;
+    }
+    memcpy(s_downlink + data->payload_offset, data->data_ptr, data->data_len);
+    if (data->payload_offset + data->data_len < data->payload_len) {
+        return;
+    }
+    uint32_t seq = 0;
+    if (data->payload_len >= 4) {
+        memcpy(&seq, s_downlink, sizeof(seq));
+    }
+    fill_pattern(s_expected, data->payload_len, seq);
+    if (memcmp(s_expected, s_downlink, data->payload_len) == 0) {
+        s_downlink_ok++;
+    } else {
+        s_downlink_bad++;
+    }
+}
+
+void stress_test_run(esp_websocket_client_handle_t client)
+{
+    static uint8_t msg[STRESS_PAYLOAD];
+    double *latency = malloc(STRESS_MAX_SENDS * sizeof(double));
+    if (latency == NULL) {
+        ESP_LOGE(TAG, "no memory for the latency samples");
+        return;
+    }
+
+    // per-frame debug logs would dominate the timings
+    esp_log_level_set("websocket_client", ESP_LOG_INFO);
+    esp_log_level_set("transport_ws", ESP_LOG_INFO);
+    esp_log_level_set("trans_tcp", ESP_LOG_INFO);
+
+    esp_websocket_register_events(client, WEBSOCKET_EVENT_ANY, stress_event_handler, NULL);
+    esp_websocket_client_start(client);
+    while (!esp_websocket_client_is_connected(client)) {
+        vTaskDelay(10 / portTICK_PERIOD_MS);
+    }
+
+    int sends = 0;
+    int errors = 0;
+    double start = now_ms();
+    while (now_ms() - start < STRESS_SECONDS * 1000 && sends < STRESS_MAX_SENDS) {
+        fill_pattern(msg, sizeof(msg), sends);
+        double t0 = now_ms();
+        if (esp_websocket_client_send_bin(client, (const char *)msg, sizeof(msg), portMAX_DELAY) != sizeof(msg)) {
+            errors++;
+        }
+        latency[sends++] = now_ms() - t0;
+    }
+    double elapsed = (now_ms() - start) / 1000;
+
+    // let the last downlink messages arrive before closing; closing disconnects too, so count before
+    vTaskDelay(300 / portTICK_PERIOD_MS);
+    int disconnects = s_disconnects;
+    esp_websocket_client_close(client, 2000 / portTICK_PERIOD_MS);
+
+    printf("uplink: %d x %d B in %.1f s, %.1f MB/s, %d send errors\n",
+           sends, STRESS_PAYLOAD, elapsed, sends * (double)STRESS_PAYLOAD / elapsed / (1024 * 1024), errors);
+    print_percentiles("send latency", latency, sends);
+    print_percentiles("ping delay", s_ping_delay, s_pings);
+    printf("downlink: %d messages ok, %d bad; %d disconnects\n", s_downlink_ok, s_downlink_bad, disconnects);
+    printf("stress test %s\n", errors == 0 && s_downlink_bad == 0 && disconnects == 0 ? "PASSED" : "FAILED");
+    free(latency);
+}
@@ -0,0 +1,18 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include "esp_websocket_client.h"
+
+/**
+ * @brief Send and receive at full rate at the same time
+ *
+ * Registers its own event handler, starts the client and, once connected, sends 1032 B binary
+ * messages as fast as possible for 10 s while stress_server.py pings the client and sends downlink
+ * messages. Prints the send latency, how long pings waited before the client read them and whether
+ * every downlink message arrived intact.
+ */
+void stress_test_run(esp_websocket_client_handle_t client);
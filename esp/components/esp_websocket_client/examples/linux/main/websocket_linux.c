@@ -11,6 +11,12 @@
 #include "esp_system.h"
 #include "esp_event.h"
 #include "esp_netif.h"
+#include "send_benchmark.h"
+#include "stress_test.h"
+#include "event_benchmark.h"
+#include "reconnect_benchmark.h"
+#include "coalesce_benchmark.h"
+#include "benchmark_suite.h"
 
 static const char *TAG = "websocket";
 
@@ -71,6 +77,26 @@ static void websocket_event_handler(void *handler_args, esp_event_base_t base, i
 
 static void websocket_app_start(void)
 {
+#if CONFIG_WEBSOCKET_EVENT_BENCHMARK
+    // runs its own server on loopback
+    event_benchmark_run();
+    return;
+#endif
+#if CONFIG_WEBSOCKET_RECONNECT_BENCHMARK
+    // creates a client per mode
+    reconnect_benchmark_run(CONFIG_WEBSOCKET_URI);
+    return;
+#endif
+#if CONFIG_WEBSOCKET_COALESCE_BENCHMARK
+    // runs its own server on loopback
+    coalesce_benchmark_run();
+    return;
+#endif
+#if CONFIG_WEBSOCKET_BENCHMARK_SUITE
+    // runs its own sink on loopback, one client per buffer_size
+    benchmark_suite_run();
+    return;
+#endif
     esp_websocket_client_config_t websocket_cfg = {};
 
     websocket_cfg.uri = CONFIG_WEBSOCKET_URI;
@@ -81,9 +107,24 @@ static void websocket_app_start(void)
     // This call demonstrates adding another header; it's called to increase code coverage
     esp_websocket_client_append_header(client, "HeaderNewKey", "value");
 
+#if CONFIG_WEBSOCKET_STRESS_TEST
+    // the stress test registers a quiet handler of its own
+    stress_test_run(client);
+    esp_websocket_client_destroy(client);
+    return;
+#endif
     esp_websocket_register_events(client, WEBSOCKET_EVENT_ANY, websocket_event_handler, (void *)client);
 
     esp_websocket_client_start(client);
+#if CONFIG_WEBSOCKET_SEND_BENCHMARK
+    send_benchmark_mask();
+    while (!esp_websocket_client_is_connected(client)) {
+        vTaskDelay(100 / portTICK_PERIOD_MS);
+    }
+    send_benchmark_run(client);
+    esp_websocket_client_destroy(client);
+    return;
+#endif
     char data[32];
     int i = 0;
     while (i < 1) {
@@ -0,0 +1,95 @@
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Unlicense OR CC0-1.0
+"""Secure websocket server for the reconnect benchmark of the host example.
+
+Each connection is told in a text message whether its TLS handshake resumed an earlier session
+("resumed") or was a full one ("full"), and is dropped --hold-ms later without a close frame, so the
+client reconnects right away.
+
+Without --cert/--key a self-signed certificate for "localhost" is created with the openssl command
+line tool as server_cert.pem/server_key.pem in the current directory; the benchmark trusts
+server_cert.pem.
+"""
+import argparse
+import base64
+import hashlib
+import os
+import socket
+import ssl
+import subprocess
+import threading
+import time
+
+GUID = b'258EAFA5-E914-47DA-95CA-C5AB0DC85B11'
+
+
+def make_cert(cert, key):
+    if os.path.exists(cert) and os.path.exists(key):
+        return
+    subprocess.run(['openssl', 'req', '-x509', '-newkey', 'rsa:2048', '-nodes', '-days', '365',
+                    '-subj', '/CN=localhost', '-addext', 'subjectAltName=DNS:localhost',
+                    '-keyout', key, '-out', cert], check=True, capture_output=True)
+
+
+def handshake(conn):
+    request = b''
+    while b'\r\n\r\n' not in request:
+        chunk = conn.recv(1024)
+        if not chunk:
+            raise EOFError
+        request += chunk
+    key = b''
+    for line in request.split(b'\r\n'):
+        if line.lower().startswith(b'sec-websocket-key:'):
+            key = line.split(b':', 1)[1].strip()
+    accept = base64.b64encode(hashlib.sha1(key + GUID).digest())
+    conn.sendall(b'HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n'
+                 b'Sec-WebSocket-Accept: ' + accept + b'\r\n\r\n')
+
+
+def serve(conn, args, stats):
+    try:
+        handshake(conn)
+        reused = conn.session_reused
+        stats['resumed' if reused else 'full'] += 1
+        status = b'resumed' if reused else b'full'
+        conn.sendall(bytes([0x81, len(status)]) + status)
+        time.sleep(args.hold_ms / 1000)
+    except (EOFError, OSError):
+        pass
+    finally:
+        conn.close()
+    print(f"{stats['full']} full, {stats['resumed']} resumed handshakes", flush=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--port', type=int, default=8765)
+    parser.add_argument('--hold-ms', type=int, default=100, help='how long a connection stays up')
+    parser.add_argument('--cert', default='server_cert.pem')
+    parser.add_argument('--key', default='server_key.pem')
+    args = parser.parse_args()
+
+    make_cert(args.cert, args.key)
+    context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    context.load_cert_chain(args.cert, args.key)
+    stats = {'full': 0, 'resumed': 0}
+
+    server = socket.socket()
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind(('', args.port))
+    server.listen(4)
+    print(f'Listening on port {args.port}', flush=True)
+    while True:
+        conn, _ = server.accept()
+        conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        try:
+            conn = context.wrap_socket(conn, server_side=True)
+        except (ssl.SSLError, OSError):
+            conn.close()
+            continue
+        threading.Thread(target=serve, args=(conn, args, stats), daemon=True).start()
+
+
+if __name__ == '__main__':
+    main()
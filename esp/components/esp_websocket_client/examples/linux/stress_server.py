@@ -0,0 +1,195 @@
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Unlicense OR CC0-1.0
+"""Websocket server for the full-duplex stress test of the host example.
+
+While the client sends binary messages as fast as it can, the server pings it and sends
+downlink messages at a fixed rate. Uplink messages are checked against the pattern the
+client generates, pings carry the time they were sent so the client can measure how long
+they waited, and the round trip of each ping is measured here.
+
+Options to make one direction slow:
+  --stall-ms  stop reading the uplink for this long once per second (client sends block)
+  --split-ms  send each downlink frame in two halves this far apart (client reads block)
+
+A JSON summary is printed when the client disconnects.
+"""
+import argparse
+import base64
+import hashlib
+import json
+import socket
+import struct
+import threading
+import time
+
+GUID = b'258EAFA5-E914-47DA-95CA-C5AB0DC85B11'
+
+
+def pattern(seq, n):
+    """Message `seq` of `n` bytes: the sequence number, then bytes counting up from it."""
+    if n < 4:
+        return bytes(range(n))
+    body = bytes((seq + i) & 0xFF for i in range(256))
+    return (struct.pack('<I', seq) + body * (n // 256 + 1))[:n]
+
+
+def frame(opcode, payload):
+    n = len(payload)
+    head = bytes([0x80 | opcode])
+    if n < 126:
+        head += bytes([n])
+    elif n < 65536:
+        head += bytes([126]) + struct.pack('>H', n)
+    else:
+        head += bytes([127]) + struct.pack('>Q', n)
+    return head + payload
+
+
+def recv_exact(conn, n):
+    buf = bytearray()
+    while len(buf) < n:
+        chunk = conn.recv(n - len(buf))
+        if not chunk:
+            raise EOFError
+        buf += chunk
+    return bytes(buf)
+
+
+def unmask(data, mask):
+    n = len(data)
+    key = (mask * (n // 4 + 1))[:n]
+    return (int.from_bytes(data, 'little') ^ int.from_bytes(key, 'little')).to_bytes(n, 'little')
+
+
+def percentiles(values):
+    if not values:
+        return None
+    v = sorted(values)
+    return {'p50': round(v[len(v) // 2], 2), 'p99': round(v[len(v) * 99 // 100], 2), 'max': round(v[-1], 2)}
+
+
+class Connection:
+    def __init__(self, conn, args):
+        self.conn = conn
+        self.args = args
+        self.wlock = threading.Lock()
+        self.alive = True
+        self.ping_sent = {}
+        self.rtt_ms = []
+        self.stats = {'messages': 0, 'bytes': 0, 'bad': 0, 'unmasked': 0, 'pings': 0, 'pongs': 0, 'downlink': 0}
+
+    def handshake(self):
+        request = b''
+        while b'\r\n\r\n' not in request:
+            chunk = self.conn.recv(1024)
+            if not chunk:
+                raise EOFError
+            request += chunk
+        key = b''
+        for line in request.split(b'\r\n'):
+            if line.lower().startswith(b'sec-websocket-key:'):
+                key = line.split(b':', 1)[1].strip()
+        accept = base64.b64encode(hashlib.sha1(key + GUID).digest())
+        self.conn.sendall(b'HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n'
+                          b'Sec-WebSocket-Accept: ' + accept + b'\r\n\r\n')
+
+    def flood(self):
+        period = 1.0 / self.args.rate
+        seq = 0
+        while self.alive:
+            try:
+                with self.wlock:
+                    self.ping_sent[seq] = time.monotonic()
+                    self.conn.sendall(frame(0x9, struct.pack('<Id', seq, time.monotonic())))
+                    self.stats['pings'] += 1
+                    if self.args.downlink:
+                        data = frame(0x2, pattern(seq, self.args.downlink))
+                        if self.args.split_ms:
+                            self.conn.sendall(data[:len(data) // 2])
+                            time.sleep(self.args.split_ms / 1000)
+                            data = data[len(data) // 2:]
+                        self.conn.sendall(data)
+                        self.stats['downlink'] += 1
+            except OSError:
+                break
+            seq += 1
+            time.sleep(period)
+
+    def run(self):
+        self.handshake()
+        threading.Thread(target=self.flood, daemon=True).start()
+        message = bytearray()
+        last_stall = time.monotonic()
+        try:
+            while True:
+                if self.args.stall_ms and time.monotonic() - last_stall > 1:
+                    time.sleep(self.args.stall_ms / 1000)
+                    last_stall = time.monotonic()
+                head = recv_exact(self.conn, 2)
+                fin, opcode, n = head[0] & 0x80, head[0] & 0x0F, head[1] & 0x7F
+                if n == 126:
+                    n = struct.unpack('>H', recv_exact(self.conn, 2))[0]
+                elif n == 127:
+                    n = struct.unpack('>Q', recv_exact(self.conn, 8))[0]
+                if head[1] & 0x80:
+                    mask = recv_exact(self.conn, 4)
+                    payload = unmask(recv_exact(self.conn, n), mask) if n else b''
+                else:
+                    self.stats['unmasked'] += 1
+                    payload = recv_exact(self.conn, n)
+                if opcode == 0x8:
+                    with self.wlock:
+                        self.conn.sendall(frame(0x8, payload[:2]))
+                    break
+                if opcode == 0x9:
+                    with self.wlock:
+                        self.conn.sendall(frame(0xA, payload))
+                    continue
+                if opcode == 0xA:
+                    self.stats['pongs'] += 1
+                    if len(payload) >= 4:
+                        sent = self.ping_sent.pop(struct.unpack_from('<I', payload)[0], None)
+                        if sent is not None:
+                            self.rtt_ms.append((time.monotonic() - sent) * 1000)
+                    continue
+                if opcode != 0:
+                    message = bytearray()
+                message += payload
+                if not fin:
+                    continue
+                self.stats['messages'] += 1
+                self.stats['bytes'] += len(message)
+                seq = struct.unpack_from('<I', message)[0] if len(message) >= 4 else 0
+                if bytes(message) != pattern(seq, len(message)):
+                    self.stats['bad'] += 1
+        except (EOFError, OSError):
+            pass
+        finally:
+            self.alive = False
+            self.conn.close()
+        self.stats['pong_rtt_ms'] = percentiles(self.rtt_ms)
+        print(json.dumps(self.stats), flush=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--port', type=int, default=8765)
+    parser.add_argument('--rate', type=float, default=100, help='pings (and downlink messages) per second')
+    parser.add_argument('--downlink', type=int, default=4096, help='downlink message size, 0 for none')
+    parser.add_argument('--stall-ms', type=int, default=0)
+    parser.add_argument('--split-ms', type=int, default=0)
+    args = parser.parse_args()
+
+    server = socket.socket()
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind(('', args.port))
+    server.listen(1)
+    print(f'Listening on port {args.port}', flush=True)
+    while True:
+        conn, _ = server.accept()
+        conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        threading.Thread(target=Connection(conn, args).run, daemon=True).start()
+
+
+if __name__ == '__main__':
+    main()
@@ -81,6 +81,23 @@ typedef struct {
     esp_websocket_error_codes_t error_handle; /*!< esp-websocket error handle including esp-tls errors as well as internal websocket errors */
 } esp_websocket_event_data_t;
 
+/**
+ * @brief Callback that receives the client's events directly (see esp_websocket_register_callback())
+ *
+ * @param arg       User context given at registration
+ * @param event_id  The event id
+ * @param data      Event data, valid only during the call; for WEBSOCKET_EVENT_DATA, data->data_ptr points into the client's receive buffer
+ */
+typedef void (*esp_websocket_event_callback_t)(void *arg, esp_websocket_event_id_t event_id, const esp_websocket_event_data_t *data);
+
+/**
+ * @brief One buffer of a scatter-gather send (see esp_websocket_client_send_bin_iov())
+ */
+typedef struct {
+    void *data;                             /*!< Buffer; masked in place during the send and restored before it returns */
+    size_t len;                             /*!< Length of the buffer */
+} esp_websocket_iovec_t;
+
 /**
  * @brief Websocket Client transport
  */
@@ -106,6 +123,8 @@ typedef struct {
     const char                 *task_name;                  /*!< Websocket task name */
     int                         task_stack;                 /*!< Websocket task stack */
     int                         buffer_size;                /*!< Websocket buffer size */
+    int                         coalesce_delay_ms;          /*!< Enables esp_websocket_client_send_coalesced(): records are held for at most this many milliseconds and then sent together in one binary frame. 0 (default) disables coalescing */
+    int                         coalesce_size;              /*!< Largest coalesced frame payload, records and their 2-byte length prefixes included; a frame is sent as soon as the next record would not fit. Defaults to buffer_size */
     const char                  *cert_pem;                  /*!< Pointer to certificate data in PEM or DER format for server verify (with SSL), default is NULL, not required to verify the server. PEM-format must have a terminating NULL-character. DER-format requires the length to be passed in cert_len. */
     size_t                      cert_len;                   /*!< Length of the buffer pointed to by cert_pem. May be 0 for null-terminated pem */
     const char                  *client_cert;               /*!< Pointer to certificate data in PEM or DER format for SSL mutual authentication, default is NULL, not required if mutual authentication is not needed. If it is not NULL, also `client_key` or `client_ds_data` (if supported) has to be provided. PEM-format must have a terminating NULL-character. DER-format requires the length to be passed in client_cert_len. */
@@ -125,11 +144,13 @@ typedef struct {
     esp_err_t (*crt_bundle_attach)(void *conf);             /*!< Function pointer to esp_crt_bundle_attach. Enables the use of certification bundle for server verification, MBEDTLS_CERTIFICATE_BUNDLE must be enabled in menuconfig. Include esp_crt_bundle.h, and use `esp_crt_bundle_attach` here to include bundled CA certificates. */
     const char                  *cert_common_name;          /*!< Expected common name of the server certificate */
     bool                        skip_cert_common_name_check;/*!< Skip any validation of server certificate CN field */
+    bool                        tls_session_resumption;     /*!< Keep the TLS session (ID or ticket) of a connection and resume it when reconnecting, skipping the full handshake. Requires CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS; the certificate options above still apply */
     bool                        keep_alive_enable;          /*!< Enable keep-alive timeout */
     int                         keep_alive_idle;            /*!< Keep-alive idle time. Default is 5 (second) */
     int                         keep_alive_interval;        /*!< Keep-alive interval time. Default is 5 (second) */
     int                         keep_alive_count;           /*!< Keep-alive packet retry send count. Default is 3 counts */
     int                         reconnect_timeout_ms;       /*!< Reconnect after this value in miliseconds if disable_auto_reconnect is not enabled (defaults to 10s) */
+    int                         reconnect_backoff_ms;       /*!< If set, the first reconnect waits this many milliseconds and each further failed attempt doubles the delay, up to reconnect_timeout_ms; a connection that stayed up for reconnect_timeout_ms starts over. Defaults to 0: every attempt waits reconnect_timeout_ms */
     int                         network_timeout_ms;         /*!< Abort network operation if it is not completed after this value, in milliseconds (defaults to 10s) */
     size_t                      ping_interval_sec;          /*!< Websocket ping interval, defaults to 10 seconds if not set */
     struct ifreq                *if_name;                   /*!< The name of interface for data to go through. Use the default interface without setting */
@@ -256,6 +277,66 @@ esp_err_t esp_websocket_client_destroy_on_exit(esp_websocket_client_handle_t cli
  */
 int esp_websocket_client_send_bin(esp_websocket_client_handle_t client, const char *data, int len, TickType_t timeout);
 
+/**
+ * @brief      Write several buffers as one binary WebSocket frame, without staging them in the tx buffer
+ *
+ *  Notes:
+ *   - The frame is not split at `buffer_size`; its length is the sum of the buffer lengths.
+ *   - Client frames are masked, and this is done in place: the buffers must be writable and must not be
+ *     read by other tasks during the call. They hold their original content again when the call returns.
+ *   - Buffers up to 128 bytes are copied next to the frame header so that headers and small records do
+ *     not cost a transport write each.
+ *   - With an external transport (`ext_transport`) the buffers are sent as a fragmented message, one
+ *     frame per buffer, through the regular tx buffer.
+ *
+ * @param[in]  client  The client
+ * @param[in]  iov     The buffers, in order
+ * @param[in]  iovcnt  Number of buffers
+ * @param[in]  timeout Write data timeout in RTOS ticks
+ *
+ * @return
+ *     - Number of payload bytes sent
+ *     - (-1) if any errors
+ */
+int esp_websocket_client_send_bin_iov(esp_websocket_client_handle_t client, const esp_websocket_iovec_t *iov, int iovcnt, TickType_t timeout);
+
+/**
+ * @brief      Queue a small message to be sent together with others in one binary frame
+ *
+ * Records queued within `coalesce_delay_ms` of the first one are packed into a single binary frame, each
+ * preceded by its length as a 2-byte big-endian integer. The frame is sent when the time budget runs out,
+ * when the next record would not fit in `coalesce_size`, when esp_websocket_client_flush() is called, or
+ * before any other data frame, so records keep their order with the client's other messages.
+ *
+ *  Notes:
+ *   - Requires `coalesce_delay_ms` in the configuration.
+ *   - Records still queued when the connection drops are lost.
+ *   - Do not call it between the frames of a message sent with the `_partial` functions.
+ *
+ * @param[in]  client  The client
+ * @param[in]  data    The record
+ * @param[in]  len     The length, at most coalesce_size - 2
+ * @param[in]  timeout Timeout in RTOS ticks, for tx lock and for a frame sent by this call
+ *
+ * @return
+ *     - Number of bytes queued (len)
+ *     - (-1) if any errors
+ */
+int esp_websocket_client_send_coalesced(esp_websocket_client_handle_t client, const char *data, int len, TickType_t timeout);
+
+/**
+ * @brief      Send the records queued by esp_websocket_client_send_coalesced() now, for urgent traffic
+ *
+ * @param[in]  client  The client
+ * @param[in]  timeout Timeout in RTOS ticks
+ *
+ * @return
+ *     - ESP_OK if the records were sent, or there were none
+ *     - ESP_ERR_INVALID_ARG if the client is NULL
+ *     - ESP_FAIL if the client is not connected or the frame could not be sent
+ */
+esp_err_t esp_websocket_client_flush(esp_websocket_client_handle_t client, TickType_t timeout);
+
 /**
  * @brief      Write binary data to the WebSocket connection and sends it without setting the FIN flag(data send with WS OPCODE=02, i.e. binary)
  *
@@ -460,6 +541,29 @@ esp_err_t esp_websocket_register_events(esp_websocket_client_handle_t client,
                                         esp_event_handler_t event_handler,
                                         void *event_handler_arg);
 
+/**
+ * @brief Deliver the events to a callback called directly from the client task
+ *
+ * Instead of posting each event to the client's event loop, the client task calls the callback
+ * synchronously, with the event data on its stack and, for WEBSOCKET_EVENT_DATA, a pointer into the
+ * receive buffer. Nothing is copied or allocated per event. While a callback is set, handlers
+ * registered with esp_websocket_register_events() are not called.
+ *
+ * The callback runs on the client task: it must not block, and must copy anything it keeps after
+ * returning. The next read overwrites the receive buffer.
+ *
+ * @param client        The client handle
+ * @param callback      The callback, or NULL to go back to the event loop
+ * @param callback_arg  User context passed to the callback
+ * @return
+ *     - ESP_OK on success
+ *     - ESP_ERR_INVALID_ARG if the client is NULL
+ *     - ESP_ERR_INVALID_STATE if the client is running; set the callback before esp_websocket_client_start()
+ */
+esp_err_t esp_websocket_register_callback(esp_websocket_client_handle_t client,
+        esp_websocket_event_callback_t callback,
+        void *callback_arg);
+
 #ifdef __cplusplus
 }
 #endif
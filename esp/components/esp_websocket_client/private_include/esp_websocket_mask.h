@@ -0,0 +1,32 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief      Copy data while applying the RFC 6455 client mask
+ *
+ * Each byte is XOR-ed with `mask[(offset + i) % 4]` on its way from `src` to `dst`, so the payload
+ * is read and written only once. The bulk of the buffer is processed a 32-bit word at a time;
+ * neither pointer has to be aligned.
+ *
+ * @param      dst     Destination; may be equal to `src` to mask in place, must not overlap otherwise
+ * @param      src     Source data
+ * @param      len     Number of bytes
+ * @param      mask    The 4 byte mask key of the frame
+ * @param      offset  Position of `src[0]` in the frame payload
+ */
+void esp_websocket_client_copy_mask(uint8_t *dst, const uint8_t *src, size_t len, const uint8_t *mask, size_t offset);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,37 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include "esp_tls.h"
+#include "esp_transport.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+
+/**
+ * @brief      Create a TLS transport that resumes its previous session when it reconnects
+ *
+ * Behaves like esp_transport_ssl, but is configured with an esp_tls_cfg_t. When a connection is
+ * closed, its session (ID or ticket) is kept and offered in the next handshake, which then skips the
+ * certificate exchange and key agreement. A server that no longer knows the session answers with a
+ * full handshake. After a failed handshake the session is dropped.
+ *
+ * TLS errors are logged by the transport; esp_transport_get_error_handle() does not report them.
+ *
+ * @param      cfg   TLS configuration, copied; the buffers it points to must outlive the transport
+ *
+ * @return     The transport, or NULL if out of memory
+ */
+esp_transport_handle_t esp_websocket_tls_init(const esp_tls_cfg_t *cfg);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
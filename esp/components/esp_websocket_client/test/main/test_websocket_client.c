@@ -0,0 +1,536 @@
+/*
+ * SPDX-FileCopyrightText: 2021-2022 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ *
+ * This test code is in the Public Domain (or CC0 licensed, at your option.)
+ *
+ * Unless required by applicable law or agreed to in writing, this
+ * software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ * CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <esp_websocket_client.h>
+#include "esp_websocket_mask.h"
+#include "esp_websocket_tls.h"
+#include "esp_event.h"
+#include "esp_cpu.h"
+#include "esp_transport.h"
+#include "esp_transport_ws.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "mbedtls/sha1.h"
+#include "mbedtls/base64.h"
+#include "esp_crt_bundle.h"
+#include "unity.h"
+#include "test_utils.h"
+
+#include "unity_fixture.h"
+#include "memory_checks.h"
+
+TEST_GROUP(websocket);
+
+TEST_SETUP(websocket)
+{
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 1, 0)
+    /* IDF v5.0 runs some lazy inits within printf()
+     * This test sets the leak threshold to 0, so we need to call printf()
+     * before recording the heap size in test_utils_record_free_mem()
+     */
+    printf("TEST_SETUP: websocket\n");
+#endif
+    test_utils_record_free_mem();
+    TEST_ESP_OK(test_utils_set_leak_level(0, ESP_LEAK_TYPE_CRITICAL, ESP_COMP_LEAK_GENERAL));
+}
+
+TEST_TEAR_DOWN(websocket)
+{
+    test_utils_finish_and_evaluate_leaks(0, 0);
+}
+
+
+TEST(websocket, websocket_init_deinit)
+{
+    const esp_websocket_client_config_t websocket_cfg = {
+        // no connection takes place, but the uri has to be valid for init() to succeed
+        .uri = "ws://echo.websocket.org",
+    };
+    esp_websocket_client_handle_t client = esp_websocket_client_init(&websocket_cfg);
+    TEST_ASSERT_NOT_EQUAL(NULL, client);
+    esp_websocket_client_destroy(client);
+}
+
+TEST(websocket, websocket_init_invalid_url)
+{
+    const esp_websocket_client_config_t websocket_cfg = {
+        .uri = "INVALID",
+    };
+    esp_websocket_client_handle_t client = esp_websocket_client_init(&websocket_cfg);
+    TEST_ASSERT_NULL(client);
+}
+
+TEST(websocket, websocket_set_invalid_url)
+{
+    const esp_websocket_client_config_t websocket_cfg = {};
+    esp_websocket_client_handle_t client = esp_websocket_client_init(&websocket_cfg);
+    TEST_ASSERT_NOT_EQUAL(NULL, client);
+    TEST_ASSERT_NOT_EQUAL(ESP_OK, esp_websocket_client_set_uri(client, "INVALID"));
+    esp_websocket_client_destroy(client);
+}
+
+static void test_event_callback(void *arg, esp_websocket_event_id_t event_id, const esp_websocket_event_data_t *data)
+{
+}
+
+TEST(websocket, websocket_register_callback)
+{
+    const esp_websocket_client_config_t websocket_cfg = {
+        .uri = "ws://echo.websocket.org",
+    };
+    esp_websocket_client_handle_t client = esp_websocket_client_init(&websocket_cfg);
+    TEST_ASSERT_NOT_EQUAL(NULL, client);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_websocket_register_callback(NULL, test_event_callback, NULL));
+    // a stopped client accepts the callback, and NULL to go back to the event loop
+    TEST_ASSERT_EQUAL(ESP_OK, esp_websocket_register_callback(client, test_event_callback, client));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_websocket_register_callback(client, NULL, NULL));
+    esp_websocket_client_destroy(client);
+}
+
+TEST(websocket, websocket_coalesce_config)
+{
+    esp_websocket_client_config_t websocket_cfg = {
+        .uri = "ws://echo.websocket.org",
+    };
+    esp_websocket_client_handle_t client = esp_websocket_client_init(&websocket_cfg);
+    TEST_ASSERT_NOT_EQUAL(NULL, client);
+    // coalescing is off without coalesce_delay_ms, and there is nothing to flush
+    TEST_ASSERT_EQUAL(-1, esp_websocket_client_send_coalesced(client, "x", 1, 0));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_websocket_client_flush(client, 0));
+    esp_websocket_client_destroy(client);
+
+    websocket_cfg.coalesce_delay_ms = 20;
+    websocket_cfg.coalesce_size = 2;
+    TEST_ASSERT_NULL(esp_websocket_client_init(&websocket_cfg));
+
+    websocket_cfg.coalesce_size = 64;
+    client = esp_websocket_client_init(&websocket_cfg);
+    TEST_ASSERT_NOT_EQUAL(NULL, client);
+    // a record that can never fit, and one that could but the client is not connected
+    char record[63] = { 0 };
+    TEST_ASSERT_EQUAL(-1, esp_websocket_client_send_coalesced(client, record, sizeof(record), 0));
+    TEST_ASSERT_EQUAL(-1, esp_websocket_client_send_coalesced(client, record, sizeof(record) - 1, 0));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_websocket_client_flush(NULL, 0));
+    esp_websocket_client_destroy(client);
+}
+
+// A link under the ws transport that answers the upgrade request itself and then stays quiet, so the client task
+// sits in esp_transport_poll_read() while the test sends. Once `broken`, every write fails, and with `read_error`
+// the poll fails too, as both sides of a dead socket do. `close_delay_ms` holds the client task inside
+// esp_transport_close(), with tx_lock taken, so a send can be started right in the middle of the abort.
+typedef struct {
+    char response[192];
+    int response_len;
+    int response_sent;
+    volatile bool open;
+    volatile bool broken;
+    volatile bool read_error;
+    volatile bool closing;
+    int close_delay_ms;
+    volatile int writes;                // writes that reached the link after the upgrade
+    volatile int writes_after_close;
+} test_link_t;
+
+static test_link_t s_link;
+static volatile int s_disconnected;
+
+static int test_link_connect(esp_transport_handle_t t, const char *host, int port, int timeout_ms)
+{
+    s_link.open = true;
+    s_link.response_len = 0;
+    s_link.response_sent = 0;
+    return 0;
+}
+
+static int test_link_write(esp_transport_handle_t t, const char *buffer, int len, int timeout_ms)
+{
+    if (!s_link.open) {
+        s_link.writes_after_close++;
+        return -1;
+    }
+    if (s_link.response_len == 0) {
+        // the upgrade request: accept it with the key it carries (this runs in the client task, so a malformed
+        // request fails the handshake rather than asserting, and the test fails on not connecting)
+        static const char guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+        const char *key = strstr(buffer, "Sec-WebSocket-Key: ");
+        const char *key_end = key ? strstr(key, "\r\n") : NULL;
+        unsigned char keyed[64 + sizeof(guid)];
+        unsigned char sha1[20];
+        unsigned char accept[32];
+        size_t accept_len;
+        if (key_end == NULL || key_end - key - strlen("Sec-WebSocket-Key: ") >= 64) {
+            return -1;
+        }
+        key += strlen("Sec-WebSocket-Key: ");
+        int key_len = key_end - key;
+        memcpy(keyed, key, key_len);
+        memcpy(keyed + key_len, guid, sizeof(guid) - 1);
+        mbedtls_sha1(keyed, key_len + sizeof(guid) - 1, sha1);
+        if (mbedtls_base64_encode(accept, sizeof(accept), &accept_len, sha1, sizeof(sha1)) != 0) {
+            return -1;
+        }
+        s_link.response_len = snprintf(s_link.response, sizeof(s_link.response),
+                                       "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                                       "Sec-WebSocket-Accept: %.*s\r\n\r\n", (int)accept_len, accept);
+        return len;
+    }
+    s_link.writes++;
+    return s_link.broken ? -1 : len;
+}
+
+static int test_link_poll_read(esp_transport_handle_t t, int timeout_ms)
+{
+    if (!s_link.open) {
+        return -1;
+    }
+    if (s_link.response_sent < s_link.response_len) {
+        return 1;
+    }
+    for (int waited = 0; waited < timeout_ms; waited += 10) {
+        if (s_link.read_error) {
+            return -1;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return s_link.read_error ? -1 : 0;
+}
+
+static int test_link_read(esp_transport_handle_t t, char *buffer, int len, int timeout_ms)
+{
+    int ready = test_link_poll_read(t, timeout_ms);
+    if (ready <= 0) {
+        return ready;
+    }
+    int n = s_link.response_len - s_link.response_sent;
+    n = n < len ? n : len;
+    memcpy(buffer, s_link.response + s_link.response_sent, n);
+    s_link.response_sent += n;
+    return n;
+}
+
+static int test_link_poll_write(esp_transport_handle_t t, int timeout_ms)
+{
+    return s_link.open ? 1 : -1;
+}
+
+static int test_link_close(esp_transport_handle_t t)
+{
+    s_link.open = false;
+    s_link.closing = true;
+    vTaskDelay(pdMS_TO_TICKS(s_link.close_delay_ms));
+    return 0;
+}
+
+static void test_link_event(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data)
+{
+    if (event_id == WEBSOCKET_EVENT_DISCONNECTED) {
+        s_disconnected++;
+    }
+}
+
+// A send that fails while the client task is blocked reading: the client task aborts the connection once, and
+// nothing is written to the closed transport afterwards. First with only the write side failing, so the reader
+// finds out from the send; then with the read side failing at the same time, so the two race to abort; then
+// with the read side failing first and the send arriving while the client task is closing the link, past the
+// is-connected check but before tx_lock.
+TEST(websocket, websocket_send_fails_while_reading)
+{
+    for (int scenario = 0; scenario < 3; scenario++) {
+        memset(&s_link, 0, sizeof(s_link));
+        s_disconnected = 0;
+        esp_transport_handle_t link = esp_transport_init();
+        TEST_ASSERT_NOT_NULL(link);
+        esp_transport_set_func(link, test_link_connect, test_link_read, test_link_write, test_link_close,
+                               test_link_poll_read, test_link_poll_write, NULL);
+        esp_transport_handle_t ws = esp_transport_ws_init(link);
+        TEST_ASSERT_NOT_NULL(ws);
+        esp_transport_ws_set_path(ws, "/");
+
+        const esp_websocket_client_config_t websocket_cfg = {
+            .uri = "ws://127.0.0.1",
+            .ext_transport = ws,
+            .disable_auto_reconnect = true,
+        };
+        esp_websocket_client_handle_t client = esp_websocket_client_init(&websocket_cfg);
+        TEST_ASSERT_NOT_EQUAL(NULL, client);
+        TEST_ESP_OK(esp_websocket_register_events(client, WEBSOCKET_EVENT_ANY, test_link_event, NULL));
+        TEST_ESP_OK(esp_websocket_client_start(client));
+        for (int i = 0; i < 100 && !esp_websocket_client_is_connected(client); i++) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+        TEST_ASSERT_TRUE(esp_websocket_client_is_connected(client));
+        vTaskDelay(pdMS_TO_TICKS(50));  // the client task is in the read poll by now
+
+        s_link.broken = true;
+        if (scenario == 2) {
+            s_link.close_delay_ms = 200;
+            s_link.read_error = true;
+            for (int i = 0; i < 200 && !s_link.closing; i++) {
+                vTaskDelay(pdMS_TO_TICKS(10));
+            }
+            TEST_ASSERT_TRUE(s_link.closing);
+        } else {
+            s_link.read_error = scenario == 1;
+        }
+        TEST_ASSERT_EQUAL(-1, esp_websocket_client_send_bin(client, "x", 1, pdMS_TO_TICKS(1000)));
+        for (int i = 0; i < 200 && s_disconnected == 0; i++) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+        vTaskDelay(pdMS_TO_TICKS(300));  // time for a second abort, if there were one
+        TEST_ASSERT_EQUAL(1, s_disconnected);
+        TEST_ASSERT_FALSE(s_link.open);
+        TEST_ASSERT_FALSE(esp_websocket_client_is_connected(client));
+
+        // a send after the abort fails without reaching the transport
+        int writes = s_link.writes;
+        TEST_ASSERT_EQUAL(-1, esp_websocket_client_send_bin(client, "x", 1, pdMS_TO_TICKS(1000)));
+        TEST_ASSERT_EQUAL(writes, s_link.writes);
+        TEST_ASSERT_EQUAL(0, s_link.writes_after_close);
+
+        esp_websocket_client_destroy(client);
+        esp_transport_destroy(ws);
+        esp_transport_destroy(link);
+    }
+    vTaskDelay(pdMS_TO_TICKS(20));  // lets the idle task free the client task before the leak check
+}
+
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+// esp-tls calls are wrapped at link time (see CMakeLists.txt): while `s_tls_fake` is set, a handshake only records
+// the configuration it was given and returns `s_tls_result`, and sessions are plain heap blocks, so neither test
+// needs a network or a server.
+int __real_esp_tls_conn_new_sync(const char *hostname, int hostlen, int port, const esp_tls_cfg_t *cfg, esp_tls_t *tls);
+esp_tls_client_session_t *__real_esp_tls_get_client_session(esp_tls_t *tls);
+void __real_esp_tls_free_client_session(esp_tls_client_session_t *client_session);
+
+static bool s_tls_fake;
+static int s_tls_result;
+static volatile int s_tls_handshakes;
+static esp_tls_cfg_t s_tls_cfg;                         // of the last handshake
+static esp_tls_client_session_t *s_tls_next_session;    // what the next close exports
+static int s_tls_sessions_freed;
+
+int __wrap_esp_tls_conn_new_sync(const char *hostname, int hostlen, int port, const esp_tls_cfg_t *cfg, esp_tls_t *tls)
+{
+    if (!s_tls_fake) {
+        return __real_esp_tls_conn_new_sync(hostname, hostlen, port, cfg, tls);
+    }
+    s_tls_cfg = *cfg;
+    s_tls_handshakes++;
+    return s_tls_result;
+}
+
+esp_tls_client_session_t *__wrap_esp_tls_get_client_session(esp_tls_t *tls)
+{
+    if (!s_tls_fake) {
+        return __real_esp_tls_get_client_session(tls);
+    }
+    esp_tls_client_session_t *session = s_tls_next_session;
+    s_tls_next_session = NULL;
+    return session;
+}
+
+void __wrap_esp_tls_free_client_session(esp_tls_client_session_t *client_session)
+{
+    if (!s_tls_fake) {
+        __real_esp_tls_free_client_session(client_session);
+        return;
+    }
+    s_tls_sessions_freed++;
+    free(client_session);
+}
+
+// The configuration the client's first handshake asks esp-tls for, with or without session resumption
+static void tls_cfg_of(esp_websocket_client_config_t websocket_cfg, bool resumption, esp_tls_cfg_t *tls_cfg)
+{
+    websocket_cfg.uri = "wss://127.0.0.1";
+    websocket_cfg.disable_auto_reconnect = true;
+    websocket_cfg.tls_session_resumption = resumption;
+    s_tls_handshakes = 0;
+    s_tls_result = -1;
+    esp_websocket_client_handle_t client = esp_websocket_client_init(&websocket_cfg);
+    TEST_ASSERT_NOT_EQUAL(NULL, client);
+    TEST_ESP_OK(esp_websocket_client_start(client));
+    for (int i = 0; i < 200 && s_tls_handshakes == 0; i++) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    TEST_ASSERT_EQUAL(1, s_tls_handshakes);
+    esp_websocket_client_destroy(client);
+    *tls_cfg = s_tls_cfg;
+}
+
+// The resumable transport verifies the server the same way esp_transport_ssl does
+TEST(websocket, websocket_tls_config_mapping)
+{
+    static const char ca_pem[] = "-----BEGIN CERTIFICATE-----\nnot parsed here\n-----END CERTIFICATE-----\n";
+    static const char ca_der[] = { 0x30, 0x82, 0x01, 0x0a, 0x02, 0x82 };
+    const esp_websocket_client_config_t configs[] = {
+        { .crt_bundle_attach = esp_crt_bundle_attach },
+        { .cert_pem = ca_pem },
+        { .cert_pem = ca_pem, .cert_common_name = "server.example" },
+        { .cert_pem = ca_der, .cert_len = sizeof(ca_der), .skip_cert_common_name_check = true },
+        { .use_global_ca_store = true, .cert_pem = ca_pem },
+    };
+    s_tls_fake = true;
+    for (int i = 0; i < sizeof(configs) / sizeof(configs[0]); i++) {
+        esp_tls_cfg_t ssl;
+        esp_tls_cfg_t resumable;
+        tls_cfg_of(configs[i], false, &ssl);
+        tls_cfg_of(configs[i], true, &resumable);
+        TEST_ASSERT_TRUE(ssl.crt_bundle_attach == configs[i].crt_bundle_attach);
+        TEST_ASSERT_TRUE(ssl.crt_bundle_attach == resumable.crt_bundle_attach);
+        TEST_ASSERT_EQUAL(ssl.use_global_ca_store, resumable.use_global_ca_store);
+        TEST_ASSERT_EQUAL_PTR(ssl.cacert_buf, resumable.cacert_buf);
+        TEST_ASSERT_EQUAL(ssl.cacert_bytes, resumable.cacert_bytes);
+        TEST_ASSERT_EQUAL(ssl.skip_common_name, resumable.skip_common_name);
+        TEST_ASSERT_EQUAL(ssl.common_name == NULL, resumable.common_name == NULL);
+        if (ssl.common_name) {
+            TEST_ASSERT_EQUAL_STRING(ssl.common_name, resumable.common_name);
+        }
+        TEST_ASSERT_NULL(resumable.client_session);
+    }
+    s_tls_fake = false;
+    vTaskDelay(pdMS_TO_TICKS(20));  // lets the idle task free the client tasks before the leak check
+}
+
+// A closed connection's session is offered in the next handshake, and dropped once a handshake fails
+TEST(websocket, websocket_tls_session_drop)
+{
+    const esp_tls_cfg_t cfg = { 0 };
+    esp_transport_handle_t tls = esp_websocket_tls_init(&cfg);
+    TEST_ASSERT_NOT_NULL(tls);
+    s_tls_fake = true;
+    s_tls_sessions_freed = 0;
+    s_tls_result = 1;
+
+    // the first connection has nothing to resume, and leaves a session behind
+    TEST_ASSERT_EQUAL(0, esp_transport_connect(tls, "127.0.0.1", 443, 1000));
+    TEST_ASSERT_NULL(s_tls_cfg.client_session);
+    esp_tls_client_session_t *first = malloc(16);
+    s_tls_next_session = first;
+    esp_transport_close(tls);
+
+    // offered on reconnect; a newer one replaces it at close
+    TEST_ASSERT_EQUAL(0, esp_transport_connect(tls, "127.0.0.1", 443, 1000));
+    TEST_ASSERT_EQUAL_PTR(first, s_tls_cfg.client_session);
+    esp_tls_client_session_t *second = malloc(16);
+    s_tls_next_session = second;
+    esp_transport_close(tls);
+    TEST_ASSERT_EQUAL(1, s_tls_sessions_freed);
+
+    // a failed handshake drops the session it offered, and the next one starts from scratch
+    s_tls_result = -1;
+    TEST_ASSERT_EQUAL(-1, esp_transport_connect(tls, "127.0.0.1", 443, 1000));
+    TEST_ASSERT_EQUAL_PTR(second, s_tls_cfg.client_session);
+    TEST_ASSERT_EQUAL(2, s_tls_sessions_freed);
+    s_tls_result = 1;
+    TEST_ASSERT_EQUAL(0, esp_transport_connect(tls, "127.0.0.1", 443, 1000));
+    TEST_ASSERT_NULL(s_tls_cfg.client_session);
+    esp_transport_close(tls);
+
+    esp_transport_destroy(tls);
+    TEST_ASSERT_EQUAL(2, s_tls_sessions_freed);
+    s_tls_fake = false;
+}
+#endif
+
+static void copy_mask_reference(uint8_t *dst, const uint8_t *src, size_t len, const uint8_t *mask, size_t offset)
+{
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = src[i] ^ mask[(offset + i) % 4];
+    }
+}
+
+TEST(websocket, websocket_copy_mask)
+{
+    static const uint8_t mask[4] = { 0xa1, 0x02, 0x7f, 0xe4 };
+    static uint8_t src[80];
+    static uint8_t dst[88];
+    static uint8_t expected[88];
+    for (int i = 0; i < sizeof(src); i++) {
+        src[i] = (uint8_t)(i * 37 + 11);
+    }
+    // every combination of source/destination alignment, mask phase and head/body/tail split
+    for (int src_align = 0; src_align < 4; src_align++) {
+        for (int dst_align = 0; dst_align < 4; dst_align++) {
+            for (int offset = 0; offset < 4; offset++) {
+                for (int len = 0; len <= 72; len++) {
+                    memset(dst, 0x55, sizeof(dst));
+                    memset(expected, 0x55, sizeof(expected));
+                    copy_mask_reference(expected + dst_align, src + src_align, len, mask, offset);
+                    esp_websocket_client_copy_mask(dst + dst_align, src + src_align, len, mask, offset);
+                    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, dst, sizeof(dst));
+                }
+            }
+        }
+    }
+    // in place, applied twice restores the data
+    memcpy(dst, src, sizeof(src));
+    esp_websocket_client_copy_mask(dst + 1, dst + 1, 70, mask, 3);
+    esp_websocket_client_copy_mask(dst + 1, dst + 1, 70, mask, 3);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(src, dst, sizeof(src));
+}
+
+// Informational only: one pass per size is at the mercy of interrupts and cache misses, so the
+// counts are printed for comparison and nothing is asserted on them.
+TEST(websocket, websocket_copy_mask_cycles)
+{
+    static const uint8_t mask[4] = { 0xa1, 0x02, 0x7f, 0xe4 };
+    static const size_t sizes[] = { 1024, 4096, 16384 };
+    static uint8_t src[16384 + 1];
+    static uint8_t dst[16384];
+
+    for (int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        size_t len = sizes[i];
+        memcpy(dst, src, len);  // warm up the caches
+        // what staging a frame cost before: memcpy, then the transport masks byte by byte
+        uint32_t start = esp_cpu_get_cycle_count();
+        memcpy(dst, src, len);
+        copy_mask_reference(dst, dst, len, mask, 0);
+        uint32_t separate = esp_cpu_get_cycle_count() - start;
+
+        start = esp_cpu_get_cycle_count();
+        esp_websocket_client_copy_mask(dst, src, len, mask, 0);
+        uint32_t fused = esp_cpu_get_cycle_count() - start;
+
+        start = esp_cpu_get_cycle_count();
+        esp_websocket_client_copy_mask(dst, src + 1, len, mask, 0);
+        uint32_t fused_unaligned = esp_cpu_get_cycle_count() - start;
+
+        printf("copy+mask %5u B: memcpy+mask %7" PRIu32 " cycles, fused %7" PRIu32 " cycles, fused (unaligned src) %7" PRIu32 " cycles\n",
+               (unsigned)len, separate, fused, fused_unaligned);
+    }
+}
+
+TEST_GROUP_RUNNER(websocket)
+{
+    RUN_TEST_CASE(websocket, websocket_init_deinit)
+    RUN_TEST_CASE(websocket, websocket_init_invalid_url)
+    RUN_TEST_CASE(websocket, websocket_set_invalid_url)
+    RUN_TEST_CASE(websocket, websocket_register_callback)
+    RUN_TEST_CASE(websocket, websocket_coalesce_config)
+    RUN_TEST_CASE(websocket, websocket_send_fails_while_reading)
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    RUN_TEST_CASE(websocket, websocket_tls_config_mapping)
+    RUN_TEST_CASE(websocket, websocket_tls_session_drop)
+#endif
+    RUN_TEST_CASE(websocket, websocket_copy_mask)
+    RUN_TEST_CASE(websocket, websocket_copy_mask_cycles)
+}
+
+void app_main(void)
+{
+    UNITY_MAIN(websocket);
+}
@@ -0,0 +1,124 @@
+#include "adpcm.h"
+
+static const int8_t index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8,
+};
+
+static const int16_t step_table[89] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,
+    19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+    130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+    337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+    876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+    2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+    5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+};
+
+static inline int clamp16(int v) {
+    if (v > 32767) {
+        return 32767;
+    }
+    if (v < -32768) {
+        return -32768;
+    }
+    return v;
+}
+
+static inline int next_index(int index, uint8_t code) {
+    index += index_table[code];
+    if (index < 0) {
+        return 0;
+    }
+    if (index > 88) {
+        return 88;
+    }
+    return index;
+}
+
+static inline uint8_t encode_sample(int *predictor, int *index, int sample) {
+    int step = step_table[*index];
+    int diff = sample - *predictor;
+    uint8_t code = 0;
+
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+
+    // Mesma aproximação do decodificador, para os dois lados seguirem o
+    // mesmo preditor.
+    int vpdiff = step >> 3;
+    if (diff >= step) {
+        code |= 4;
+        diff -= step;
+        vpdiff += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        code |= 2;
+        diff -= step;
+        vpdiff += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        code |= 1;
+        vpdiff += step;
+    }
+
+    *predictor = clamp16((code & 8) ? *predictor - vpdiff : *predictor + vpdiff);
+    *index = next_index(*index, code);
+    return code;
+}
+
+static inline int16_t decode_sample(int *predictor, int *index, uint8_t code) {
+    int step = step_table[*index];
+    int vpdiff = step >> 3;
+    if (code & 4) {
+        vpdiff += step;
+    }
+    if (code & 2) {
+        vpdiff += step >> 1;
+    }
+    if (code & 1) {
+        vpdiff += step >> 2;
+    }
+
+    *predictor = clamp16((code & 8) ? *predictor - vpdiff : *predictor + vpdiff);
+    *index = next_index(*index, code);
+    return (int16_t)*predictor;
+}
+
+void adpcm_encode(adpcm_state_t *state, const int16_t *in, size_t n,
+                  uint8_t *out) {
+    int predictor = state->predictor;
+    int index = state->index;
+
+    for (size_t i = 0; i + 1 < n; i += 2) {
+        uint8_t lo = encode_sample(&predictor, &index, in[i]);
+        uint8_t hi = encode_sample(&predictor, &index, in[i + 1]);
+        *out++ = (uint8_t)(lo | (hi << 4));
+    }
+    if (n & 1) {
+        *out = encode_sample(&predictor, &index, in[n - 1]);
+    }
+
+    state->predictor = (int16_t)predictor;
+    state->index = (uint8_t)index;
+}
+
+void adpcm_decode(adpcm_state_t *state, const uint8_t *in, size_t n,
+                  int16_t *out) {
+    int predictor = state->predictor;
+    int index = state->index;
+
+    for (size_t i = 0; i < n; i++) {
+        uint8_t byte = in[i / 2];
+        uint8_t code = (i & 1) ? (byte >> 4) : (byte & 0x0F);
+        out[i] = decode_sample(&predictor, &index, code);
+    }
+
+    state->predictor = (int16_t)predictor;
+    state->index = (uint8_t)index;
+}
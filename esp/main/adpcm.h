@@ -0,0 +1,25 @@
+#pragma once
+#include <stddef.h>  // para size_t
+#include <stdint.h>
+
+/*
+ * Codec IMA-ADPCM (4 bits por amostra, 4:1 sobre PCM de 16 bits).
+ *
+ * Cada bloco é independente: o estado inicial vai junto com os códigos, então
+ * perder um pacote não corrompe os seguintes. Sem dependência do ESP-IDF.
+ */
+
+typedef struct {
+    int16_t predictor;
+    uint8_t index;
+} adpcm_state_t;
+
+// Bytes ocupados pelos códigos de `n` amostras (duas por byte).
+#define ADPCM_CODE_BYTES(n) (((n) + 1) / 2)
+
+// Codifica `n` amostras em `out` (ADPCM_CODE_BYTES(n) bytes). A amostra par
+// vai no nibble baixo. `state` é atualizado.
+void adpcm_encode(adpcm_state_t *state, const int16_t *in, size_t n,
+                  uint8_t *out);
+void adpcm_decode(adpcm_state_t *state, const uint8_t *in, size_t n,
+                  int16_t *out);
@@ -0,0 +1,80 @@
+#include "audio_codec.h"
+
+#include <string.h>
+
+#include "adpcm.h"
+#include "rice_codec.h"
+
+// As amostras do ADC são de 12 bits sem sinal; o ADPCM trabalha melhor com
+// PCM de 16 bits centrado em zero.
+#define ADC_MIDPOINT 2048
+#define ADC_TO_PCM(s) ((int16_t)(((s) - ADC_MIDPOINT) * 16))
+
+// O estado segue de um bloco para o outro (sem partida a frio), mas cada
+// bloco leva o estado inicial e pode ser decodificado sozinho.
+static adpcm_state_t adpcm_state;
+
+static size_t encode_adpcm(const SensorPacket *packet, uint8_t *out) {
+    uint16_t n = packet->header.sample_count;
+    int16_t pcm[NOISE_SAMPLES_PER_PACKET];
+    for (uint16_t i = 0; i < n; i++) {
+        pcm[i] = ADC_TO_PCM(packet->samples[i]);
+    }
+
+    AdpcmBlockHeader block = {
+        .predictor = adpcm_state.predictor,
+        .index = adpcm_state.index,
+    };
+    memcpy(out, &block, sizeof(block));
+    adpcm_encode(&adpcm_state, pcm, n, out + sizeof(block));
+    return sizeof(block) + ADPCM_CODE_BYTES(n);
+}
+
+// Retorna 0 quando o bloco não comprime; o chamador cai para o cru.
+static size_t encode_rice(const SensorPacket *packet, uint8_t *out) {
+    size_t raw_len = packet->header.sample_count * sizeof(int16_t);
+    return rice_encode(sensor_packet_samples((SensorPacket *)packet),
+                       packet->header.sample_count, out, raw_len - 1);
+}
+
+void audio_decimate2(SensorPacket *packet) {
+    int16_t *x = sensor_packet_samples(packet);
+    uint16_t n = packet->header.sample_count;
+    // x[i] só é escrito depois de lido (2i - 1 >= i para i >= 1).
+    for (uint16_t i = 0; 2 * i < n; i++) {
+        int32_t prev = x[i ? 2 * i - 1 : 0];
+        int32_t next = x[2 * i + 1 < n ? 2 * i + 1 : 2 * i];
+        x[i] = (int16_t)((prev + 2 * x[2 * i] + next + 2) >> 2);
+    }
+    packet->header.sample_count = (uint16_t)((n + 1) / 2);
+    packet->header.sample_rate_hz /= 2;
+}
+
+size_t audio_codec_encode(const SensorPacket *packet, uint8_t codec,
+                          uint8_t *out) {
+    SensorPacketHeader *header = (SensorPacketHeader *)out;
+    uint8_t *payload = out + sizeof(SensorPacketHeader);
+    size_t payload_len = 0;
+
+    memcpy(header, &packet->header, sizeof(*header));
+
+    switch (codec) {
+        case SENSOR_CODEC_ADPCM:
+            payload_len = encode_adpcm(packet, payload);
+            break;
+        case SENSOR_CODEC_RICE:
+            payload_len = encode_rice(packet, payload);
+            break;
+        default:
+            break;
+    }
+
+    if (payload_len == 0) {
+        codec = SENSOR_CODEC_RAW;
+        payload_len = packet->header.sample_count * sizeof(int16_t);
+        memcpy(payload, packet->samples, payload_len);
+    }
+
+    header->flags = (header->flags & ~SENSOR_PACKET_CODEC_MASK) | codec;
+    return sizeof(SensorPacketHeader) + payload_len;
+}
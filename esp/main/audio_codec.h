@@ -0,0 +1,30 @@
+#pragma once
+#include <stddef.h>  // para size_t
+#include <stdint.h>
+
+#include "sensor_manager.h"
+
+/*
+ * Codificação dos pacotes de áudio antes do envio. O codec usado vai nos
+ * bits SENSOR_PACKET_CODEC_MASK de header.flags e o servidor decodifica
+ * conforme ele.
+ */
+
+// Nenhum codec gera mais bytes que o pacote cru.
+#define AUDIO_CODEC_MAX_BYTES sizeof(SensorPacket)
+
+// Payload ADPCM: estado inicial do codificador seguido dos códigos.
+typedef struct {
+    int16_t predictor;
+    uint8_t index;
+    uint8_t reserved;
+} __attribute__((packed)) AdpcmBlockHeader;
+
+// Reduz o bloco para a metade da taxa, no lugar: passa-baixas [1 2 1]/4 e
+// descarta uma amostra em cada duas. Atualiza sample_count e sample_rate_hz.
+void audio_decimate2(SensorPacket *packet);
+
+// Codifica `packet` com `codec` em `out` (pelo menos AUDIO_CODEC_MAX_BYTES)
+// e retorna o tamanho final, cabeçalho incluído.
+size_t audio_codec_encode(const SensorPacket *packet, uint8_t codec,
+                          uint8_t *out);
@@ -0,0 +1,128 @@
+#include "audio_features.h"
+
+#include <math.h>
+#include <string.h>
+
+#define MAX_BAND_BINS 4
+
+// Frequências (Hz) somadas em cada banda. Ronco concentra energia abaixo de
+// 500 Hz; fala entre 300 Hz e 3,4 kHz.
+static const uint16_t band_freqs[AUDIO_FEATURE_BANDS][MAX_BAND_BINS] = {
+    {100, 150, 200, 250},    // ronco grave
+    {300, 400, 500, 0},      // ronco
+    {800, 1200, 1600, 2000}, // fala
+    {2500, 3000, 3500, 0},   // agudos
+};
+
+static int32_t band_coeffs[AUDIO_FEATURE_BANDS][MAX_BAND_BINS];
+
+void audio_features_init(uint32_t sample_rate_hz) {
+    for (int b = 0; b < AUDIO_FEATURE_BANDS; b++) {
+        for (int i = 0; i < MAX_BAND_BINS; i++) {
+            float w = 2.0f * (float)M_PI * band_freqs[b][i] / sample_rate_hz;
+            // 2*cos(w) em Q14; 0 marca posição vazia da tabela
+            band_coeffs[b][i] =
+                band_freqs[b][i] ? (int32_t)lrintf(2.0f * cosf(w) * 16384) : 0;
+        }
+    }
+}
+
+void audio_features_reset(audio_features_acc_t *acc) {
+    memset(acc, 0, sizeof(*acc));
+}
+
+uint64_t audio_goertzel_power(const int32_t *x, size_t n, int32_t coeff_q14) {
+    int64_t s1 = 0, s2 = 0;
+    for (size_t i = 0; i < n; i++) {
+        int64_t s0 = x[i] + ((coeff_q14 * s1) >> 14) - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    // |X|^2 = s1^2 + s2^2 - 2cos(w)*s1*s2. Para um tom de amplitude A no bin,
+    // |X| = A*n/2; devolve A^2 para não depender do tamanho do bloco.
+    int64_t power = s1 * s1 + s2 * s2 - ((coeff_q14 * s1) >> 14) * s2;
+    if (power <= 0) {
+        return 0;
+    }
+    return ((uint64_t)power * 4) / ((uint64_t)n * n);
+}
+
+int16_t audio_power_to_db10(uint64_t power) {
+    if (power <= 1) {
+        return 0;
+    }
+    // log2 em Q8: posição do bit mais alto mais 8 bits de fração linear.
+    int msb = 63 - __builtin_clzll(power);
+    uint32_t frac = (uint32_t)((power << (63 - msb)) >> 55) & 0xFF;
+    uint32_t log2_q8 = ((uint32_t)msb << 8) | frac;
+    // 10*log10(p) em décimos de dB = log2(p) * 100*log10(2)
+    return (int16_t)((log2_q8 * 30103u) / 256000u);
+}
+
+void audio_features_add_block(audio_features_acc_t *acc,
+                              const int16_t *samples, size_t n) {
+    if (n == 0 || n > NOISE_SAMPLES_PER_PACKET) {
+        return;
+    }
+
+    // Remove o nível DC do bloco (o microfone fica em torno de meia escala).
+    int32_t sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += samples[i];
+    }
+    int32_t mean = sum / (int32_t)n;
+
+    int32_t x[NOISE_SAMPLES_PER_PACKET];
+    for (size_t i = 0; i < n; i++) {
+        int32_t v = samples[i] - mean;
+        x[i] = v;
+        acc->sum_sq += (uint64_t)((int64_t)v * v);
+        uint16_t mag = (uint16_t)(v < 0 ? -v : v);
+        if (mag > acc->peak) {
+            acc->peak = mag;
+        }
+        if (i > 0 && ((x[i - 1] < 0) != (v < 0))) {
+            acc->crossings++;
+        }
+    }
+    acc->samples += n;
+
+    for (int b = 0; b < AUDIO_FEATURE_BANDS; b++) {
+        for (int i = 0; i < MAX_BAND_BINS && band_coeffs[b][i]; i++) {
+            acc->band_power[b] += audio_goertzel_power(x, n, band_coeffs[b][i]);
+        }
+    }
+    acc->blocks++;
+}
+
+uint32_t audio_isqrt64(uint64_t v) {
+    uint64_t r = 0, bit = 1ull << 62;
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)r;
+}
+
+void audio_features_finish(const audio_features_acc_t *acc,
+                           uint32_t sample_rate_hz, AudioFeatures *out) {
+    memset(out, 0, sizeof(*out));
+    if (acc->samples == 0) {
+        return;
+    }
+    out->rms = (uint16_t)audio_isqrt64(acc->sum_sq / acc->samples);
+    out->peak = acc->peak;
+    out->zcr = (uint16_t)((uint64_t)acc->crossings * sample_rate_hz /
+                          acc->samples);
+    for (int b = 0; b < AUDIO_FEATURE_BANDS; b++) {
+        out->band_db10[b] = audio_power_to_db10(acc->band_power[b] / acc->blocks);
+    }
+}
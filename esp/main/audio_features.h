@@ -0,0 +1,50 @@
+#pragma once
+#include <stddef.h>  // para size_t
+#include <stdint.h>
+
+#include "sensor_manager.h"
+
+/*
+ * Características acústicas por janela, calculadas no ESP32 para não enviar
+ * as amostras: RMS, pico, taxa de cruzamentos por zero e energia em bandas
+ * (ronco e fala) via filtros de Goertzel em ponto fixo. Sem dependência do
+ * ESP-IDF.
+ */
+
+#define AUDIO_FEATURE_BANDS 4
+
+// Payload de um pacote SENSOR_PACKET_TYPE_FEATURES.
+typedef struct {
+    uint16_t rms;        // em LSB do ADC, sem o nível DC
+    uint16_t peak;       // maior desvio absoluto do nível DC
+    uint16_t zcr;        // cruzamentos por zero por segundo
+    int16_t band_db10[AUDIO_FEATURE_BANDS];  // energia em décimos de dB
+} __attribute__((packed)) AudioFeatures;
+
+typedef struct {
+    SensorPacketHeader header;
+    AudioFeatures features;
+} __attribute__((packed)) SensorFeaturePacket;
+
+typedef struct {
+    uint64_t sum_sq;
+    uint32_t samples;
+    uint32_t crossings;
+    uint16_t peak;
+    uint64_t band_power[AUDIO_FEATURE_BANDS];
+    uint32_t blocks;
+} audio_features_acc_t;
+
+// Calcula os coeficientes de Goertzel para a taxa de amostragem.
+void audio_features_init(uint32_t sample_rate_hz);
+void audio_features_reset(audio_features_acc_t *acc);
+// Acumula um bloco de amostras cruas do ADC.
+void audio_features_add_block(audio_features_acc_t *acc,
+                              const int16_t *samples, size_t n);
+void audio_features_finish(const audio_features_acc_t *acc,
+                           uint32_t sample_rate_hz, AudioFeatures *out);
+
+// Kernels expostos para testes e benchmarks.
+uint64_t audio_goertzel_power(const int32_t *x, size_t n, int32_t coeff_q14);
+int16_t audio_power_to_db10(uint64_t power);
+uint32_t audio_isqrt64(uint64_t v);
@@ -0,0 +1,96 @@
+#include "dht_decode.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#else
+#define IRAM_ATTR
+#endif
+
+// Alto mais longo que isso é bit 1 (0 ~27 us, 1 ~70 us).
+#define BIT_ONE_MIN_US 48
+#define BIT_HIGH_MAX_US 110
+#define BIT_LOW_MIN_US 20
+#define BIT_LOW_MAX_US 120
+
+// Roda no callback do RMT.
+dht_decode_result_t IRAM_ATTR dht_decode(const dht_pulse_t *pulses, size_t n,
+                                         uint8_t data[DHT_DATA_BYTES]) {
+    // Os bits são os 40 últimos altos da captura, cada um precedido de um
+    // baixo. Percorre de trás para frente juntando níveis repetidos; um alto
+    // final longo é repouso da linha e não conta.
+    uint16_t highs[DHT_DATA_BITS];
+    int found = 0;
+    uint32_t run = 0;
+    int run_level = -1;
+    bool after_low = false;  // já passou por um baixo vindo do fim
+    uint16_t pending_high = 0;
+    bool have_high = false;
+
+    for (size_t i = n; i-- > 0 && found < DHT_DATA_BITS;) {
+        if (pulses[i].duration_us == 0) {
+            continue;
+        }
+        int level = pulses[i].level ? 1 : 0;
+        if (level == run_level) {
+            run += pulses[i].duration_us;
+            continue;
+        }
+        // Fecha o trecho anterior (mais à direita).
+        if (run_level == 1 && (after_low || run <= BIT_HIGH_MAX_US)) {
+            pending_high = run > UINT16_MAX ? UINT16_MAX : (uint16_t)run;
+            have_high = true;
+        } else if (run_level == 0) {
+            if (have_high) {
+                if (run < BIT_LOW_MIN_US || run > BIT_LOW_MAX_US) {
+                    return DHT_DECODE_TIMING;
+                }
+                highs[DHT_DATA_BITS - 1 - found++] = pending_high;
+                have_high = false;
+            }
+            after_low = true;
+        }
+        run_level = level;
+        run = pulses[i].duration_us;
+    }
+    // O último trecho (o mais à esquerda) ainda está aberto.
+    if (found < DHT_DATA_BITS && run_level == 0 && have_high &&
+        run >= BIT_LOW_MIN_US) {
+        highs[DHT_DATA_BITS - 1 - found++] = pending_high;
+    }
+    if (found < DHT_DATA_BITS) {
+        return DHT_DECODE_TOO_SHORT;
+    }
+
+    for (int i = 0; i < DHT_DATA_BYTES; i++) {
+        data[i] = 0;
+    }
+    for (int i = 0; i < DHT_DATA_BITS; i++) {
+        if (highs[i] > BIT_HIGH_MAX_US) {
+            return DHT_DECODE_TIMING;
+        }
+        if (highs[i] >= BIT_ONE_MIN_US) {
+            data[i / 8] |= (uint8_t)(0x80 >> (i % 8));
+        }
+    }
+
+    uint8_t sum = (uint8_t)(data[0] + data[1] + data[2] + data[3]);
+    return sum == data[4] ? DHT_DECODE_OK : DHT_DECODE_CHECKSUM;
+}
+
+static int16_t convert(bool dht11, uint8_t msb, uint8_t lsb) {
+    if (dht11) {
+        return (int16_t)(msb * 10 + lsb);
+    }
+    int16_t value = (int16_t)(((msb & 0x7F) << 8) | lsb);
+    return (msb & 0x80) ? -value : value;
+}
+
+void dht_decode_values(const uint8_t data[DHT_DATA_BYTES], bool dht11,
+                       int16_t *humidity, int16_t *temperature) {
+    if (humidity) {
+        *humidity = convert(dht11, data[0], data[1]);
+    }
+    if (temperature) {
+        *temperature = convert(dht11, data[2], data[3]);
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>  // para size_t
+#include <stdint.h>
+
+/*
+ * Decodificador do trem de pulsos do DHT11/DHT22.
+ *
+ * Recebe os níveis e durações capturados na linha (pelo RMT no ESP32 ou de
+ * uma gravação no host) e devolve os 5 bytes do sensor. Cada bit é um nível
+ * baixo de ~50 us seguido de um alto de ~27 us (0) ou ~70 us (1). Sem
+ * dependência do ESP-IDF.
+ */
+
+#define DHT_DATA_BYTES 5
+#define DHT_DATA_BITS (DHT_DATA_BYTES * 8)
+
+typedef struct {
+    uint16_t duration_us;
+    uint8_t level;
+} dht_pulse_t;
+
+typedef enum {
+    DHT_DECODE_OK,
+    DHT_DECODE_TOO_SHORT,  // menos de 40 bits na captura
+    DHT_DECODE_TIMING,     // pulso fora da janela do protocolo
+    DHT_DECODE_CHECKSUM,
+} dht_decode_result_t;
+
+// Pulsos de duração 0 são ignorados e níveis repetidos são somados, então
+// a captura pode começar antes da resposta do sensor.
+dht_decode_result_t dht_decode(const dht_pulse_t *pulses, size_t n,
+                               uint8_t data[DHT_DATA_BYTES]);
+
+// Converte os bytes em décimos de %UR e de °C.
+void dht_decode_values(const uint8_t data[DHT_DATA_BYTES], bool dht11,
+                       int16_t *humidity, int16_t *temperature);
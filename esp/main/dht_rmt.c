@@ -0,0 +1,119 @@
+#include "dht_rmt.h"
+
+#include "dht_decode.h"
+#include "driver/gpio.h"
+#include "driver/rmt_rx.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#define DHT_RMT_RESOLUTION_HZ 1000000  // 1 tick = 1 us
+#define DHT_RMT_SYMBOLS 64             // 43 símbolos por leitura
+#define DHT_START_LOW_MS 20            // DHT11 pede pelo menos 18 ms
+#define DHT_READ_TIMEOUT_MS 50
+
+static const char *TAG = "dht_rmt";
+
+typedef struct {
+    dht_decode_result_t result;
+    uint8_t data[DHT_DATA_BYTES];
+} dht_rmt_result_t;
+
+static rmt_channel_handle_t rx_channel;
+static rmt_symbol_word_t rx_symbols[DHT_RMT_SYMBOLS];
+static dht_pulse_t rx_pulses[DHT_RMT_SYMBOLS * 2];
+static QueueHandle_t result_queue;
+static gpio_num_t dht_pin;
+static bool dht_is_dht11;
+
+static bool IRAM_ATTR on_recv_done(rmt_channel_handle_t channel,
+                                   const rmt_rx_done_event_data_t *edata,
+                                   void *user_data) {
+    size_t n = 0;
+    for (size_t i = 0; i < edata->num_symbols; i++) {
+        const rmt_symbol_word_t *s = &edata->received_symbols[i];
+        rx_pulses[n++] = (dht_pulse_t){s->duration0, s->level0};
+        rx_pulses[n++] = (dht_pulse_t){s->duration1, s->level1};
+    }
+
+    dht_rmt_result_t out;
+    out.result = dht_decode(rx_pulses, n, out.data);
+
+    BaseType_t woken = pdFALSE;
+    xQueueOverwriteFromISR(result_queue, &out, &woken);
+    return woken == pdTRUE;
+}
+
+esp_err_t dht_rmt_init(int gpio_num, bool dht11) {
+    dht_pin = (gpio_num_t)gpio_num;
+    dht_is_dht11 = dht11;
+
+    result_queue = xQueueCreate(1, sizeof(dht_rmt_result_t));
+    if (result_queue == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    rmt_rx_channel_config_t config = {
+        .gpio_num = dht_pin,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = DHT_RMT_RESOLUTION_HZ,
+        .mem_block_symbols = DHT_RMT_SYMBOLS,
+    };
+    ESP_RETURN_ON_ERROR(rmt_new_rx_channel(&config, &rx_channel), TAG,
+                        "rmt_new_rx_channel");
+
+    rmt_rx_event_callbacks_t callbacks = {.on_recv_done = on_recv_done};
+    ESP_RETURN_ON_ERROR(
+        rmt_rx_register_event_callbacks(rx_channel, &callbacks, NULL), TAG,
+        "rmt_rx_register_event_callbacks");
+    ESP_RETURN_ON_ERROR(rmt_enable(rx_channel), TAG, "rmt_enable");
+
+    // O RMT só lê o pino; o pulso de início sai pelo GPIO em dreno aberto.
+    gpio_set_direction(dht_pin, GPIO_MODE_INPUT_OUTPUT_OD);
+    gpio_set_pull_mode(dht_pin, GPIO_PULLUP_ONLY);
+    gpio_set_level(dht_pin, 1);
+    return ESP_OK;
+}
+
+esp_err_t dht_rmt_read(int16_t *humidity, int16_t *temperature) {
+    xQueueReset(result_queue);
+
+    // Pulso de início: a task dorme enquanto a linha fica em baixo.
+    gpio_set_level(dht_pin, 0);
+    vTaskDelay(pdMS_TO_TICKS(DHT_START_LOW_MS) + 1);
+
+    // A recepção começa antes de soltar a linha, já que o sensor responde em
+    // 20-40 us; o decodificador ignora o começo da captura. Ela termina
+    // quando a linha fica parada por mais que signal_range_max_ns.
+    rmt_receive_config_t receive = {
+        .signal_range_min_ns = 1000,    // filtra ruído abaixo de 1 us
+        .signal_range_max_ns = 200000,  // nenhum pulso do DHT passa de 90 us
+    };
+    esp_err_t err =
+        rmt_receive(rx_channel, rx_symbols, sizeof(rx_symbols), &receive);
+    gpio_set_level(dht_pin, 1);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    dht_rmt_result_t result;
+    if (xQueueReceive(result_queue, &result,
+                      pdMS_TO_TICKS(DHT_READ_TIMEOUT_MS)) != pdTRUE) {
+        // Sem bordas a recepção não termina; reinicia o canal.
+        rmt_disable(rx_channel);
+        rmt_enable(rx_channel);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    switch (result.result) {
+        case DHT_DECODE_OK:
+            dht_decode_values(result.data, dht_is_dht11, humidity,
+                              temperature);
+            return ESP_OK;
+        case DHT_DECODE_CHECKSUM:
+            return ESP_ERR_INVALID_CRC;
+        default:
+            return ESP_ERR_INVALID_RESPONSE;
+    }
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+// Leitura do DHT pelo RMT: o periférico captura o trem de pulsos e o
+// callback de fim de recepção o decodifica. Sem seção crítica nem espera
+// ocupada; a task que lê fica bloqueada (sem CPU) por ~25 ms.
+esp_err_t dht_rmt_init(int gpio_num, bool dht11);
+// Valores em décimos de %UR e de °C.
+esp_err_t dht_rmt_read(int16_t *humidity, int16_t *temperature);
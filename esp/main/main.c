@@ -1,37 +1,59 @@
+#include <string.h>
+#include <sys/time.h>
 #include <time.h>
 
+#include "adpcm.h"
+#include "audio_codec.h"
+#include "audio_features.h"
 #include "esp_log.h"
+#include "esp_random.h"
 #include "esp_rom_sys.h"
 #include "esp_sntp.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
 #include "freertos/task.h"
+#include "noise_gate.h"
 #include "nvs_flash.h"
+#include "packet_header.h"
+#include "packet_pool.h"
+#include "sample_timing.h"
+#include "sdkconfig.h"
+#include "sensor_frame.h"
 #include "sensor_manager.h"
+#include "spsc_ring.h"
+#include "telemetry.h"
 #include "websocket_client.h"
 #include "wifi_manager.h"
 
-#define NOISE_QUEUE_LENGTH 10
+#define NOISE_DRAIN_CHUNK 4
+
+#if CONFIG_MIC_CODEC_ADPCM
+#define MIC_CODEC SENSOR_CODEC_ADPCM
+#elif CONFIG_MIC_CODEC_RICE
+#define MIC_CODEC SENSOR_CODEC_RICE
+#else
+#define MIC_CODEC SENSOR_CODEC_RAW
+#endif
+
+#if CONFIG_MIC_RING_DROP_OLDEST
+#define NOISE_RING_POLICY SPSC_RING_DROP_OLDEST
+#else
+#define NOISE_RING_POLICY SPSC_RING_DROP_NEWEST
+#endif
 
 static const char *TAG = "main";
 
+static void time_sync_cb(struct timeval *tv) {
+    ESP_LOGI(TAG, "Tempo sincronizado");
+}
+
+// O SNTP sincroniza em segundo plano quando a rede sobe. Até lá
+// epoch_offset_us() devolve 0 e os pacotes saem só com o relógio monotônico.
 void init_time_sync() {
     esp_sntp_setoperatingmode(SNTP_OPMODE_POLL);
     esp_sntp_setservername(0, "pool.ntp.org");
+    sntp_set_time_sync_notification_cb(time_sync_cb);
     esp_sntp_init();
-
-    time_t now;
-    struct tm timeinfo = {0};
-    int retry = 0;
-    const int max_retries = 10;
-
-    while (timeinfo.tm_year < (2016 - 1900) && ++retry < max_retries) {
-        ESP_LOGI(TAG, "Aguardando sincronização do tempo...");
-        vTaskDelay(pdMS_TO_TICKS(2000));
-        time(&now);
-        localtime_r(&now, &timeinfo);
-    }
 }
 
 /* void sensor_task(void *pvParameters) {
@@ -45,7 +67,26 @@ void init_time_sync() {
     }
 } */
 
-static QueueHandle_t noise_queue;
+// Anel SPSC de ponteiros para buffers do packet_pool: só 4 bytes trafegam
+// por pacote, as amostras ficam onde foram escritas. O amostrador é o único
+// produtor e a send_task a única consumidora.
+static SensorPacket *noise_ring_storage[CONFIG_MIC_RING_CAPACITY];
+static spsc_ring_t noise_ring;
+static TaskHandle_t send_task_handle;
+
+static void IRAM_ATTR noise_ring_push(SensorPacket *block) {
+    SensorPacket *evicted;
+    switch (spsc_ring_push(&noise_ring, &block, &evicted)) {
+        case SPSC_RING_DROPPED:
+            packet_pool_release(block);
+            break;
+        case SPSC_RING_EVICTED:
+            packet_pool_release(evicted);
+            break;
+        default:
+            break;
+    }
+}
 
 // --- Task de coleta de ruído ---
 /* void noise_task(void *pvParameters) {
@@ -75,51 +116,385 @@ respirar) vTaskDelay(pdMS_TO_TICKS(1));
     }
 } */
 
+#if CONFIG_MIC_CAPTURE_CONTINUOUS
+// --- Captura contínua (DMA): o ADC entrega blocos prontos ---
+static void noise_block_ready(SensorPacket *block, void *arg) {
+    noise_ring_push(block);
+    xTaskNotifyGive(send_task_handle);
+}
+
+void noise_capture_task(void *pvParameters) {
+    sensor_manager_run_noise_capture(noise_block_ready, NULL);
+    ESP_LOGE(TAG, "Captura do microfone encerrada");
+    vTaskDelete(NULL);
+}
+
+void start_noise_capture() {
+    xTaskCreatePinnedToCore(noise_capture_task, "Noise Capture",
+                            CONFIG_NOISE_CAPTURE_TASK_STACK, NULL,
+                            CONFIG_NOISE_CAPTURE_TASK_PRIORITY, NULL,
+                            CONFIG_SAMPLER_CORE);
+}
+#else
 static esp_timer_handle_t sample_timer;
-static SensorPacket packet;
+static SensorPacket *packet;
 static int sample_index = 0;
+static uint32_t packet_sequence = 0;
+static int64_t packet_start_us;
 
-void IRAM_ATTR noise_sample_callback(void *arg) {
-    SensorReading reading;
-    read_noise(&reading);  // deve ser leve e rápido!
-    // ESP_LOGI(TAG, "Noise sample: %d", reading.value);
+static inline __attribute__((always_inline)) void take_noise_sample(void) {
+    int sample = read_noise();  // deve ser leve e rápido!
 
-    packet.samples[sample_index++] = (int16_t)reading.value;
+    if (sample_index == 0) {
+        // Um único relógio monotônico por bloco, na primeira amostra.
+        packet_start_us = esp_timer_get_time();
+        if (packet == NULL) {
+            packet = packet_pool_acquire();
+        }
+    }
+    if (packet != NULL) {
+        packet->samples[sample_index] = (int16_t)sample;
+    }
 
-    if (sample_index == NOISE_SAMPLES_PER_PACKET) {
-        ESP_LOGI(TAG, "1o valor: %d", packet.samples[0]);
+    if (++sample_index == NOISE_SAMPLES_PER_PACKET) {
+        uint32_t sequence = packet_sequence++;
+        sample_index = 0;
+        if (packet == NULL) {
+            return;  // pool esgotado: bloco descartado
+        }
 
-        struct timeval tv;
-        gettimeofday(&tv, NULL);
-        packet.timestamp = (tv.tv_sec * 1000) + (tv.tv_usec / 1000);
+        packet_header_fill(&packet->header, SENSOR_PACKET_TYPE_AUDIO,
+                           NOISE_SAMPLES_PER_PACKET, sequence,
+                           packet_start_us);
+        noise_ring_push(packet);
+        packet = NULL;
 
         BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-        xQueueSendFromISR(noise_queue, &packet, &xHigherPriorityTaskWoken);
-        sample_index = 0;
+        vTaskNotifyGiveFromISR(send_task_handle, &xHigherPriorityTaskWoken);
 
         if (xHigherPriorityTaskWoken) {
+#if CONFIG_MIC_TIMER_ISR_DISPATCH
+            esp_timer_isr_dispatch_need_yield();
+#else
             portYIELD_FROM_ISR();
+#endif
         }
     }
 }
 
+void IRAM_ATTR noise_sample_callback(void *arg) {
+#if CONFIG_MIC_TIMING_STATS
+    uint32_t start = sample_timing_begin();
+    take_noise_sample();
+    sample_timing_end(start);
+#else
+    take_noise_sample();
+#endif
+}
+
 void start_noise_timer() {
     const esp_timer_create_args_t sample_timer_args = {
-        .callback = &noise_sample_callback, .name = "noise_sample_timer"};
+        .callback = &noise_sample_callback,
+#if CONFIG_MIC_TIMER_ISR_DISPATCH
+        // Direto na interrupção: o período não depende do agendamento da
+        // task do esp_timer.
+        .dispatch_method = ESP_TIMER_ISR,
+#endif
+        .name = "noise_sample_timer"};
 
     ESP_ERROR_CHECK(esp_timer_create(&sample_timer_args, &sample_timer));
     ESP_ERROR_CHECK(
         esp_timer_start_periodic(sample_timer, 125));  // 125us = 8000Hz
 }
 
-// --- Task que envia pacotes da fila via WebSocket ---
+void start_noise_capture() { start_noise_timer(); }
+#endif
+
+static void log_noise_losses(void) {
+    static uint32_t last_dropped;
+    spsc_ring_stats_t stats;
+    spsc_ring_get_stats(&noise_ring, &stats);
+
+    uint32_t dropped = stats.dropped_newest + stats.dropped_oldest;
+    if (dropped != last_dropped) {
+        ESP_LOGW(TAG,
+                 "Anel cheio: %lu pacotes perdidos (%lu amostras, %lu "
+                 "transbordos no total)",
+                 (unsigned long)(dropped - last_dropped),
+                 (unsigned long)(dropped - last_dropped) *
+                     NOISE_SAMPLES_PER_PACKET,
+                 (unsigned long)stats.overruns);
+        last_dropped = dropped;
+    }
+}
+
+// Diferença entre o relógio UTC e o monotônico. Calculada no envio, nunca no
+// caminho de amostragem; 0 enquanto o NTP não sincronizou.
+static int64_t epoch_offset_us(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    if (tv.tv_sec < 1451606400) {  // antes de 2016: relógio não sincronizado
+        return 0;
+    }
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec - esp_timer_get_time();
+}
+
+// Entrega o buffer do pool à task escritora, que o devolve depois do envio.
+static void send_noise_packet(SensorPacket *packet, uint8_t codec) {
+    if (codec == SENSOR_CODEC_RAW) {
+        websocket_send_audio(packet,
+                             sizeof(SensorPacketHeader) +
+                                 packet->header.sample_count * sizeof(int16_t));
+        return;
+    }
+
+    // O resultado volta para o próprio buffer: nenhum codec cresce o pacote.
+    static uint8_t encoded[AUDIO_CODEC_MAX_BYTES];
+    size_t len = audio_codec_encode(packet, codec, encoded);
+    memcpy(packet, encoded, len);
+    websocket_send_audio(packet, len);
+}
+
+#if CONFIG_MIC_STREAM_FEATURES || CONFIG_MIC_ADAPTIVE_QUALITY
+// Os blocos viram um quadro compacto de características por janela.
+static audio_features_acc_t features_acc;
+static SensorFeaturePacket feature_packet;
+
+static void add_feature_block(SensorPacket *packet) {
+    if (features_acc.blocks == 0) {
+        // A janela herda o tempo e a sequência do primeiro bloco.
+        feature_packet.header = packet->header;
+    }
+    audio_features_add_block(&features_acc, sensor_packet_samples(packet),
+                             packet->header.sample_count);
+
+    if (features_acc.blocks == CONFIG_MIC_FEATURE_WINDOW_BLOCKS) {
+        feature_packet.header.type = SENSOR_PACKET_TYPE_FEATURES;
+        feature_packet.header.flags = SENSOR_CODEC_RAW;
+        feature_packet.header.sample_count = (uint16_t)features_acc.samples;
+        audio_features_finish(&features_acc, NOISE_SAMPLE_RATE_HZ,
+                              &feature_packet.features);
+        audio_features_reset(&features_acc);
+        // O quadro vai no buffer do último bloco, já consumido.
+        memcpy(packet, &feature_packet, sizeof(feature_packet));
+        websocket_send_audio(packet, sizeof(feature_packet));
+        return;
+    }
+    packet_pool_release(packet);
+}
+#endif
+
+#if CONFIG_MIC_STREAM_FEATURES
+static void process_noise_packet(SensorPacket *packet) {
+    add_feature_block(packet);
+}
+#elif CONFIG_MIC_STREAM_GATED
+// Modo com portão: os blocos ficam na pré-gravação (ponteiros do pool) até
+// um evento; entre eventos só sai o heartbeat.
+#define PREROLL_BLOCKS NOISE_BLOCKS_FOR_MS(CONFIG_MIC_GATE_PREROLL_MS)
+#define PREROLL_CAPACITY 64  // potência de 2 >= blocos de 4 s
+
+static noise_gate_t noise_gate;
+static SensorPacket *preroll_storage[PREROLL_CAPACITY];
+static spsc_ring_t preroll_ring;
+static SensorHeartbeatPacket heartbeat_packet;
+static bool heartbeat_started;
+
+static void noise_gate_setup(void) {
+    noise_gate_init(&noise_gate, CONFIG_MIC_GATE_THRESHOLD_DB,
+                    NOISE_BLOCKS_FOR_MS(CONFIG_MIC_GATE_HANGOVER_MS));
+    spsc_ring_init(&preroll_ring, preroll_storage, sizeof(SensorPacket *),
+                   PREROLL_CAPACITY, SPSC_RING_DROP_OLDEST);
+}
+
+static void send_event_block(SensorPacket *packet, bool first) {
+    if (first) {
+        packet->header.flags |= SENSOR_PACKET_FLAG_EVENT_START;
+    }
+    send_noise_packet(packet, MIC_CODEC);
+}
+
+static void send_heartbeat_if_due(const SensorPacket *packet) {
+    if (heartbeat_started &&
+        packet->header.capture_time_us -
+                heartbeat_packet.header.capture_time_us <
+            (uint64_t)CONFIG_MIC_GATE_HEARTBEAT_MS * 1000) {
+        return;
+    }
+    if (heartbeat_started) {
+        heartbeat_packet.header.type = SENSOR_PACKET_TYPE_HEARTBEAT;
+        heartbeat_packet.header.flags = 0;
+        heartbeat_packet.header.sample_count = 0;  // duração em stats.blocks
+        heartbeat_packet.header.epoch_offset_us =
+            packet->header.epoch_offset_us;
+        noise_gate_take_stats(&noise_gate, &heartbeat_packet.stats);
+        websocket_send_stats(&heartbeat_packet, sizeof(heartbeat_packet));
+    }
+    // O próximo intervalo começa neste bloco.
+    heartbeat_packet.header = packet->header;
+    heartbeat_started = true;
+}
+
+static void process_noise_packet(SensorPacket *packet) {
+    send_heartbeat_if_due(packet);
+
+    switch (noise_gate_feed(&noise_gate, sensor_packet_samples(packet),
+                            packet->header.sample_count)) {
+        case NOISE_GATE_IDLE:
+            if (PREROLL_BLOCKS == 0) {
+                packet_pool_release(packet);
+                return;
+            }
+            if (spsc_ring_count(&preroll_ring) >= PREROLL_BLOCKS) {
+                SensorPacket *oldest;
+                spsc_ring_pop(&preroll_ring, &oldest, 1);
+                packet_pool_release(oldest);
+            }
+            spsc_ring_push(&preroll_ring, &packet, NULL);
+            return;
+        case NOISE_GATE_START: {
+            SensorPacket *held;
+            bool first = true;
+            while (spsc_ring_pop(&preroll_ring, &held, 1) == 1) {
+                send_event_block(held, first);
+                first = false;
+            }
+            send_event_block(packet, first);
+            return;
+        }
+        case NOISE_GATE_ACTIVE:
+        case NOISE_GATE_END:
+            send_event_block(packet, false);
+            return;
+    }
+}
+#elif CONFIG_MIC_ADAPTIVE_QUALITY
+// Áudio com qualidade adaptativa: a escritora mede o enlace e escolhe o
+// nível; cada bloco sai com ele em header.quality.
+#define BLOCKS_PER_S (NOISE_SAMPLE_RATE_HZ / NOISE_SAMPLES_PER_PACKET)
+#define FRAME_OVERHEAD (sizeof(SensorFrameHeader) + sizeof(SensorRecordHeader))
+#define ADPCM_PACKET_BYTES(n)                                        \
+    (sizeof(SensorPacketHeader) + sizeof(AdpcmBlockHeader) + \
+     ADPCM_CODE_BYTES(n))
+#define RAW_PACKET_BYTES(n) (sizeof(SensorPacketHeader) + (n) * sizeof(int16_t))
+
+static quality_level_t current_quality;
+
+static void quality_setup(void) {
+    // Rice não tem tamanho fixo: conta como cru, o pior caso. Com ADPCM o
+    // decimado sai igual ao comprimido; o controlador pula o nível repetido.
+    uint32_t full = MIC_CODEC == SENSOR_CODEC_ADPCM
+                        ? ADPCM_PACKET_BYTES(NOISE_SAMPLES_PER_PACKET)
+                        : RAW_PACKET_BYTES(NOISE_SAMPLES_PER_PACKET);
+    uint32_t half = MIC_CODEC == SENSOR_CODEC_ADPCM
+                        ? ADPCM_PACKET_BYTES(NOISE_SAMPLES_PER_PACKET / 2)
+                        : RAW_PACKET_BYTES(NOISE_SAMPLES_PER_PACKET / 2);
+    quality_ctl_config_t config = {
+        .window_us = 1000000,
+        .level_bytes_per_s =
+            {
+                [QUALITY_FULL] = (full + FRAME_OVERHEAD) * BLOCKS_PER_S,
+                [QUALITY_DECIMATED] = (half + FRAME_OVERHEAD) * BLOCKS_PER_S,
+                [QUALITY_COMPRESSED] =
+                    (ADPCM_PACKET_BYTES(NOISE_SAMPLES_PER_PACKET / 2) +
+                     FRAME_OVERHEAD) *
+                    BLOCKS_PER_S,
+                [QUALITY_FEATURES] =
+                    (sizeof(SensorFeaturePacket) + FRAME_OVERHEAD) *
+                    BLOCKS_PER_S / CONFIG_MIC_FEATURE_WINDOW_BLOCKS,
+            },
+        .down_busy_pct = CONFIG_MIC_QUALITY_DOWN_BUSY_PCT,
+        .up_windows = CONFIG_MIC_QUALITY_UP_WINDOWS,
+    };
+    websocket_quality_start(&config);
+}
+
+static void process_noise_packet(SensorPacket *packet) {
+    quality_level_t level = websocket_quality_level();
+    if (level != current_quality) {
+        // Uma janela de características pela metade não volta a fechar.
+        audio_features_reset(&features_acc);
+        current_quality = level;
+    }
+    packet->header.quality = level;
+
+    switch (level) {
+        case QUALITY_FULL:
+            send_noise_packet(packet, MIC_CODEC);
+            return;
+        case QUALITY_DECIMATED:
+            audio_decimate2(packet);
+            send_noise_packet(packet, MIC_CODEC);
+            return;
+        case QUALITY_COMPRESSED:
+            audio_decimate2(packet);
+            send_noise_packet(packet, SENSOR_CODEC_ADPCM);
+            return;
+        default:
+            add_feature_block(packet);
+            return;
+    }
+}
+#else
+static void process_noise_packet(SensorPacket *packet) {
+    send_noise_packet(packet, MIC_CODEC);
+}
+#endif
+
+#if CONFIG_MIC_TIMING_STATS
+static void send_timing_stats(void) {
+    static SensorTimingPacket timing_packet;
+    if (sample_timing_collect(&timing_packet)) {
+        timing_packet.header.epoch_offset_us = epoch_offset_us();
+        websocket_send_stats(&timing_packet, sizeof(timing_packet));
+    }
+}
+#endif
+
+static void send_telemetry_if_due(void) {
+    static SensorTelemetryPacket telemetry_packet;
+    static uint32_t telemetry_sequence;
+    static int64_t last_us;
+
+    int64_t now = esp_timer_get_time();
+    if (now - last_us < (int64_t)CONFIG_TELEMETRY_INTERVAL_MS * 1000) {
+        return;
+    }
+    last_us = now;
+
+    telemetry_collect(&noise_ring, &telemetry_packet.stats);
+    telemetry_packet.stats.quality = websocket_quality_level();
+    packet_header_fill(&telemetry_packet.header, SENSOR_PACKET_TYPE_TELEMETRY,
+                       0, telemetry_sequence++, (uint64_t)now);
+    telemetry_packet.header.epoch_offset_us = epoch_offset_us();
+    websocket_send_stats(&telemetry_packet, sizeof(telemetry_packet));
+}
+
+// --- Task que drena o anel e envia os pacotes via WebSocket ---
 void send_task(void *pvParameters) {
-    SensorPacket packet;
-    
+    SensorPacket *packets[NOISE_DRAIN_CHUNK];
+
     while (1) {
-        if (xQueueReceive(noise_queue, &packet, portMAX_DELAY) == pdTRUE) {
-            websocket_send_noise_readings(&packet);
+        // Acorda também sem áudio, para a telemetria sair mesmo com a
+        // captura parada.
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+
+        size_t n;
+        while ((n = spsc_ring_pop(&noise_ring, packets, NOISE_DRAIN_CHUNK)) >
+               0) {
+            int64_t offset = epoch_offset_us();
+            for (size_t i = 0; i < n; i++) {
+                packets[i]->header.epoch_offset_us = offset;
+                // Entrega o buffer à task escritora (ou o guarda, no modo
+                // com portão).
+                process_noise_packet(packets[i]);
+            }
         }
+        log_noise_losses();
+        send_telemetry_if_due();
+#if CONFIG_MIC_TIMING_STATS
+        send_timing_stats();
+#endif
     }
 }
 
@@ -127,7 +502,7 @@ void ldr_task(void *pvParameters) {
     SensorReading reading;
     while (1) {
         read_ldr(&reading);
-        websocket_send_readings(&reading);
+        websocket_send_readings(&reading, 1);
         vTaskDelay(pdMS_TO_TICKS(1000));
     }
 }
@@ -135,33 +510,56 @@ void ldr_task(void *pvParameters) {
 void dht_task(void *pvParameters) {
     SensorReading readings[2];
     while (1) {
-        read_dht(readings);
-        websocket_send_readings(readings);
+        websocket_send_readings(readings, read_dht(readings));
         vTaskDelay(pdMS_TO_TICKS(2000));
     }
 }
 
 void app_main(void) {
     ESP_ERROR_CHECK(nvs_flash_init());
+    // Não espera a rede: o WebSocket conecta no primeiro IP e, até lá, os
+    // envios contam como offline (e vão para o spool, se habilitado).
     wifi_init_sta();
+#if CONFIG_MIC_ADAPTIVE_QUALITY
+    quality_setup();
+#endif
     websocket_app_start();
     init_time_sync();
 
     sensor_manager_init();
 
-    // Cria fila
-    noise_queue = xQueueCreate(NOISE_QUEUE_LENGTH, sizeof(SensorPacket));
-    if (noise_queue == NULL) {
-        ESP_LOGE("MAIN", "Falha ao criar a fila");
+    packet_header_init(esp_random());
+    packet_pool_init();
+#if CONFIG_MIC_TIMING_STATS
+    sample_timing_init(CONFIG_MIC_TIMING_EXPORT_MS);
+#endif
+#if CONFIG_MIC_STREAM_FEATURES || CONFIG_MIC_ADAPTIVE_QUALITY
+    audio_features_init(NOISE_SAMPLE_RATE_HZ);
+#endif
+#if CONFIG_MIC_STREAM_GATED
+    noise_gate_setup();
+#endif
+
+    // Cria o anel do áudio
+    if (!spsc_ring_init(&noise_ring, noise_ring_storage, sizeof(SensorPacket *),
+                        CONFIG_MIC_RING_CAPACITY, NOISE_RING_POLICY)) {
+        ESP_LOGE("MAIN", "Capacidade do anel deve ser potência de 2");
         return;
     }
 
     // Cria tasks
     // xTaskCreate(noise_task, "Noise Task", 4096, NULL, 10, NULL); //
     // prioridade maior
-    xTaskCreate(send_task, "Send Task", 4096, NULL, 5, NULL);
-    start_noise_timer();
-    // xTaskCreate(ldr_task, "LDR Task", 4096, NULL, 5, NULL);
-    // xTaskCreate(dht_task, "DHT Task", 4096, NULL, 5, NULL);
+    // Rede e JSON em NETWORK_CORE; a amostragem fica sozinha em SAMPLER_CORE.
+    xTaskCreatePinnedToCore(send_task, "Send Task", CONFIG_SEND_TASK_STACK,
+                            NULL, CONFIG_SEND_TASK_PRIORITY, &send_task_handle,
+                            CONFIG_NETWORK_CORE);
+    start_noise_capture();
+    // xTaskCreatePinnedToCore(ldr_task, "LDR Task", CONFIG_SENSOR_TASK_STACK,
+    //                         NULL, CONFIG_SENSOR_TASK_PRIORITY, NULL,
+    //                         CONFIG_NETWORK_CORE);
+    // xTaskCreatePinnedToCore(dht_task, "DHT Task", CONFIG_SENSOR_TASK_STACK,
+    //                         NULL, CONFIG_SENSOR_TASK_PRIORITY, NULL,
+    //                         CONFIG_NETWORK_CORE);
     //  xTaskCreate(sensor_task, "Sensor Task", 4096, NULL, 5, NULL);
 }
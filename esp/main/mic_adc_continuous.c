@@ -0,0 +1,100 @@
+#include "mic_adc_continuous.h"
+
+#include "esp_adc/adc_continuous.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "mic_adc";
+
+static adc_continuous_handle_t adc_handle;
+static volatile uint32_t pool_overflows;
+
+static bool IRAM_ATTR on_pool_overflow(adc_continuous_handle_t handle,
+                                       const adc_continuous_evt_data_t *edata,
+                                       void *user_data) {
+    pool_overflows++;
+    return false;
+}
+
+static int hal_start(void *ctx) {
+    return adc_continuous_start(adc_handle) == ESP_OK ? 0 : -1;
+}
+
+static int hal_stop(void *ctx) {
+    return adc_continuous_stop(adc_handle) == ESP_OK ? 0 : -1;
+}
+
+static int64_t hal_now_us(void *ctx) { return esp_timer_get_time(); }
+
+// Metade das conversões de cada quadro perdido é do microfone.
+static uint32_t hal_lost_conversions(void *ctx) {
+    return pool_overflows * (MIC_ADC_FRAME_BYTES / MIC_CONV_BYTES / 2);
+}
+
+static int hal_read_frame(void *ctx, uint8_t *buf, size_t len,
+                          uint32_t timeout_ms) {
+    uint32_t out_len = 0;
+    esp_err_t err = adc_continuous_read(
+        adc_handle, buf, len, &out_len,
+        timeout_ms == UINT32_MAX ? ADC_MAX_DELAY : timeout_ms);
+    if (err == ESP_ERR_TIMEOUT) {
+        return 0;
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "adc_continuous_read: %s", esp_err_to_name(err));
+        return -1;
+    }
+    return (int)out_len;
+}
+
+void mic_adc_continuous_init(uint8_t mic_channel, uint8_t ldr_channel,
+                             uint32_t sample_rate_hz, uint8_t decimation,
+                             mic_adc_hal_t *hal) {
+    adc_continuous_handle_cfg_t handle_config = {
+        .max_store_buf_size = MIC_ADC_FRAME_BYTES * 8,
+        .conv_frame_size = MIC_ADC_FRAME_BYTES,
+    };
+    ESP_ERROR_CHECK(adc_continuous_new_handle(&handle_config, &adc_handle));
+
+    // O LDR entra no padrão com a mesma cadência do microfone; o montador
+    // tira a média dele e guarda só o valor mais recente.
+    adc_digi_pattern_config_t pattern[2] = {
+        {.atten = ADC_ATTEN_DB_12,
+         .channel = mic_channel,
+         .unit = ADC_UNIT_1,
+         .bit_width = SOC_ADC_DIGI_MAX_BITWIDTH},
+        {.atten = ADC_ATTEN_DB_12,
+         .channel = ldr_channel,
+         .unit = ADC_UNIT_1,
+         .bit_width = SOC_ADC_DIGI_MAX_BITWIDTH},
+    };
+
+    adc_continuous_config_t config = {
+        .pattern_num = 2,
+        .adc_pattern = pattern,
+        // Frequência total de conversões: `decimation` por amostra de saída
+        // para cada um dos dois canais do padrão.
+        .sample_freq_hz = sample_rate_hz * decimation * 2,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE1,
+    };
+    ESP_ERROR_CHECK(adc_continuous_config(adc_handle, &config));
+
+    adc_continuous_evt_cbs_t cbs = {
+        .on_pool_ovf = on_pool_overflow,
+    };
+    ESP_ERROR_CHECK(
+        adc_continuous_register_event_callbacks(adc_handle, &cbs, NULL));
+
+    *hal = (mic_adc_hal_t){
+        .start = hal_start,
+        .stop = hal_stop,
+        .read_frame = hal_read_frame,
+        .now_us = hal_now_us,
+        .lost_conversions = hal_lost_conversions,
+        .ctx = NULL,
+    };
+}
+
+uint32_t mic_adc_continuous_overflows(void) { return pool_overflows; }
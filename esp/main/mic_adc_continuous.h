@@ -0,0 +1,17 @@
+#pragma once
+#include <stdint.h>
+
+#include "mic_capture.h"
+
+// Quadro de DMA: 300 conversões, metade do microfone e metade do LDR; com
+// decimação 3, 50 amostras de saída do microfone por quadro.
+#define MIC_ADC_FRAME_BYTES 600
+
+// HAL do microfone sobre o driver contínuo (DMA) do ADC1. O padrão de
+// conversão inclui o canal do microfone e o do LDR, já que o ADC1 fica
+// ocupado pelo DMA e não pode mais ser lido em modo oneshot.
+void mic_adc_continuous_init(uint8_t mic_channel, uint8_t ldr_channel,
+                             uint32_t sample_rate_hz, uint8_t decimation,
+                             mic_adc_hal_t *hal);
+// Quadros descartados pelo driver porque o pool de DMA estava cheio.
+uint32_t mic_adc_continuous_overflows(void);
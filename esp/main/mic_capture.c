@@ -0,0 +1,144 @@
+#include "mic_capture.h"
+
+#include <string.h>
+
+#include "packet_header.h"
+#include "packet_pool.h"
+
+#define AUX_AVERAGE_COUNT 256
+
+void mic_assembler_init(mic_assembler_t *a, uint8_t mic_channel,
+                        uint8_t aux_channel, uint8_t decimation,
+                        mic_block_cb_t on_block, void *cb_arg) {
+    memset(a, 0, sizeof(*a));
+    a->mic_channel = mic_channel;
+    a->aux_channel = aux_channel;
+    a->decimation = decimation ? decimation : 1;
+    a->aux_last = -1;
+    a->on_block = on_block;
+    a->cb_arg = cb_arg;
+}
+
+static void push_sample(mic_assembler_t *a, int16_t sample) {
+    if (a->sample_index == 0 && a->packet == NULL) {
+        a->packet = packet_pool_acquire();
+    }
+    // Sem buffer livre o bloco inteiro é descartado, mas a contagem segue
+    // para manter o alinhamento dos blocos.
+    if (a->packet != NULL) {
+        a->packet->samples[a->sample_index] = sample;
+    }
+
+    if (++a->sample_index == NOISE_SAMPLES_PER_PACKET) {
+        // O ADC converte a uma taxa fixa, então o instante e a sequência do
+        // bloco saem da contagem de conversões: nenhuma leitura de relógio
+        // por bloco e nenhum jitter de agendamento no timestamp. Depois de
+        // uma perda a sequência pula os blocos que caberiam no buraco.
+        uint64_t block_start = a->block_start;
+        uint32_t sequence = (uint32_t)(block_start / a->decimation /
+                                       NOISE_SAMPLES_PER_PACKET);
+        a->sample_index = 0;
+        a->block_start = a->conversions;
+        if (a->packet == NULL) {
+            a->dropped_blocks++;
+            return;
+        }
+        a->blocks++;
+
+        packet_header_fill(&a->packet->header, SENSOR_PACKET_TYPE_AUDIO,
+                           NOISE_SAMPLES_PER_PACKET, sequence,
+                           a->start_time_us +
+                               block_start * 1000000 /
+                                   (NOISE_SAMPLE_RATE_HZ * a->decimation));
+
+        SensorPacket *done = a->packet;
+        a->packet = NULL;
+        if (a->on_block) {
+            a->on_block(done, a->cb_arg);
+        } else {
+            packet_pool_release(done);
+        }
+    }
+}
+
+void mic_assembler_feed(mic_assembler_t *a, const uint8_t *frame, size_t len) {
+    for (size_t i = 0; i + MIC_CONV_BYTES <= len; i += MIC_CONV_BYTES) {
+        uint16_t word = (uint16_t)(frame[i] | (frame[i + 1] << 8));
+        uint8_t channel = MIC_CONV_CHANNEL(word);
+        uint16_t data = MIC_CONV_DATA(word);
+
+        if (channel == a->mic_channel) {
+            // Média de `decimation` conversões: leva a taxa do ADC (que no
+            // ESP32 não desce abaixo de 20 kHz) para 8 kHz e ainda atua como
+            // filtro anti-aliasing simples.
+            a->acc += data;
+            a->conversions++;
+            if (++a->acc_count == a->decimation) {
+                push_sample(a, (int16_t)(a->acc / a->decimation));
+                a->acc = 0;
+                a->acc_count = 0;
+            }
+        } else if (channel == a->aux_channel) {
+            a->aux_acc += data;
+            if (++a->aux_count == AUX_AVERAGE_COUNT) {
+                a->aux_last = (int)(a->aux_acc / AUX_AVERAGE_COUNT);
+                a->aux_acc = 0;
+                a->aux_count = 0;
+            }
+        } else {
+            a->foreign_conversions++;
+        }
+    }
+}
+
+void mic_assembler_skip(mic_assembler_t *a, uint32_t conversions) {
+    if (conversions == 0) {
+        return;
+    }
+    // Um bloco com um buraco no meio não serve: as amostras já montadas vão
+    // embora e o buffer volta para o pool.
+    if (a->sample_index > 0 || a->acc_count > 0) {
+        a->dropped_blocks++;
+    }
+    if (a->packet != NULL) {
+        packet_pool_release(a->packet);
+        a->packet = NULL;
+    }
+    a->sample_index = 0;
+    a->acc = 0;
+    a->acc_count = 0;
+    a->conversions += conversions;
+    a->lost_conversions += conversions;
+    a->block_start = a->conversions;
+}
+
+int mic_capture_run(const mic_adc_hal_t *hal, mic_assembler_t *a,
+                    uint8_t *frame_buf, size_t frame_len) {
+    int ret = hal->start(hal->ctx);
+    if (ret < 0) {
+        return ret;
+    }
+    a->start_time_us = hal->now_us(hal->ctx);
+    uint32_t lost =
+        hal->lost_conversions != NULL ? hal->lost_conversions(hal->ctx) : 0;
+
+    while (1) {
+        ret = hal->read_frame(hal->ctx, frame_buf, frame_len, UINT32_MAX);
+        if (ret < 0) {
+            break;
+        }
+        // O driver descarta os quadros novos quando o pool enche, então o
+        // buraco fica depois dos quadros que ainda estão no pool. Se havia
+        // algum, os blocos montados com ele recebem o tempo de depois do
+        // buraco; os seguintes voltam ao tempo certo.
+        if (hal->lost_conversions != NULL) {
+            uint32_t total = hal->lost_conversions(hal->ctx);
+            mic_assembler_skip(a, total - lost);
+            lost = total;
+        }
+        mic_assembler_feed(a, frame_buf, (size_t)ret);
+    }
+
+    hal->stop(hal->ctx);
+    return ret;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <stddef.h>  // para size_t
+#include <stdint.h>
+
+#include "sensor_manager.h"
+
+/*
+ * Captura contínua do microfone.
+ *
+ * O ADC (em modo contínuo/DMA) entrega quadros de conversões brutas. Este
+ * módulo não depende do ESP-IDF: recebe os quadros por uma HAL mínima e
+ * monta blocos de NOISE_SAMPLES_PER_PACKET amostras já decimadas para
+ * NOISE_SAMPLE_RATE_HZ. Assim a montagem dos blocos pode ser compilada e
+ * exercitada no host trocando a HAL por um ADC falso.
+ */
+
+// Cada conversão ocupa 2 bytes (formato TYPE1 do ESP32: 12 bits de dado e
+// 4 bits de canal).
+#define MIC_CONV_BYTES 2
+#define MIC_CONV_DATA(w) ((w) & 0x0FFF)
+#define MIC_CONV_CHANNEL(w) (((w) >> 12) & 0x0F)
+
+// HAL do ADC. Todas as funções retornam < 0 em caso de erro.
+typedef struct {
+    int (*start)(void *ctx);
+    int (*stop)(void *ctx);
+    // Bloqueia até haver um quadro pronto; retorna o número de bytes lidos.
+    int (*read_frame)(void *ctx, uint8_t *buf, size_t len, uint32_t timeout_ms);
+    // Relógio monotônico em microssegundos.
+    int64_t (*now_us)(void *ctx);
+    // Opcional: total de conversões do microfone que o driver descartou
+    // por falta de espaço (estouro do pool de DMA).
+    uint32_t (*lost_conversions)(void *ctx);
+    void *ctx;
+} mic_adc_hal_t;
+
+// Chamado sempre que um bloco completo é montado. O pacote vem do
+// packet_pool e passa a pertencer a quem recebe o callback.
+typedef void (*mic_block_cb_t)(SensorPacket *packet, void *arg);
+
+typedef struct {
+    uint8_t mic_channel;
+    uint8_t aux_channel;       // canal secundário (LDR) no mesmo padrão
+    uint8_t decimation;        // conversões médias por amostra de saída
+    uint8_t acc_count;
+    uint32_t acc;
+    uint32_t aux_acc;
+    uint16_t aux_count;
+    volatile int aux_last;     // última média do canal secundário
+    int sample_index;
+    SensorPacket *packet;      // buffer do pool em preenchimento
+    int64_t start_time_us;     // instante da primeira conversão
+    // Conversões do microfone desde o início, contando as perdidas; o tempo
+    // e a sequência de cada bloco saem daqui.
+    uint64_t conversions;
+    uint64_t block_start;      // conversão inicial do bloco em montagem
+    mic_block_cb_t on_block;
+    void *cb_arg;
+    uint32_t blocks;
+    uint32_t foreign_conversions;  // conversões de canais não esperados
+    uint32_t dropped_blocks;       // blocos perdidos por falta de buffer
+    uint32_t lost_conversions;     // conversões perdidas pelo driver
+} mic_assembler_t;
+
+void mic_assembler_init(mic_assembler_t *a, uint8_t mic_channel,
+                        uint8_t aux_channel, uint8_t decimation,
+                        mic_block_cb_t on_block, void *cb_arg);
+void mic_assembler_feed(mic_assembler_t *a, const uint8_t *frame, size_t len);
+// Registra `conversions` conversões do microfone que não chegaram (quadros
+// descartados pelo driver). O bloco em montagem é descartado e o próximo
+// começa depois do buraco, com o tempo e a sequência avançados.
+void mic_assembler_skip(mic_assembler_t *a, uint32_t conversions);
+
+// Laço de captura: lê quadros da HAL e alimenta o montador até a HAL
+// retornar erro. Retorna o código de erro da HAL.
+int mic_capture_run(const mic_adc_hal_t *hal, mic_assembler_t *a,
+                    uint8_t *frame_buf, size_t frame_len);
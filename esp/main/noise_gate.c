@@ -0,0 +1,146 @@
+#include "noise_gate.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "audio_features.h"
+
+// Piso mínimo de 1 LSB^2, para um sinal constante não abrir por 1 LSB.
+#define FLOOR_MIN 256u
+// Passos do piso por bloco (62,5 ms): desce com 1/8, sobe com 1/256
+// (~16 s) fechado e 1/1024 (~1 min) durante um evento.
+#define FLOOR_FALL_SHIFT 3
+#define FLOOR_RISE_SHIFT 8
+#define FLOOR_RISE_OPEN_SHIFT 10
+
+static uint32_t db_to_ratio_q8(float db) {
+    return (uint32_t)lrintf(powf(10.0f, db / 10.0f) * 256.0f);
+}
+
+static void reset_stats(noise_gate_t *gate) {
+    gate->stat_energy_sum = 0;
+    gate->stat_energy_min = UINT64_MAX;
+    gate->stat_energy_max = 0;
+    gate->stat_peak = 0;
+    gate->stat_events = 0;
+    gate->stat_blocks = 0;
+}
+
+void noise_gate_init(noise_gate_t *gate, uint32_t threshold_db,
+                     uint16_t hangover_blocks) {
+    memset(gate, 0, sizeof(*gate));
+    gate->open_ratio_q8 = db_to_ratio_q8((float)threshold_db);
+    gate->close_ratio_q8 = db_to_ratio_q8(threshold_db / 2.0f);
+    gate->hangover_blocks = hangover_blocks;
+    gate->floor = FLOOR_MIN;
+    reset_stats(gate);
+}
+
+static uint64_t block_energy(const int16_t *samples, size_t n,
+                             uint16_t *peak) {
+    int32_t sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += samples[i];
+    }
+    int32_t mean = sum / (int32_t)n;
+
+    uint64_t sum_sq = 0;
+    uint16_t max = 0;
+    for (size_t i = 0; i < n; i++) {
+        int32_t v = samples[i] - mean;
+        sum_sq += (uint64_t)((int64_t)v * v);
+        uint16_t mag = (uint16_t)(v < 0 ? -v : v);
+        if (mag > max) {
+            max = mag;
+        }
+    }
+    *peak = max;
+    return (sum_sq << 8) / n;
+}
+
+static void track_floor(noise_gate_t *gate, uint64_t energy) {
+    if (!gate->primed) {
+        gate->floor = energy;
+        gate->primed = true;
+    } else if (energy < gate->floor) {
+        gate->floor -= (gate->floor - energy) >> FLOOR_FALL_SHIFT;
+    } else {
+        int shift = gate->open ? FLOOR_RISE_OPEN_SHIFT : FLOOR_RISE_SHIFT;
+        gate->floor += (energy - gate->floor) >> shift;
+    }
+    if (gate->floor < FLOOR_MIN) {
+        gate->floor = FLOOR_MIN;
+    }
+}
+
+noise_gate_event_t noise_gate_feed(noise_gate_t *gate, const int16_t *samples,
+                                   size_t n) {
+    if (n == 0) {
+        return gate->open ? NOISE_GATE_ACTIVE : NOISE_GATE_IDLE;
+    }
+
+    uint16_t peak;
+    uint64_t energy = block_energy(samples, n, &peak);
+
+    gate->stat_energy_sum += energy;
+    if (energy < gate->stat_energy_min) {
+        gate->stat_energy_min = energy;
+    }
+    if (energy > gate->stat_energy_max) {
+        gate->stat_energy_max = energy;
+    }
+    if (peak > gate->stat_peak) {
+        gate->stat_peak = peak;
+    }
+    gate->stat_blocks++;
+
+    // Limiares com o piso de antes deste bloco.
+    uint64_t open_at = (gate->floor * gate->open_ratio_q8) >> 8;
+    uint64_t close_at = (gate->floor * gate->close_ratio_q8) >> 8;
+    bool primed = gate->primed;
+    noise_gate_event_t event;
+
+    if (!gate->open) {
+        if (primed && energy > open_at) {
+            gate->open = true;
+            gate->hangover = gate->hangover_blocks;
+            gate->stat_events++;
+            event = NOISE_GATE_START;
+        } else {
+            event = NOISE_GATE_IDLE;
+        }
+    } else if (energy >= close_at) {
+        gate->hangover = gate->hangover_blocks;
+        event = NOISE_GATE_ACTIVE;
+    } else if (gate->hangover > 0) {
+        gate->hangover--;
+        event = NOISE_GATE_ACTIVE;
+    } else {
+        gate->open = false;
+        event = NOISE_GATE_END;
+    }
+
+    track_floor(gate, energy);
+    return event;
+}
+
+static uint16_t energy_to_rms_q4(uint64_t energy) {
+    // sqrt(E / 256) * 16 = sqrt(E)
+    uint32_t rms = audio_isqrt64(energy);
+    return rms > UINT16_MAX ? UINT16_MAX : (uint16_t)rms;
+}
+
+void noise_gate_take_stats(noise_gate_t *gate, NoiseGateStats *out) {
+    memset(out, 0, sizeof(*out));
+    out->floor_q4 = energy_to_rms_q4(gate->floor);
+    if (gate->stat_blocks > 0) {
+        out->rms_min_q4 = energy_to_rms_q4(gate->stat_energy_min);
+        out->rms_mean_q4 =
+            energy_to_rms_q4(gate->stat_energy_sum / gate->stat_blocks);
+        out->rms_max_q4 = energy_to_rms_q4(gate->stat_energy_max);
+    }
+    out->peak = gate->stat_peak;
+    out->events = gate->stat_events;
+    out->blocks = gate->stat_blocks;
+    reset_stats(gate);
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>  // para size_t
+#include <stdint.h>
+
+#include "sensor_manager.h"
+
+/*
+ * Detector de eventos sonoros com piso de ruído adaptativo.
+ *
+ * Cada bloco vira uma energia média (sem o nível DC). O piso segue essa
+ * energia descendo rápido e subindo devagar, então acompanha mudanças lentas
+ * do ambiente (ventilador, ar-condicionado) sem ser puxado por um ronco. O
+ * portão abre quando a energia passa o limiar acima do piso e fecha, com
+ * histerese e tempo de espera, quando ela volta. Sem dependência do ESP-IDF:
+ * roda no host alimentado por arquivos WAV.
+ */
+
+typedef enum {
+    NOISE_GATE_IDLE,    // fechado
+    NOISE_GATE_START,   // abriu neste bloco
+    NOISE_GATE_ACTIVE,  // continua aberto
+    NOISE_GATE_END,     // último bloco do evento
+} noise_gate_event_t;
+
+// Payload de um pacote SENSOR_PACKET_TYPE_HEARTBEAT. Níveis RMS em 1/16 LSB.
+typedef struct {
+    uint16_t floor_q4;     // piso de ruído no fim do intervalo
+    uint16_t rms_min_q4;   // bloco mais silencioso
+    uint16_t rms_mean_q4;  // RMS de todo o intervalo
+    uint16_t rms_max_q4;   // bloco mais alto
+    uint16_t peak;         // maior desvio absoluto do nível DC
+    uint16_t events;       // eventos iniciados no intervalo
+    uint16_t blocks;       // blocos resumidos
+} __attribute__((packed)) NoiseGateStats;
+
+typedef struct {
+    SensorPacketHeader header;
+    NoiseGateStats stats;
+} __attribute__((packed)) SensorHeartbeatPacket;
+
+typedef struct {
+    // Energias em LSB^2 Q8.
+    uint64_t floor;
+    uint32_t open_ratio_q8;
+    uint32_t close_ratio_q8;
+    uint16_t hangover_blocks;
+    uint16_t hangover;
+    bool open;
+    bool primed;
+
+    // Estatísticas desde o último noise_gate_take_stats.
+    uint64_t stat_energy_sum;
+    uint64_t stat_energy_min;
+    uint64_t stat_energy_max;
+    uint16_t stat_peak;
+    uint16_t stat_events;
+    uint16_t stat_blocks;
+} noise_gate_t;
+
+// `threshold_db`: quanto a energia precisa passar do piso para abrir; fecha
+// abaixo da metade disso. `hangover_blocks`: blocos mantidos abertos depois
+// que o nível volta.
+void noise_gate_init(noise_gate_t *gate, uint32_t threshold_db,
+                     uint16_t hangover_blocks);
+noise_gate_event_t noise_gate_feed(noise_gate_t *gate, const int16_t *samples,
+                                   size_t n);
+// Preenche `out` e zera as estatísticas do intervalo.
+void noise_gate_take_stats(noise_gate_t *gate, NoiseGateStats *out);
@@ -0,0 +1,28 @@
+#include "packet_header.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#else
+#define IRAM_ATTR
+#endif
+
+static uint32_t boot_id;
+
+void packet_header_init(uint32_t id) { boot_id = id; }
+
+uint32_t packet_header_boot_id(void) { return boot_id; }
+
+void IRAM_ATTR packet_header_fill(SensorPacketHeader *header, uint8_t type,
+                                  uint16_t sample_count, uint32_t sequence,
+                                  uint64_t capture_time_us) {
+    header->version = SENSOR_PACKET_VERSION;
+    header->type = type;
+    header->flags = 0;
+    header->quality = 0;
+    header->sample_count = sample_count;
+    header->sample_rate_hz = NOISE_SAMPLE_RATE_HZ;
+    header->boot_id = boot_id;
+    header->sequence = sequence;
+    header->capture_time_us = capture_time_us;
+    header->epoch_offset_us = 0;
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <stdint.h>
+
+#include "sensor_manager.h"
+
+// Identificador do boot atual, sorteado uma vez na inicialização.
+void packet_header_init(uint32_t boot_id);
+uint32_t packet_header_boot_id(void);
+
+// Preenche os campos fixos do cabeçalho. epoch_offset_us fica zerado: ele é
+// preenchido no envio, fora do caminho de amostragem.
+void packet_header_fill(SensorPacketHeader *header, uint8_t type,
+                        uint16_t sample_count, uint32_t sequence,
+                        uint64_t capture_time_us);
@@ -0,0 +1,118 @@
+#include "packet_pool.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#else
+#define IRAM_ATTR
+#endif
+
+#define POOL_EMPTY 0xFFFFu
+#define HEAD_INDEX(h) ((uint16_t)((h) & 0xFFFFu))
+// A parte alta da cabeça é um contador de versão que evita o problema ABA.
+#define HEAD_NEXT(h, idx) ((((h) + 0x10000u) & 0xFFFF0000u) | (idx))
+
+enum { SLOT_FREE = 0, SLOT_IN_USE = 1 };
+
+static SensorPacket pool[PACKET_POOL_SIZE] __attribute__((aligned(4)));
+static atomic_uint_least16_t next[PACKET_POOL_SIZE];
+static atomic_uchar state[PACKET_POOL_SIZE];
+static atomic_uint head;
+static atomic_uint free_count;
+
+static atomic_uint stat_acquired;
+static atomic_uint stat_released;
+static atomic_uint stat_exhausted;
+static atomic_uint stat_double_free;
+static atomic_uint stat_invalid_release;
+static atomic_uint stat_min_free;
+
+static void IRAM_ATTR push(uint16_t idx) {
+    unsigned old = atomic_load_explicit(&head, memory_order_relaxed);
+    do {
+        atomic_store_explicit(&next[idx], HEAD_INDEX(old),
+                              memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(
+        &head, &old, HEAD_NEXT(old, idx), memory_order_release,
+        memory_order_relaxed));
+}
+
+void packet_pool_init(void) {
+    atomic_store(&head, POOL_EMPTY);
+    for (uint16_t i = 0; i < PACKET_POOL_SIZE; i++) {
+        atomic_store(&state[i], SLOT_FREE);
+        push(i);
+    }
+    atomic_store(&free_count, PACKET_POOL_SIZE);
+    atomic_store(&stat_acquired, 0);
+    atomic_store(&stat_released, 0);
+    atomic_store(&stat_exhausted, 0);
+    atomic_store(&stat_double_free, 0);
+    atomic_store(&stat_invalid_release, 0);
+    atomic_store(&stat_min_free, PACKET_POOL_SIZE);
+}
+
+SensorPacket *IRAM_ATTR packet_pool_acquire(void) {
+    unsigned old = atomic_load_explicit(&head, memory_order_acquire);
+    uint16_t idx;
+    do {
+        idx = HEAD_INDEX(old);
+        if (idx == POOL_EMPTY) {
+            atomic_fetch_add_explicit(&stat_exhausted, 1,
+                                      memory_order_relaxed);
+            return NULL;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(
+        &head, &old,
+        HEAD_NEXT(old, atomic_load_explicit(&next[idx], memory_order_relaxed)),
+        memory_order_acquire, memory_order_acquire));
+
+    atomic_store_explicit(&state[idx], SLOT_IN_USE, memory_order_relaxed);
+    atomic_fetch_add_explicit(&stat_acquired, 1, memory_order_relaxed);
+
+    unsigned now_free =
+        atomic_fetch_sub_explicit(&free_count, 1, memory_order_relaxed) - 1;
+    unsigned min_free = atomic_load_explicit(&stat_min_free,
+                                             memory_order_relaxed);
+    while (now_free < min_free &&
+           !atomic_compare_exchange_weak_explicit(&stat_min_free, &min_free,
+                                                  now_free,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+    return &pool[idx];
+}
+
+void IRAM_ATTR packet_pool_release(SensorPacket *packet) {
+    if (packet < pool || packet >= pool + PACKET_POOL_SIZE) {
+        atomic_fetch_add_explicit(&stat_invalid_release, 1,
+                                  memory_order_relaxed);
+        return;
+    }
+    uint16_t idx = (uint16_t)(packet - pool);
+
+    if (atomic_exchange_explicit(&state[idx], SLOT_FREE,
+                                 memory_order_relaxed) == SLOT_FREE) {
+        atomic_fetch_add_explicit(&stat_double_free, 1, memory_order_relaxed);
+        return;
+    }
+
+    atomic_fetch_add_explicit(&stat_released, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&free_count, 1, memory_order_relaxed);
+    push(idx);
+}
+
+size_t packet_pool_free_count(void) {
+    return atomic_load_explicit(&free_count, memory_order_relaxed);
+}
+
+void packet_pool_get_stats(packet_pool_stats_t *stats) {
+    stats->acquired = atomic_load(&stat_acquired);
+    stats->released = atomic_load(&stat_released);
+    stats->exhausted = atomic_load(&stat_exhausted);
+    stats->double_free = atomic_load(&stat_double_free);
+    stats->invalid_release = atomic_load(&stat_invalid_release);
+    stats->min_free = atomic_load(&stat_min_free);
+}
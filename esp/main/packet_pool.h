@@ -0,0 +1,42 @@
+#pragma once
+#include <stddef.h>  // para size_t
+#include <stdint.h>
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+#include "sensor_manager.h"
+
+/*
+ * Pool fixo de SensorPacket pré-alocados.
+ *
+ * O produtor (amostrador) pega um buffer, preenche no lugar e entrega só o
+ * ponteiro; o consumidor envia direto do buffer e o devolve ao pool. A lista
+ * livre é uma pilha lock-free (C11 atomics), então acquire/release podem ser
+ * chamados do callback do timer sem seção crítica.
+ */
+
+// No modo com portão a pré-gravação segura blocos no pool enquanto espera
+// um evento; eles vêm por cima dos 12 do caminho de envio.
+#if CONFIG_MIC_STREAM_GATED
+#define PACKET_POOL_SIZE \
+    (12 + NOISE_BLOCKS_FOR_MS(CONFIG_MIC_GATE_PREROLL_MS))
+#else
+#define PACKET_POOL_SIZE 12
+#endif
+
+typedef struct {
+    uint32_t acquired;
+    uint32_t released;
+    uint32_t exhausted;        // acquire sem buffer livre
+    uint32_t double_free;      // release de um buffer que já estava livre
+    uint32_t invalid_release;  // ponteiro que não pertence ao pool
+    uint32_t min_free;         // menor número de buffers livres já visto
+} packet_pool_stats_t;
+
+void packet_pool_init(void);
+// Retorna NULL (e conta em `exhausted`) quando não há buffer livre.
+SensorPacket *packet_pool_acquire(void);
+void packet_pool_release(SensorPacket *packet);
+size_t packet_pool_free_count(void);
+void packet_pool_get_stats(packet_pool_stats_t *stats);
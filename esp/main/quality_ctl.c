@@ -0,0 +1,111 @@
+#include "quality_ctl.h"
+
+#include <string.h>
+
+static void start_window(quality_ctl_t *ctl, uint64_t now_us) {
+    ctl->window_start_us = now_us;
+    ctl->busy_us = 0;
+    ctl->bytes = 0;
+    ctl->timeouts = 0;
+    ctl->drops = 0;
+}
+
+void quality_ctl_init(quality_ctl_t *ctl, const quality_ctl_config_t *config,
+                      uint64_t now_us) {
+    memset(ctl, 0, sizeof(*ctl));
+    ctl->config = *config;
+    ctl->level = QUALITY_FULL;
+    start_window(ctl, now_us);
+}
+
+void quality_ctl_record_send(quality_ctl_t *ctl, size_t bytes,
+                             uint32_t latency_us, bool timed_out) {
+    ctl->busy_us += latency_us;
+    if (timed_out) {
+        ctl->timeouts++;
+    } else {
+        ctl->bytes += bytes;
+    }
+}
+
+void quality_ctl_record_drop(quality_ctl_t *ctl) { ctl->drops++; }
+
+// Um nível que não gera mais que o de baixo não é degrau (com ADPCM o
+// decimado já é o comprimido): a escada passa direto por ele.
+static bool is_step(const quality_ctl_config_t *cfg, quality_level_t level) {
+    return level == QUALITY_FULL || level + 1 == QUALITY_LEVELS ||
+           cfg->level_bytes_per_s[level] > cfg->level_bytes_per_s[level + 1];
+}
+
+// Próximo degrau abaixo de `level`, ou o próprio se não houver.
+static quality_level_t step_down(const quality_ctl_config_t *cfg,
+                                 quality_level_t level) {
+    for (quality_level_t next = level + 1; next < QUALITY_LEVELS; next++) {
+        if (is_step(cfg, next)) {
+            return next;
+        }
+    }
+    return level;
+}
+
+// Nível mais alto cuja demanda cabe na vazão medida.
+static quality_level_t level_for_capacity(const quality_ctl_t *ctl,
+                                          quality_level_t from) {
+    const quality_ctl_config_t *cfg = &ctl->config;
+    quality_level_t level = from;
+    while ((uint64_t)cfg->level_bytes_per_s[level] * 100 >
+           (uint64_t)ctl->capacity_bytes_per_s * cfg->down_busy_pct) {
+        quality_level_t next = step_down(cfg, level);
+        if (next == level) {
+            break;
+        }
+        level = next;
+    }
+    return level;
+}
+
+quality_level_t quality_ctl_update(quality_ctl_t *ctl, uint64_t now_us) {
+    const quality_ctl_config_t *cfg = &ctl->config;
+    uint64_t elapsed = now_us - ctl->window_start_us;
+    if (elapsed < cfg->window_us) {
+        return ctl->level;
+    }
+
+    if (ctl->settling) {
+        ctl->settling = false;
+        start_window(ctl, now_us);
+        return ctl->level;
+    }
+
+    uint64_t busy_pct = ctl->busy_us * 100 / elapsed;
+    bool congested = ctl->timeouts > 0 || ctl->drops > 0 ||
+                     busy_pct > cfg->down_busy_pct;
+
+    if (congested) {
+        ctl->capacity_bytes_per_s =
+            ctl->busy_us ? (uint32_t)(ctl->bytes * 1000000 / ctl->busy_us) : 0;
+        if (ctl->probe_windows > 0 && ctl->backoff < QUALITY_MAX_BACKOFF) {
+            ctl->backoff++;  // a subida não se sustentou
+        }
+        ctl->probe_windows = 0;
+        ctl->good_windows = 0;
+        ctl->level = level_for_capacity(ctl, step_down(cfg, ctl->level));
+        ctl->settling = true;
+    } else {
+        if (ctl->probe_windows > 0 && --ctl->probe_windows == 0) {
+            ctl->backoff = 0;
+        }
+        ctl->good_windows++;
+        if (ctl->level > QUALITY_FULL && ctl->probe_windows == 0 &&
+            ctl->good_windows >= ((uint32_t)cfg->up_windows << ctl->backoff)) {
+            do {
+                ctl->level--;
+            } while (!is_step(cfg, ctl->level));
+            ctl->good_windows = 0;
+            ctl->probe_windows = cfg->up_windows;
+        }
+    }
+
+    start_window(ctl, now_us);
+    return ctl->level;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>  // para size_t
+#include <stdint.h>
+
+/*
+ * Controle de qualidade do áudio sob contrapressão. A task escritora
+ * registra cada envio (bytes, duração, timeout) e, a cada janela, o
+ * controlador compara o tempo gasto enviando com a duração da janela.
+ *
+ * Acima de `down_busy_pct` (ou com timeout/descarte) o enlace não está dando
+ * conta: os envios estavam bloqueados, então bytes/tempo ocupado é a vazão
+ * real, e o controlador desce direto para o nível mais alto que cabe nela.
+ * Enlace folgado não diz quanto sobra, então a subida é uma sonda: um nível
+ * depois de `up_windows` janelas boas; se a sonda congestiona dentro de
+ * `up_windows` janelas, a espera seguinte dobra (até 2^QUALITY_MAX_BACKOFF).
+ * A janela logo depois de uma descida não é julgada: ela ainda escoa o que
+ * ficou no buffer do TCP. Um nível que não gera mais bytes que o de baixo
+ * é pulado nos dois sentidos.
+ *
+ * Determinístico: o tempo vem do chamador. Sem dependência do ESP-IDF.
+ */
+
+typedef enum {
+    QUALITY_FULL,        // 8 kHz, codec configurado
+    QUALITY_DECIMATED,   // 4 kHz, codec configurado
+    QUALITY_COMPRESSED,  // 4 kHz IMA-ADPCM
+    QUALITY_FEATURES,    // só características
+    QUALITY_LEVELS,
+} quality_level_t;
+
+#define QUALITY_MAX_BACKOFF 3
+
+typedef struct {
+    uint32_t window_us;
+    // Bytes por segundo que cada nível gera (estimativa do produtor).
+    uint32_t level_bytes_per_s[QUALITY_LEVELS];
+    uint8_t down_busy_pct;
+    uint8_t up_windows;
+} quality_ctl_config_t;
+
+typedef struct {
+    quality_ctl_config_t config;
+    quality_level_t level;
+    uint64_t window_start_us;
+    uint64_t busy_us;
+    uint64_t bytes;
+    uint32_t timeouts;
+    uint32_t drops;
+    uint32_t good_windows;
+    uint8_t probe_windows;  // janelas restantes para confirmar uma subida
+    uint8_t backoff;
+    bool settling;
+    uint32_t capacity_bytes_per_s;  // medida na última janela congestionada
+} quality_ctl_t;
+
+void quality_ctl_init(quality_ctl_t *ctl, const quality_ctl_config_t *config,
+                      uint64_t now_us);
+void quality_ctl_record_send(quality_ctl_t *ctl, size_t bytes,
+                             uint32_t latency_us, bool timed_out);
+// Descarte por fila cheia: o enlace não está dando conta.
+void quality_ctl_record_drop(quality_ctl_t *ctl);
+// Fecha a janela se ela já passou e retorna o nível a usar.
+quality_level_t quality_ctl_update(quality_ctl_t *ctl, uint64_t now_us);
@@ -0,0 +1,154 @@
+#include "rice_codec.h"
+
+#define ESCAPE_BITS 17
+
+typedef struct {
+    uint8_t *buf;
+    size_t cap;
+    size_t pos;      // byte atual
+    uint32_t acc;    // bits pendentes, alinhados à direita
+    int acc_bits;
+    int overflow;
+} bit_writer_t;
+
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;
+    uint32_t acc;
+    int acc_bits;
+    int underflow;
+} bit_reader_t;
+
+static inline void put_bits(bit_writer_t *w, uint32_t value, int bits) {
+    // `bits` <= 24: cabe junto com os até 7 bits pendentes.
+    w->acc = (w->acc << bits) | (value & ((1u << bits) - 1));
+    w->acc_bits += bits;
+    while (w->acc_bits >= 8) {
+        w->acc_bits -= 8;
+        if (w->pos == w->cap) {
+            w->overflow = 1;
+            return;
+        }
+        w->buf[w->pos++] = (uint8_t)(w->acc >> w->acc_bits);
+    }
+}
+
+static inline void put_unary(bit_writer_t *w, uint32_t q) {
+    while (q >= 16) {
+        put_bits(w, 0xFFFF, 16);
+        q -= 16;
+    }
+    // q uns seguidos de um zero
+    put_bits(w, ((1u << q) - 1) << 1, (int)q + 1);
+}
+
+static inline uint32_t get_bit(bit_reader_t *r) {
+    if (r->acc_bits == 0) {
+        if (r->pos == r->len) {
+            r->underflow = 1;
+            return 0;
+        }
+        r->acc = r->buf[r->pos++];
+        r->acc_bits = 8;
+    }
+    r->acc_bits--;
+    return (r->acc >> r->acc_bits) & 1;
+}
+
+static inline uint32_t get_bits(bit_reader_t *r, int bits) {
+    uint32_t v = 0;
+    while (bits--) {
+        v = (v << 1) | get_bit(r);
+    }
+    return v;
+}
+
+static inline uint32_t zigzag(int32_t d) {
+    return ((uint32_t)d << 1) ^ (uint32_t)(d >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t u) {
+    return (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+}
+
+// Menor k com n * 2^k >= soma: aproxima log2 da média das diferenças.
+static int choose_k(const uint32_t *u, size_t n) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += u[i];
+    }
+    int k = 0;
+    while (k < 14 && ((uint32_t)n << k) < sum) {
+        k++;
+    }
+    return k;
+}
+
+size_t rice_encode(const int16_t *in, size_t n, uint8_t *out, size_t out_cap) {
+    if (n == 0 || out_cap < 2) {
+        return 0;
+    }
+    out[0] = (uint8_t)in[0];
+    out[1] = (uint8_t)((uint16_t)in[0] >> 8);
+
+    bit_writer_t w = {.buf = out, .cap = out_cap, .pos = 2};
+    uint32_t u[RICE_PARTITION];
+
+    for (size_t start = 1; start < n; start += RICE_PARTITION) {
+        size_t count = n - start < RICE_PARTITION ? n - start : RICE_PARTITION;
+        for (size_t i = 0; i < count; i++) {
+            u[i] = zigzag((int32_t)in[start + i] - in[start + i - 1]);
+        }
+
+        int k = choose_k(u, count);
+        put_bits(&w, (uint32_t)k, 4);
+        for (size_t i = 0; i < count; i++) {
+            uint32_t q = u[i] >> k;
+            if (q >= RICE_ESCAPE) {
+                put_unary(&w, RICE_ESCAPE);
+                put_bits(&w, u[i], ESCAPE_BITS);
+            } else {
+                put_unary(&w, q);
+                if (k) {
+                    put_bits(&w, u[i], k);
+                }
+            }
+        }
+        if (w.overflow) {
+            return 0;
+        }
+    }
+
+    if (w.acc_bits > 0) {
+        put_bits(&w, 0, 8 - w.acc_bits);
+    }
+    return w.overflow ? 0 : w.pos;
+}
+
+size_t rice_decode(const uint8_t *in, size_t in_len, int16_t *out, size_t n) {
+    if (n == 0 || in_len < 2) {
+        return 0;
+    }
+    out[0] = (int16_t)(in[0] | (in[1] << 8));
+
+    bit_reader_t r = {.buf = in, .len = in_len, .pos = 2};
+
+    for (size_t start = 1; start < n; start += RICE_PARTITION) {
+        size_t count = n - start < RICE_PARTITION ? n - start : RICE_PARTITION;
+        int k = (int)get_bits(&r, 4);
+        for (size_t i = 0; i < count; i++) {
+            uint32_t q = 0;
+            while (get_bit(&r) && !r.underflow) {
+                q++;
+            }
+            uint32_t u = q >= RICE_ESCAPE ? get_bits(&r, ESCAPE_BITS)
+                                          : (q << k) | get_bits(&r, k);
+            out[start + i] = (int16_t)(out[start + i - 1] + unzigzag(u));
+        }
+        if (r.underflow) {
+            return 0;
+        }
+    }
+    return n;
+}
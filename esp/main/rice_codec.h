@@ -0,0 +1,26 @@
+#pragma once
+#include <stddef.h>  // para size_t
+#include <stdint.h>
+
+/*
+ * Codec sem perdas para blocos de amostras: primeira amostra crua, depois a
+ * diferença entre amostras vizinhas (zigzag) codificada em Rice com o
+ * parâmetro k escolhido por partição de RICE_PARTITION amostras. Áudio de
+ * quarto é quase todo silêncio, então as diferenças são pequenas e cabem em
+ * poucos bits. Sem dependência do ESP-IDF.
+ *
+ * Formato: int16 little-endian (primeira amostra) + fluxo de bits MSB
+ * primeiro. Por partição: k em 4 bits e, para cada diferença, o quociente
+ * em unário (uns terminados por zero) e os k bits baixos. Um quociente igual
+ * a RICE_ESCAPE é seguido do valor zigzag cru em 17 bits.
+ */
+
+#define RICE_PARTITION 32
+#define RICE_ESCAPE 24
+
+// Codifica `n` amostras em `out`. Retorna o tamanho ou 0 se o resultado não
+// couber em `out_cap` (o chamador então envia o bloco cru).
+size_t rice_encode(const int16_t *in, size_t n, uint8_t *out, size_t out_cap);
+
+// Decodifica `n` amostras; retorna 0 se `in` estiver truncado.
+size_t rice_decode(const uint8_t *in, size_t in_len, int16_t *out, size_t n);
@@ -0,0 +1,71 @@
+#include "sample_timing.h"
+
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "packet_header.h"
+#include "sdkconfig.h"
+
+enum { HIST_INTERVAL, HIST_CALLBACK };
+
+// Com o callback fixo em um núcleo o contador de ciclos é sempre o mesmo.
+static timing_hist_t hists[2][2];
+static volatile int active;
+static uint32_t last_start;
+static bool have_last;
+static uint32_t cycles_per_us;
+static int64_t period_start_us;
+static int64_t export_period_us;
+static uint32_t export_sequence;
+
+void sample_timing_init(uint32_t export_ms) {
+    export_period_us = (int64_t)export_ms * 1000;
+    // Sem gerenciamento de energia a CPU fica na frequência padrão.
+    cycles_per_us = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+    // Baldes de 1 us: 0-255 us cobre o período de 125 us com folga.
+    for (int b = 0; b < 2; b++) {
+        timing_hist_init(&hists[b][HIST_INTERVAL], cycles_per_us);
+        timing_hist_init(&hists[b][HIST_CALLBACK], cycles_per_us);
+    }
+    period_start_us = esp_timer_get_time();
+}
+
+uint32_t IRAM_ATTR sample_timing_begin(void) {
+    uint32_t now = esp_cpu_get_cycle_count();
+    if (have_last) {
+        timing_hist_record(&hists[active][HIST_INTERVAL], now - last_start);
+    }
+    last_start = now;
+    have_last = true;
+    return now;
+}
+
+void IRAM_ATTR sample_timing_end(uint32_t start_cycles) {
+    timing_hist_record(&hists[active][HIST_CALLBACK],
+                       esp_cpu_get_cycle_count() - start_cycles);
+}
+
+bool sample_timing_collect(SensorTimingPacket *out) {
+    int64_t now = esp_timer_get_time();
+    if (now - period_start_us < export_period_us) {
+        return false;
+    }
+
+    int done = active;
+    active = !done;
+    // Espera um período de amostra para o callback em andamento (no outro
+    // núcleo) terminar de gravar no par antigo.
+    esp_rom_delay_us(2 * 1000000 / NOISE_SAMPLE_RATE_HZ);
+
+    packet_header_fill(&out->header, SENSOR_PACKET_TYPE_TIMING, 0,
+                       export_sequence++, (uint64_t)period_start_us);
+    timing_hist_summary(&hists[done][HIST_INTERVAL], cycles_per_us,
+                        &out->interval);
+    timing_hist_summary(&hists[done][HIST_CALLBACK], cycles_per_us,
+                        &out->callback);
+    timing_hist_reset(&hists[done][HIST_INTERVAL]);
+    timing_hist_reset(&hists[done][HIST_CALLBACK]);
+    period_start_us = now;
+    return true;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sensor_manager.h"
+#include "timing_hist.h"
+
+// Instrumentação do callback de amostragem (modo timer): histogramas do
+// intervalo entre amostras e da duração do callback, medidos com o contador
+// de ciclos do núcleo. O callback grava em um par de histogramas enquanto o
+// outro é exportado.
+
+typedef struct {
+    SensorPacketHeader header;
+    TimingSummary interval;  // entre inícios de callbacks consecutivos
+    TimingSummary callback;  // duração do callback
+} __attribute__((packed)) SensorTimingPacket;
+
+void sample_timing_init(uint32_t export_ms);
+// Início do callback: registra o intervalo e devolve o ciclo atual.
+uint32_t sample_timing_begin(void);
+void sample_timing_end(uint32_t start_cycles);
+// Fora do ISR. Quando o período de exportação venceu, troca os
+// histogramas, preenche `out` com o período encerrado e retorna true.
+bool sample_timing_collect(SensorTimingPacket *out);
@@ -0,0 +1,71 @@
+#include "sensor_frame.h"
+
+#include <string.h>
+
+void sensor_frame_begin(sensor_frame_t *frame, void *buf, size_t capacity,
+                        uint32_t boot_id) {
+    frame->buf = buf;
+    frame->capacity = capacity;
+    frame->len = sizeof(SensorFrameHeader);
+    frame->tail = 0;
+
+    SensorFrameHeader header = {
+        .version = SENSOR_FRAME_VERSION,
+        .boot_id = boot_id,
+    };
+    memcpy(buf, &header, sizeof(header));
+}
+
+bool sensor_frame_add(sensor_frame_t *frame, uint8_t type, const void *value,
+                      size_t len) {
+    SensorFrameHeader *header = (SensorFrameHeader *)frame->buf;
+    size_t records = header->record_count + (frame->tail != 0);
+    if (len > UINT16_MAX || records >= UINT8_MAX ||
+        frame->len + sizeof(SensorRecordHeader) + len > frame->capacity) {
+        return false;
+    }
+
+    SensorRecordHeader record = {.type = type, .length = (uint16_t)len};
+    memcpy(frame->buf + frame->len, &record, sizeof(record));
+    memcpy(frame->buf + frame->len + sizeof(record), value, len);
+    frame->len += sizeof(record) + len;
+    header->record_count++;
+    return true;
+}
+
+bool sensor_frame_add_reading(sensor_frame_t *frame,
+                              const SensorReading *reading) {
+    SensorScalarRecord scalar = {
+        .timestamp_ms = reading->timestamp,
+        .value = reading->value,
+    };
+    return sensor_frame_add(frame, reading->type, &scalar, sizeof(scalar));
+}
+
+uint8_t sensor_frame_records(const sensor_frame_t *frame) {
+    return ((const SensorFrameHeader *)frame->buf)->record_count;
+}
+
+bool sensor_frame_reserve_tail(sensor_frame_t *frame, size_t len) {
+    size_t need = sizeof(SensorRecordHeader) + len;
+    if (len > UINT16_MAX || frame->tail != 0 ||
+        frame->len + need > frame->capacity) {
+        return false;
+    }
+    frame->tail = need;
+    frame->capacity -= need;
+    return true;
+}
+
+void sensor_frame_add_tail(sensor_frame_t *frame, uint8_t type) {
+    SensorFrameHeader *header = (SensorFrameHeader *)frame->buf;
+    SensorRecordHeader record = {
+        .type = type,
+        .length = (uint16_t)(frame->tail - sizeof(record)),
+    };
+    memcpy(frame->buf + frame->len, &record, sizeof(record));
+    frame->len += sizeof(record);
+    frame->capacity += frame->tail;
+    frame->tail = 0;
+    header->record_count++;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>  // para size_t
+#include <stdint.h>
+
+#include "sensor_manager.h"
+
+/*
+ * Quadro binário multiplexado: um cabeçalho comum seguido de registros
+ * tipo/tamanho/valor, vários por mensagem WebSocket. Os tipos 1 a 15 são os
+ * SENSOR_PACKET_TYPE_* e levam o pacote inteiro (SensorPacketHeader +
+ * payload); os demais levam uma leitura escalar. Sem dependência do ESP-IDF.
+ */
+
+#define SENSOR_FRAME_VERSION 2  // pacotes avulsos têm versão 1
+
+// flags fica no mesmo deslocamento que em SensorPacketHeader, então
+// SENSOR_PACKET_FLAG_BACKFILL marca quadros e pacotes do mesmo jeito.
+typedef struct {
+    uint8_t version;       // SENSOR_FRAME_VERSION
+    uint8_t record_count;
+    uint8_t flags;         // SENSOR_PACKET_FLAG_BACKFILL vale para todos
+    uint8_t reserved;
+    uint32_t boot_id;
+} __attribute__((packed)) SensorFrameHeader;
+
+typedef struct {
+    uint8_t type;     // SENSOR_PACKET_TYPE_* ou SENSOR_RECORD_*
+    uint8_t reserved;
+    uint16_t length;  // bytes do valor, sem este cabeçalho
+} __attribute__((packed)) SensorRecordHeader;
+
+typedef struct {
+    int64_t timestamp_ms;  // UTC
+    int32_t value;
+} __attribute__((packed)) SensorScalarRecord;
+
+// Espaço para um pacote de áudio cru e 16 leituras; leituras que não
+// couberem esperam o próximo quadro.
+#define SENSOR_FRAME_MAX_BYTES                                    \
+    (sizeof(SensorFrameHeader) + sizeof(SensorRecordHeader) +     \
+     sizeof(SensorPacket) +                                       \
+     16 * (sizeof(SensorRecordHeader) + sizeof(SensorScalarRecord)))
+
+typedef struct {
+    uint8_t *buf;
+    size_t capacity;
+    size_t len;
+    size_t tail;  // reservado por sensor_frame_reserve_tail
+} sensor_frame_t;
+
+void sensor_frame_begin(sensor_frame_t *frame, void *buf, size_t capacity,
+                        uint32_t boot_id);
+// Acrescenta um registro; false (quadro intacto) se não couber.
+bool sensor_frame_add(sensor_frame_t *frame, uint8_t type, const void *value,
+                      size_t len);
+bool sensor_frame_add_reading(sensor_frame_t *frame,
+                              const SensorReading *reading);
+uint8_t sensor_frame_records(const sensor_frame_t *frame);
+
+// Registro final cujo valor não passa pelo buffer: vai logo depois do quadro
+// num envio com vários buffers. Reserve o espaço antes dos outros registros
+// e feche com sensor_frame_add_tail, que escreve só o cabeçalho. O espaço
+// reservado no buffer continua livre para juntar o valor, se preciso.
+bool sensor_frame_reserve_tail(sensor_frame_t *frame, size_t len);
+void sensor_frame_add_tail(sensor_frame_t *frame, uint8_t type);
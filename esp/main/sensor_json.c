@@ -0,0 +1,167 @@
+#include "sensor_json.h"
+
+#include <string.h>
+
+void json_writer_init(json_writer_t *w, char *buf, size_t capacity) {
+    w->buf = buf;
+    w->capacity = capacity;
+    w->len = 0;
+    w->comma = false;
+    w->overflow = capacity == 0;
+}
+
+// Reserva sempre um byte para o NUL final.
+static void put(json_writer_t *w, const char *s, size_t n) {
+    if (w->overflow || w->len + n >= w->capacity) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(w->buf + w->len, s, n);
+    w->len += n;
+}
+
+static void put_char(json_writer_t *w, char c) { put(w, &c, 1); }
+
+static void separate(json_writer_t *w) {
+    if (w->comma) {
+        put_char(w, ',');
+    }
+}
+
+void json_begin_object(json_writer_t *w) {
+    separate(w);
+    put_char(w, '{');
+    w->comma = false;
+}
+
+void json_end_object(json_writer_t *w) {
+    put_char(w, '}');
+    w->comma = true;
+}
+
+void json_begin_array(json_writer_t *w) {
+    separate(w);
+    put_char(w, '[');
+    w->comma = false;
+}
+
+void json_end_array(json_writer_t *w) {
+    put_char(w, ']');
+    w->comma = true;
+}
+
+// Escapes iguais aos do cJSON.
+static void put_quoted(json_writer_t *w, const char *s) {
+    static const char hex[] = "0123456789abcdef";
+    put_char(w, '"');
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        const char *named = NULL;
+        switch (c) {
+            case '"': named = "\\\""; break;
+            case '\\': named = "\\\\"; break;
+            case '\b': named = "\\b"; break;
+            case '\f': named = "\\f"; break;
+            case '\n': named = "\\n"; break;
+            case '\r': named = "\\r"; break;
+            case '\t': named = "\\t"; break;
+            default: break;
+        }
+        if (named) {
+            put(w, named, 2);
+        } else if (c < 0x20) {
+            char esc[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+            put(w, esc, 6);
+        } else {
+            put_char(w, (char)c);
+        }
+    }
+    put_char(w, '"');
+}
+
+void json_key(json_writer_t *w, const char *key) {
+    separate(w);
+    put_quoted(w, key);
+    put_char(w, ':');
+    w->comma = false;
+}
+
+// O cJSON imprime double com %1.15g, que dá os mesmos dígitos para inteiros
+// abaixo de 10^15 (timestamps em ms incluídos).
+void json_int(json_writer_t *w, int64_t value) {
+    char digits[20];
+    size_t n = 0;
+    // Magnitude em unsigned para INT64_MIN não estourar.
+    uint64_t v = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+    do {
+        digits[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+
+    separate(w);
+    if (value < 0) {
+        put_char(w, '-');
+    }
+    while (n) {
+        put_char(w, digits[--n]);
+    }
+    w->comma = true;
+}
+
+void json_string(json_writer_t *w, const char *value) {
+    separate(w);
+    put_quoted(w, value);
+    w->comma = true;
+}
+
+size_t json_writer_finish(json_writer_t *w) {
+    if (w->overflow) {
+        if (w->capacity) {
+            w->buf[0] = '\0';
+        }
+        return 0;
+    }
+    w->buf[w->len] = '\0';
+    return w->len;
+}
+
+size_t sensor_json_encode(const SensorReading *readings, size_t count,
+                          char *buf, size_t capacity) {
+    json_writer_t w;
+    json_writer_init(&w, buf, capacity);
+    if (count == 0) {
+        return 0;
+    }
+
+    // Mesma ordem de chaves que o cJSON produzia: data antes de type.
+    bool dht = readings[0].type == SENSOR_RECORD_TEMPERATURE;
+    json_begin_object(&w);
+    json_key(&w, "data");
+    json_begin_array(&w);
+    if (dht) {
+        for (size_t i = 0; i + 1 < count; i += 2) {
+            json_begin_object(&w);
+            json_key(&w, "temperature");
+            json_int(&w, readings[i].value);
+            json_key(&w, "humidity");
+            json_int(&w, readings[i + 1].value);
+            json_key(&w, "timestamp");
+            json_int(&w, readings[i].timestamp);
+            json_end_object(&w);
+        }
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            json_begin_object(&w);
+            json_key(&w, "sample");
+            json_int(&w, readings[i].value);
+            json_key(&w, "timestamp");
+            json_int(&w, readings[i].timestamp);
+            json_end_object(&w);
+        }
+    }
+    json_end_array(&w);
+    json_key(&w, "type");
+    json_string(&w, dht ? "dht" : readings[0].name);
+    json_end_object(&w);
+    return json_writer_finish(&w);
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>  // para size_t
+#include <stdint.h>
+
+#include "sensor_manager.h"
+
+/*
+ * Escritor JSON sem alocação: escreve direto num buffer do chamador. Usado
+ * pelo protocolo JSON no lugar do cJSON, com a mesma saída que
+ * cJSON_PrintUnformatted. Sem dependência do ESP-IDF.
+ */
+
+// Pior caso de uma leitura no lote, com a vírgula:
+// {"sample":-2147483648,"timestamp":-9223372036854775808}. Um par do DHT
+// ocupa até 84 bytes, 42 por leitura.
+#define SENSOR_JSON_READING_MAX_BYTES 56
+// Nome do sensor em "type", já escapado; nomes maiores não cabem.
+#define SENSOR_JSON_NAME_MAX 16
+// Buffer para um lote de até `readings` leituras: {"data":[...],"type":""}
+// e o NUL somam 22 bytes além das leituras e do nome.
+#define SENSOR_JSON_MAX_BYTES(readings) \
+    (22 + SENSOR_JSON_NAME_MAX + (readings) * SENSOR_JSON_READING_MAX_BYTES)
+
+typedef struct {
+    char *buf;
+    size_t capacity;
+    size_t len;
+    bool comma;     // o próximo valor/chave precisa de vírgula
+    bool overflow;  // algo não coube; o conteúdo não vale
+} json_writer_t;
+
+void json_writer_init(json_writer_t *w, char *buf, size_t capacity);
+void json_begin_object(json_writer_t *w);
+void json_end_object(json_writer_t *w);
+void json_begin_array(json_writer_t *w);
+void json_end_array(json_writer_t *w);
+void json_key(json_writer_t *w, const char *key);
+void json_int(json_writer_t *w, int64_t value);
+void json_string(json_writer_t *w, const char *value);
+// Termina a string com NUL; retorna o tamanho ou 0 se não coube.
+size_t json_writer_finish(json_writer_t *w);
+
+// {"data":[...],"type":...} para um lote de leituras do mesmo sensor. Pares
+// temperatura/umidade viram entradas "dht". Retorna o tamanho escrito em
+// `buf` (terminado em NUL) ou 0 se não coube.
+size_t sensor_json_encode(const SensorReading *readings, size_t count,
+                          char *buf, size_t capacity);
@@ -3,16 +3,37 @@
 #include <sys/time.h>
 
 #include "dht.h"
+#include "dht_rmt.h"
 #include "esp_adc/adc_oneshot.h"
+#include "esp_attr.h"
 #include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+
+#if CONFIG_MIC_CAPTURE_CONTINUOUS
+#include "mic_adc_continuous.h"
+#include "mic_capture.h"
+#endif
 
 #define LDR_SENSOR_PIN ADC_CHANNEL_4    // GPIO32
 #define DHT_SENSOR_PIN GPIO_NUM_33  // GPIO33
 #define NOISE_SENSOR_PIN ADC_CHANNEL_6  // GPIO34
 
+#if CONFIG_MIC_CAPTURE_CONTINUOUS
+static mic_adc_hal_t mic_hal;
+static mic_assembler_t mic_assembler;
+static uint8_t mic_frame[MIC_ADC_FRAME_BYTES];
+#else
 static adc_oneshot_unit_handle_t adc_handle;
+#endif
 
 void sensor_manager_init(void) {
+#if CONFIG_DHT_BACKEND_RMT
+    dht_rmt_init(DHT_SENSOR_PIN, true);
+#endif
+#if CONFIG_MIC_CAPTURE_CONTINUOUS
+    // O ADC é criado pela task de captura (ver abaixo).
+#else
     adc_oneshot_unit_init_cfg_t init_config = {
         .unit_id = ADC_UNIT_1,
     };
@@ -22,9 +43,24 @@ void sensor_manager_init(void) {
         .bitwidth = ADC_BITWIDTH_DEFAULT,
         .atten = ADC_ATTEN_DB_12,
     };
-    adc_oneshot_config_channel(adc_handle, ADC_CHANNEL_4,
+    adc_oneshot_config_channel(adc_handle, LDR_SENSOR_PIN,
                                &config);  // Ex: GPIO32
+    adc_oneshot_config_channel(adc_handle, NOISE_SENSOR_PIN, &config);
+#endif
+}
+
+#if CONFIG_MIC_CAPTURE_CONTINUOUS
+void sensor_manager_run_noise_capture(mic_block_cb_t on_block, void *arg) {
+    // Criado aqui para a interrupção do DMA ficar no núcleo da captura. O
+    // ADC1 inteiro fica com o DMA; o LDR é amostrado no mesmo padrão.
+    mic_adc_continuous_init(NOISE_SENSOR_PIN, LDR_SENSOR_PIN,
+                            NOISE_SAMPLE_RATE_HZ, CONFIG_MIC_ADC_OVERSAMPLING,
+                            &mic_hal);
+    mic_assembler_init(&mic_assembler, NOISE_SENSOR_PIN, LDR_SENSOR_PIN,
+                       CONFIG_MIC_ADC_OVERSAMPLING, on_block, arg);
+    mic_capture_run(&mic_hal, &mic_assembler, mic_frame, sizeof(mic_frame));
 }
+#endif
 
 /* void read_all_sensors(SensorReading *buffer, size_t *count) {
     struct timeval tv;
@@ -56,16 +92,25 @@ para LDR (ajuste o canal conforme o pino) buffer[index++] = (SensorReading){
     *count = index;
 } */
 
-void read_noise(SensorReading *buffer) {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    int64_t timestamp = ((int64_t)tv.tv_sec) * 1000 + tv.tv_usec / 1000;
+#if CONFIG_MIC_TIMER_ISR_DISPATCH
+// adc_oneshot_read_isr não tem trava própria: o LDR e o microfone dividem o
+// ADC1, então as duas leituras passam por este spinlock.
+static portMUX_TYPE adc_lock = portMUX_INITIALIZER_UNLOCKED;
+#endif
 
+#if !CONFIG_MIC_CAPTURE_CONTINUOUS
+int IRAM_ATTR read_noise(void) {
     int noise_raw = 0;
-    adc_oneshot_read(adc_handle, NOISE_SENSOR_PIN, &noise_raw);  // ADC_CHANNEL_4
-    buffer[0] = (SensorReading){.name = "microphone", .value = noise_raw,
-                                .timestamp = timestamp};
+#if CONFIG_MIC_TIMER_ISR_DISPATCH
+    portENTER_CRITICAL_ISR(&adc_lock);
+    adc_oneshot_read_isr(adc_handle, NOISE_SENSOR_PIN, &noise_raw);
+    portEXIT_CRITICAL_ISR(&adc_lock);
+#else
+    adc_oneshot_read(adc_handle, NOISE_SENSOR_PIN, &noise_raw);  // ADC_CHANNEL_6
+#endif
+    return noise_raw;
 }
+#endif
 
 void read_ldr(SensorReading *buffer) {
     struct timeval tv;
@@ -73,23 +118,43 @@ void read_ldr(SensorReading *buffer) {
     int64_t timestamp = ((int64_t)tv.tv_sec) * 1000 + tv.tv_usec / 1000;
 
     int ldr_raw = 0;
+#if CONFIG_MIC_CAPTURE_CONTINUOUS
+    ldr_raw = mic_assembler.aux_last;
+#elif CONFIG_MIC_TIMER_ISR_DISPATCH
+    portENTER_CRITICAL(&adc_lock);
+    adc_oneshot_read_isr(adc_handle, LDR_SENSOR_PIN, &ldr_raw);
+    portEXIT_CRITICAL(&adc_lock);
+#else
     adc_oneshot_read(adc_handle, LDR_SENSOR_PIN, &ldr_raw);  // ADC_CHANNEL_5
-    buffer[0] = (SensorReading){.name = "luminosity", .value = ldr_raw,
+#endif
+    buffer[0] = (SensorReading){.type = SENSOR_RECORD_LUMINOSITY,
+                                .name = "luminosity",
+                                .value = ldr_raw,
                                 .timestamp = timestamp};
 }
 
-void read_dht(SensorReading *buffer) {
+size_t read_dht(SensorReading *buffer) {
     struct timeval tv;
     gettimeofday(&tv, NULL);
     int64_t timestamp = ((int64_t)tv.tv_sec) * 1000 + tv.tv_usec / 1000;
 
-    float temp, hum;
-    if (dht_read_float_data(DHT_TYPE_DHT11, DHT_SENSOR_PIN, &hum, &temp) == ESP_OK) {
-        buffer[0] = (SensorReading){.name = "temperature",
-                                    .value = (int)(temp * 10),
-                                    .timestamp = timestamp};
-        buffer[1] = (SensorReading){.name = "humidity",
-                                    .value = (int)(hum * 10),
-                                    .timestamp = timestamp};
+    int16_t temp, hum;
+#if CONFIG_DHT_BACKEND_RMT
+    esp_err_t err = dht_rmt_read(&hum, &temp);
+#else
+    // Desabilita interrupções por ~25 ms: abre buracos no áudio.
+    esp_err_t err = dht_read_data(DHT_TYPE_DHT11, DHT_SENSOR_PIN, &hum, &temp);
+#endif
+    if (err != ESP_OK) {
+        return 0;
     }
+    buffer[0] = (SensorReading){.type = SENSOR_RECORD_TEMPERATURE,
+                                .name = "temperature",
+                                .value = temp,
+                                .timestamp = timestamp};
+    buffer[1] = (SensorReading){.type = SENSOR_RECORD_HUMIDITY,
+                                .name = "humidity",
+                                .value = hum,
+                                .timestamp = timestamp};
+    return 2;
 }
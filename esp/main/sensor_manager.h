@@ -3,20 +3,77 @@
 #include <stdint.h>  // para int64_t
 
 #define NOISE_SAMPLES_PER_PACKET 500
+#define NOISE_SAMPLE_RATE_HZ 8000
+// Blocos inteiros de áudio em `ms` milissegundos.
+#define NOISE_BLOCKS_FOR_MS(ms) \
+    ((ms) * NOISE_SAMPLE_RATE_HZ / (1000 * NOISE_SAMPLES_PER_PACKET))
 
 typedef struct {
-    const char *name;
+    uint8_t type;      // SENSOR_RECORD_*
+    const char *name;  // nome no protocolo JSON
     int value;
     int64_t timestamp;
 } SensorReading;
 
+#define SENSOR_PACKET_VERSION 1
+#define SENSOR_PACKET_TYPE_AUDIO 1
+#define SENSOR_PACKET_TYPE_FEATURES 2  // payload AudioFeatures
+#define SENSOR_PACKET_TYPE_HEARTBEAT 3  // payload NoiseGateStats
+#define SENSOR_PACKET_TYPE_TIMING 4     // payload 2 x TimingSummary
+#define SENSOR_PACKET_TYPE_TELEMETRY 5  // payload TelemetryStats
+
+// Registros escalares do quadro multiplexado (sensor_frame.h).
+#define SENSOR_RECORD_LUMINOSITY 16   // valor cru do ADC
+#define SENSOR_RECORD_TEMPERATURE 17  // décimos de °C
+#define SENSOR_RECORD_HUMIDITY 18     // décimos de %
+
+// Bits baixos de header.flags: codec do payload de áudio.
+#define SENSOR_PACKET_CODEC_MASK 0x0F
+#define SENSOR_CODEC_RAW 0
+#define SENSOR_CODEC_ADPCM 1  // IMA-ADPCM, 4 bits por amostra
+#define SENSOR_CODEC_RICE 2   // delta + Rice adaptativo, sem perdas
+// Primeiro bloco de um evento no modo com portão (pré-gravação incluída):
+// o buraco de sequência antes dele é esperado.
+#define SENSOR_PACKET_FLAG_EVENT_START 0x10
+// Reenviado pelo spool depois de uma queda da conexão.
+#define SENSOR_PACKET_FLAG_BACKFILL 0x20
+
+// Cabeçalho binário (little-endian) dos pacotes enviados ao servidor. Os
+// tempos vêm do esp_timer (monotônico desde o boot); o servidor soma
+// epoch_offset_us para obter o horário UTC de cada amostra.
 typedef struct {
-    uint32_t timestamp;     // apenas o timestamp da primeira amostra
-    int16_t samples[NOISE_SAMPLES_PER_PACKET];     // 40 amostras de 16 bits
+    uint8_t version;           // SENSOR_PACKET_VERSION
+    uint8_t type;              // SENSOR_PACKET_TYPE_*
+    uint8_t flags;             // SENSOR_PACKET_CODEC_MASK: codec; FLAG_*
+    uint8_t quality;           // quality_level_t em uso; 0 = completo
+    uint16_t sample_count;
+    uint16_t sample_rate_hz;
+    uint32_t boot_id;          // aleatório, muda a cada boot
+    uint32_t sequence;         // número do bloco no boot; buracos = perdas
+    uint64_t capture_time_us;  // instante da primeira amostra
+    int64_t epoch_offset_us;   // UTC - monotônico; 0 sem NTP
+} __attribute__((packed)) SensorPacketHeader;
+
+typedef struct {
+    SensorPacketHeader header;
+    int16_t samples[NOISE_SAMPLES_PER_PACKET];     // amostras de 16 bits
 } __attribute__((packed)) SensorPacket;
 
+// Ponteiro alinhado para as amostras. Os buffers do pool são alinhados e o
+// cabeçalho tem 32 bytes, então o struct empacotado não desalinha o vetor.
+static inline int16_t *sensor_packet_samples(SensorPacket *packet) {
+    return (int16_t *)(void *)((uint8_t *)packet + sizeof(SensorPacketHeader));
+}
+
 void sensor_manager_init(void);
 // void read_all_sensors(SensorReading *buffer, size_t *count);
-void read_noise(SensorReading *buffer);
+// Leitura crua do microfone, sem timestamp: chamada a cada amostra.
+int read_noise(void);
+// Modo contínuo: laço de captura por DMA (corpo de uma task). `on_block`
+// recebe cada SensorPacket completo.
+void sensor_manager_run_noise_capture(
+    void (*on_block)(SensorPacket *packet, void *arg), void *arg);
 void read_ldr(SensorReading *buffer);
-void read_dht(SensorReading *buffer);
+// Preenche temperatura e umidade; retorna quantas leituras saíram (0 se o
+// sensor não respondeu).
+size_t read_dht(SensorReading *buffer);
@@ -0,0 +1,287 @@
+#include "spool.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include "sensor_frame.h"
+#include "sensor_manager.h"
+#include "spool_log.h"
+
+#define SPOOL_PARTITION "spool"
+#define SPOOL_SECTOR_SIZE 4096
+#define SPOOL_RECORD_MAX (1 + SENSOR_FRAME_MAX_BYTES)
+#define SPOOL_TEXT_TAG "{\"backfill\":true,"
+
+static const char *TAG = "spool";
+
+// Protege o log da RAM e `generation`. O log da flash é só da task de
+// reenvio, que grava nele fora do mutex: quem guarda um quadro nunca espera
+// por um apagamento de setor.
+static SemaphoreHandle_t spool_mutex;
+static spool_flash_t ram_flash;
+static spool_flash_t part_flash;
+static spool_log_t ram_log;
+static spool_log_t flash_log;
+static bool have_flash;
+// Muda quando registros da RAM são descartados para dar lugar a novos: o
+// registro lido pela task de reenvio pode ter saído do lugar.
+static uint32_t generation;
+// Quadros recusados com a RAM cheia porque a flash não acompanhou.
+static uint32_t put_dropped;
+static spool_config_t spool_config;
+static spool_send_fn send_frame;
+static TaskHandle_t drain_task_handle;
+
+// --- HAL em RAM: apagar é preencher com 0xFF ---
+static int ram_read(void *ctx, uint32_t off, void *buf, size_t len) {
+    memcpy(buf, (uint8_t *)ctx + off, len);
+    return 0;
+}
+
+static int ram_write(void *ctx, uint32_t off, const void *buf, size_t len) {
+    memcpy((uint8_t *)ctx + off, buf, len);
+    return 0;
+}
+
+static int ram_erase(void *ctx, uint32_t off, size_t len) {
+    memset((uint8_t *)ctx + off, 0xFF, len);
+    return 0;
+}
+
+// --- HAL sobre a partição "spool" ---
+static int part_read(void *ctx, uint32_t off, void *buf, size_t len) {
+    return esp_partition_read(ctx, off, buf, len) == ESP_OK ? 0 : -1;
+}
+
+static int part_write(void *ctx, uint32_t off, const void *buf, size_t len) {
+    return esp_partition_write(ctx, off, buf, len) == ESP_OK ? 0 : -1;
+}
+
+static int part_erase(void *ctx, uint32_t off, size_t len) {
+    return esp_partition_erase_range(ctx, off, len) == ESP_OK ? 0 : -1;
+}
+
+static bool init_ram_log(void) {
+    size_t size = spool_config.ram_bytes;
+    void *mem = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (mem == NULL) {
+        mem = heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (mem == NULL) {
+        ESP_LOGE(TAG, "Sem memória para o spool em RAM");
+        return false;
+    }
+    ram_flash = (spool_flash_t){
+        .read = ram_read,
+        .write = ram_write,
+        .erase = ram_erase,
+        .size = size - size % SPOOL_SECTOR_SIZE,
+        .sector_size = SPOOL_SECTOR_SIZE,
+        .ctx = mem,
+    };
+    ram_erase(mem, 0, ram_flash.size);
+    // Sem flash, a RAM é a última camada e descarta os mais antigos.
+    return spool_log_open(&ram_log, &ram_flash, !have_flash) == SPOOL_LOG_OK;
+}
+
+static void init_flash_log(void) {
+    const esp_partition_t *part = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, SPOOL_PARTITION);
+    if (part == NULL) {
+        ESP_LOGW(TAG, "Partição \"%s\" ausente: spool só em RAM",
+                 SPOOL_PARTITION);
+        return;
+    }
+    part_flash = (spool_flash_t){
+        .read = part_read,
+        .write = part_write,
+        .erase = part_erase,
+        .size = part->size - part->size % SPOOL_SECTOR_SIZE,
+        .sector_size = SPOOL_SECTOR_SIZE,
+        .ctx = (void *)part,
+    };
+    // O log da flash sobrevive ao reboot: o que sobrou da última vez é
+    // reenviado.
+    have_flash = spool_log_open(&flash_log, &part_flash, true) == SPOOL_LOG_OK;
+    if (have_flash) {
+        ESP_LOGI(TAG, "Spool na flash: %lu kB, %lu quadros pendentes",
+                 (unsigned long)(part_flash.size / 1024),
+                 (unsigned long)spool_log_pending(&flash_log));
+    }
+}
+
+void spool_put(spool_kind_t kind, const void *data, size_t len) {
+    static uint8_t record[SPOOL_RECORD_MAX];
+    if (send_frame == NULL || len + 1 > sizeof(record)) {
+        return;
+    }
+
+    xSemaphoreTake(spool_mutex, portMAX_DELAY);
+    record[0] = (uint8_t)kind;
+    memcpy(record + 1, data, len);
+    // Com flash a RAM não sobrescreve: cheia, o quadro novo é perdido e a
+    // task de reenvio, acordada abaixo, abre espaço.
+    uint32_t dropped = ram_log.stats.dropped;
+    if (spool_log_append(&ram_log, record, len + 1) == SPOOL_LOG_FULL) {
+        put_dropped++;
+    }
+    if (ram_log.stats.dropped != dropped) {
+        generation++;
+    }
+    xSemaphoreGive(spool_mutex);
+
+    xTaskNotifyGive(drain_task_handle);
+}
+
+uint32_t spool_pending(void) {
+    if (spool_mutex == NULL) {
+        return 0;
+    }
+    xSemaphoreTake(spool_mutex, portMAX_DELAY);
+    uint32_t n = spool_log_pending(&ram_log);
+    xSemaphoreGive(spool_mutex);
+    // Uma palavra, escrita só pela task de reenvio.
+    return n + (have_flash ? spool_log_pending(&flash_log) : 0);
+}
+
+// Passa os registros mais antigos da RAM para a flash enquanto a RAM estiver
+// mais da metade ocupada, deixando a outra metade para os quadros que
+// chegam durante a próxima gravação. Só roda na task de reenvio.
+static void migrate_to_flash(void) {
+    static uint8_t moving[SPOOL_RECORD_MAX];
+    static uint32_t reported_drops;
+    size_t len;
+    while (have_flash) {
+        xSemaphoreTake(spool_mutex, portMAX_DELAY);
+        spool_log_result_t r =
+            spool_log_used_sectors(&ram_log) > ram_log.sectors / 2
+                ? spool_log_peek(&ram_log, moving, sizeof(moving), &len)
+                : SPOOL_LOG_EMPTY;
+        uint32_t drops = put_dropped;
+        xSemaphoreGive(spool_mutex);
+        if (drops != reported_drops) {
+            ESP_LOGW(TAG, "%lu quadros perdidos: RAM cheia antes da flash",
+                     (unsigned long)(drops - reported_drops));
+            reported_drops = drops;
+        }
+        if (r != SPOOL_LOG_OK) {
+            return;
+        }
+
+        spool_log_append(&flash_log, moving, len);
+
+        // Sem sobrescrita na RAM o mais antigo continua sendo o lido.
+        xSemaphoreTake(spool_mutex, portMAX_DELAY);
+        spool_log_consume(&ram_log);
+        xSemaphoreGive(spool_mutex);
+    }
+}
+
+// Marca o quadro como reenviado sem mexer no registro guardado.
+static size_t tag_backfill(uint8_t *frame, size_t len, uint8_t *out) {
+    if (frame[0] == SPOOL_KIND_BINARY) {
+        // Quadros e pacotes avulsos têm flags no mesmo deslocamento.
+        memcpy(out, frame + 1, len - 1);
+        if (len - 1 >= sizeof(SensorFrameHeader)) {
+            out[offsetof(SensorFrameHeader, flags)] |=
+                SENSOR_PACKET_FLAG_BACKFILL;
+        }
+        return len - 1;
+    }
+    // JSON: {"backfill":true,...} no lugar de {...}
+    size_t tag = strlen(SPOOL_TEXT_TAG);
+    if (len < 3 || frame[1] != '{') {
+        memcpy(out, frame + 1, len - 1);
+        return len - 1;
+    }
+    memcpy(out, SPOOL_TEXT_TAG, tag);
+    memcpy(out + tag, frame + 2, len - 2);
+    return tag + len - 2;
+}
+
+static void drain_task(void *arg) {
+    static uint8_t frame[SPOOL_RECORD_MAX];
+    static uint8_t out[SPOOL_RECORD_MAX + sizeof(SPOOL_TEXT_TAG)];
+    const int64_t rate = spool_config.drain_bytes_per_s;
+    int64_t tokens = rate;  // balde de 1 s
+    int64_t last_us = esp_timer_get_time();
+
+    while (1) {
+        migrate_to_flash();
+        if (spool_pending() == 0) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            last_us = esp_timer_get_time();
+            continue;
+        }
+
+        // A flash guarda os mais antigos.
+        spool_log_t *log = have_flash && spool_log_pending(&flash_log) > 0
+                               ? &flash_log
+                               : &ram_log;
+        xSemaphoreTake(spool_mutex, portMAX_DELAY);
+        uint32_t peeked_generation = generation;
+        size_t len = 0;
+        spool_log_result_t r = spool_log_peek(log, frame, sizeof(frame), &len);
+        if (r == SPOOL_LOG_OK && len < 2) {
+            spool_log_consume(log);  // registro sem conteúdo
+        }
+        xSemaphoreGive(spool_mutex);
+        if (r != SPOOL_LOG_OK || len < 2) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+            continue;
+        }
+
+        // Limite de taxa: espera juntar bytes suficientes no balde.
+        int64_t now = esp_timer_get_time();
+        tokens += (now - last_us) * rate / 1000000;
+        if (tokens > rate) {
+            tokens = rate;
+        }
+        last_us = now;
+        // As esperas acordam com spool_put para a RAM migrar a tempo.
+        if (tokens < (int64_t)len) {
+            ulTaskNotifyTake(pdTRUE,
+                             pdMS_TO_TICKS((len - tokens) * 1000 / rate) + 1);
+            continue;
+        }
+
+        size_t out_len = tag_backfill(frame, len, out);
+        if (!send_frame((spool_kind_t)frame[0], out, out_len)) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));  // offline
+            continue;
+        }
+        tokens -= (int64_t)len;
+
+        xSemaphoreTake(spool_mutex, portMAX_DELAY);
+        // Se o registro mudou de lugar durante o envio, o que está na posição
+        // de leitura é outro: não consome (no pior caso, uma duplicata).
+        if (peeked_generation == generation) {
+            spool_log_consume(log);
+        }
+        xSemaphoreGive(spool_mutex);
+    }
+}
+
+void spool_start(const spool_config_t *config, spool_send_fn send) {
+    spool_config = *config;
+    spool_mutex = xSemaphoreCreateMutex();
+    init_flash_log();
+    if (!init_ram_log()) {
+        return;
+    }
+    send_frame = send;
+    xTaskCreatePinnedToCore(drain_task, "Spool Drain", 4096, NULL,
+                            spool_config.drain_priority,
+                            &drain_task_handle, CONFIG_NETWORK_CORE);
+    if (spool_pending() > 0) {
+        xTaskNotifyGive(drain_task_handle);
+    }
+}
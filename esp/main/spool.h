@@ -0,0 +1,30 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>  // para size_t
+#include <stdint.h>
+
+// Store-and-forward: quadros que não puderam ser enviados vão para um log
+// em RAM (PSRAM se houver) e, quando ele enche, para um log circular na
+// partição "spool" da flash. Uma task reenvia os quadros, do mais antigo
+// para o mais novo, com taxa limitada para não disputar com o tráfego ao
+// vivo. Pacotes binários reenviados levam SENSOR_PACKET_FLAG_BACKFILL; os
+// JSON ganham "backfill": true.
+
+typedef enum {
+    SPOOL_KIND_BINARY = 1,
+    SPOOL_KIND_TEXT = 2,
+} spool_kind_t;
+
+// Envia um quadro do spool sem voltar a guardá-lo; false se não saiu.
+typedef bool (*spool_send_fn)(spool_kind_t kind, const void *data, size_t len);
+
+typedef struct {
+    uint32_t ram_bytes;         // estágio em RAM
+    uint32_t drain_bytes_per_s;
+    uint8_t drain_priority;
+} spool_config_t;
+
+void spool_start(const spool_config_t *config, spool_send_fn send);
+// Guarda uma cópia do quadro. Pode ser chamada de várias tasks.
+void spool_put(spool_kind_t kind, const void *data, size_t len);
+uint32_t spool_pending(void);
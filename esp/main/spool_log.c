@@ -0,0 +1,337 @@
+#include "spool_log.h"
+
+#include <string.h>
+
+#define SECTOR_MAGIC 0x314C5053u  // "SPL1"
+#define RECORD_MAGIC 0xA5
+#define STATE_LIVE 0xFF
+#define STATE_CONSUMED 0x00
+#define ERASED_U32 0xFFFFFFFFu
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+} __attribute__((packed)) sector_header_t;
+
+typedef struct {
+    uint8_t magic;
+    uint8_t state;
+    uint16_t len;
+    uint32_t crc;
+} __attribute__((packed)) record_header_t;
+
+#define SECTOR_DATA ((uint32_t)sizeof(sector_header_t))
+#define RECORD_SIZE(len) \
+    ((uint32_t)sizeof(record_header_t) + (((uint32_t)(len) + 3u) & ~3u))
+
+static uint32_t crc32(const uint8_t *data, size_t len, uint32_t crc) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+        0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+static uint32_t sector_base(const spool_log_t *log, uint32_t sector) {
+    return sector * log->flash->sector_size;
+}
+
+static uint32_t next_sector(const spool_log_t *log, uint32_t sector) {
+    return (sector + 1) % log->sectors;
+}
+
+static int flash_read(const spool_log_t *log, uint32_t offset, void *buf,
+                      size_t len) {
+    return log->flash->read(log->flash->ctx, offset, buf, len);
+}
+
+static int flash_write(const spool_log_t *log, uint32_t offset,
+                       const void *buf, size_t len) {
+    return log->flash->write(log->flash->ctx, offset, buf, len);
+}
+
+// Lê o cabeçalho do registro em `off`. Retorna false no fim dos dados do
+// setor (área apagada, lixo ou registro que passaria do setor).
+static bool read_record_header(const spool_log_t *log, uint32_t sector,
+                               uint32_t off, record_header_t *rec) {
+    if (off + sizeof(*rec) > log->flash->sector_size) {
+        return false;
+    }
+    if (flash_read(log, sector_base(log, sector) + off, rec, sizeof(*rec)) !=
+        0) {
+        return false;
+    }
+    return rec->magic == RECORD_MAGIC &&
+           off + RECORD_SIZE(rec->len) <= log->flash->sector_size;
+}
+
+static bool is_erased(const spool_log_t *log, uint32_t sector, uint32_t off) {
+    uint8_t buf[sizeof(record_header_t)];
+    uint32_t len = log->flash->sector_size - off;
+    if (len > sizeof(buf)) {
+        len = sizeof(buf);
+    }
+    if (len == 0) {
+        return true;
+    }
+    if (flash_read(log, sector_base(log, sector) + off, buf, len) != 0) {
+        return false;
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        if (buf[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Percorre os registros do setor a partir de `off`. Retorna o fim dos dados
+// e, se `live` não for NULL, quantos registros ainda não foram consumidos.
+static uint32_t scan_sector(const spool_log_t *log, uint32_t sector,
+                            uint32_t off, uint32_t *live) {
+    record_header_t rec;
+    uint32_t count = 0;
+    while (read_record_header(log, sector, off, &rec)) {
+        if (rec.state == STATE_LIVE) {
+            count++;
+        }
+        off += RECORD_SIZE(rec.len);
+    }
+    if (live) {
+        *live = count;
+    }
+    return off;
+}
+
+static spool_log_result_t open_sector(spool_log_t *log, uint32_t sector) {
+    if (log->flash->erase(log->flash->ctx, sector_base(log, sector),
+                          log->flash->sector_size) != 0) {
+        return SPOOL_LOG_IO;
+    }
+    sector_header_t header = {.magic = SECTOR_MAGIC, .seq = ++log->head_seq};
+    if (flash_write(log, sector_base(log, sector), &header, sizeof(header)) !=
+        0) {
+        return SPOOL_LOG_IO;
+    }
+    log->head_sector = sector;
+    log->head_off = SECTOR_DATA;
+    return SPOOL_LOG_OK;
+}
+
+spool_log_result_t spool_log_open(spool_log_t *log, const spool_flash_t *flash,
+                                  bool overwrite) {
+    memset(log, 0, sizeof(*log));
+    log->flash = flash;
+    log->overwrite = overwrite;
+    log->sectors = flash->size / flash->sector_size;
+    if (log->sectors < 2) {
+        return SPOOL_LOG_IO;
+    }
+
+    // Setores com cabeçalho válido: o de menor seq é o mais antigo, o de
+    // maior seq recebe as escritas.
+    bool found = false;
+    uint32_t oldest = 0, newest = 0, min_seq = 0, max_seq = 0;
+    for (uint32_t s = 0; s < log->sectors; s++) {
+        sector_header_t header;
+        if (flash_read(log, sector_base(log, s), &header, sizeof(header)) !=
+            0) {
+            return SPOOL_LOG_IO;
+        }
+        if (header.magic != SECTOR_MAGIC || header.seq == ERASED_U32) {
+            continue;
+        }
+        if (!found || header.seq < min_seq) {
+            min_seq = header.seq;
+            oldest = s;
+        }
+        if (!found || header.seq > max_seq) {
+            max_seq = header.seq;
+            newest = s;
+        }
+        found = true;
+    }
+
+    if (!found) {
+        spool_log_result_t r = open_sector(log, 0);
+        log->tail_sector = log->head_sector;
+        log->tail_off = log->head_off;
+        return r;
+    }
+
+    log->head_seq = max_seq;
+    log->head_sector = newest;
+    log->head_off = scan_sector(log, newest, SECTOR_DATA, NULL);
+    if (!is_erased(log, newest, log->head_off)) {
+        // Escrita interrompida: o resto do setor não está apagado, então as
+        // próximas escritas vão para um setor novo.
+        log->head_off = flash->sector_size;
+    }
+
+    // Conta os pendentes e posiciona a leitura no primeiro não consumido.
+    log->tail_sector = log->head_sector;
+    log->tail_off = log->head_off;
+    bool tail_set = false;
+    for (uint32_t s = oldest;; s = next_sector(log, s)) {
+        record_header_t rec;
+        uint32_t off = SECTOR_DATA;
+        uint32_t end = s == newest ? log->head_off : flash->sector_size;
+        while (off < end && read_record_header(log, s, off, &rec)) {
+            if (rec.state == STATE_LIVE) {
+                if (!tail_set) {
+                    log->tail_sector = s;
+                    log->tail_off = off;
+                    tail_set = true;
+                }
+                log->pending++;
+            }
+            off += RECORD_SIZE(rec.len);
+        }
+        if (s == newest) {
+            break;
+        }
+    }
+    return SPOOL_LOG_OK;
+}
+
+// Apaga o setor mais antigo para dar lugar à escrita. Os registros não lidos
+// dele são perdidos.
+static void drop_tail_sector(spool_log_t *log) {
+    uint32_t live;
+    scan_sector(log, log->tail_sector, log->tail_off, &live);
+    log->stats.dropped += live;
+    log->pending -= live;
+    log->tail_sector = next_sector(log, log->tail_sector);
+    log->tail_off = SECTOR_DATA;
+}
+
+spool_log_result_t spool_log_append(spool_log_t *log, const void *data,
+                                    size_t len) {
+    uint32_t size = RECORD_SIZE(len);
+    if (len > UINT16_MAX || size > log->flash->sector_size - SECTOR_DATA) {
+        return SPOOL_LOG_TOO_BIG;
+    }
+
+    if (log->head_off + size > log->flash->sector_size) {
+        uint32_t next = next_sector(log, log->head_sector);
+        bool was_empty = log->pending == 0;
+        if (next == log->tail_sector && !was_empty) {
+            if (!log->overwrite) {
+                return SPOOL_LOG_FULL;
+            }
+            drop_tail_sector(log);
+        }
+        spool_log_result_t r = open_sector(log, next);
+        if (r != SPOOL_LOG_OK) {
+            return r;
+        }
+        if (was_empty || log->pending == 0) {
+            log->tail_sector = log->head_sector;
+            log->tail_off = log->head_off;
+        }
+    }
+
+    // Cabeçalho antes dos dados: um corte no meio deixa um registro com CRC
+    // inválido, que é pulado, em vez de dados sem cabeçalho.
+    record_header_t rec = {
+        .magic = RECORD_MAGIC,
+        .state = STATE_LIVE,
+        .len = (uint16_t)len,
+        .crc = crc32(data, len, 0),
+    };
+    uint32_t base = sector_base(log, log->head_sector) + log->head_off;
+    if (flash_write(log, base, &rec, sizeof(rec)) != 0 ||
+        (len > 0 && flash_write(log, base + sizeof(rec), data, len) != 0)) {
+        log->head_off = log->flash->sector_size;  // setor selado
+        return SPOOL_LOG_IO;
+    }
+    log->head_off += size;
+    log->pending++;
+    log->stats.appended++;
+    return SPOOL_LOG_OK;
+}
+
+static bool at_head(const spool_log_t *log) {
+    return log->tail_sector == log->head_sector &&
+           log->tail_off >= log->head_off;
+}
+
+spool_log_result_t spool_log_peek(spool_log_t *log, void *buf, size_t cap,
+                                  size_t *len) {
+    while (!at_head(log)) {
+        record_header_t rec;
+        if (!read_record_header(log, log->tail_sector, log->tail_off, &rec)) {
+            if (log->tail_sector == log->head_sector) {
+                log->tail_off = log->head_off;
+                break;
+            }
+            log->tail_sector = next_sector(log, log->tail_sector);
+            log->tail_off = SECTOR_DATA;
+            continue;
+        }
+        if (rec.state != STATE_LIVE) {
+            log->tail_off += RECORD_SIZE(rec.len);
+            continue;
+        }
+
+        uint32_t base = sector_base(log, log->tail_sector) + log->tail_off +
+                        sizeof(rec);
+        if (rec.len > cap) {
+            return SPOOL_LOG_TOO_BIG;
+        }
+        if (flash_read(log, base, buf, rec.len) != 0) {
+            return SPOOL_LOG_IO;
+        }
+        if (crc32(buf, rec.len, 0) != rec.crc) {
+            // Registro cortado: marca como consumido e segue.
+            log->stats.corrupt++;
+            spool_log_consume(log);
+            continue;
+        }
+        *len = rec.len;
+        return SPOOL_LOG_OK;
+    }
+    return SPOOL_LOG_EMPTY;
+}
+
+spool_log_result_t spool_log_consume(spool_log_t *log) {
+    record_header_t rec;
+    if (at_head(log) ||
+        !read_record_header(log, log->tail_sector, log->tail_off, &rec)) {
+        return SPOOL_LOG_EMPTY;
+    }
+    uint8_t state = STATE_CONSUMED;
+    uint32_t off = sector_base(log, log->tail_sector) + log->tail_off +
+                   offsetof(record_header_t, state);
+    if (flash_write(log, off, &state, 1) != 0) {
+        return SPOOL_LOG_IO;
+    }
+    log->tail_off += RECORD_SIZE(rec.len);
+    if (log->pending > 0) {
+        log->pending--;
+    }
+    log->stats.consumed++;
+    return SPOOL_LOG_OK;
+}
+
+uint32_t spool_log_pending(const spool_log_t *log) { return log->pending; }
+
+uint32_t spool_log_used_sectors(const spool_log_t *log) {
+    if (log->pending == 0) {
+        return 0;
+    }
+    return (log->head_sector + log->sectors - log->tail_sector) %
+               log->sectors +
+           1;
+}
+
+size_t spool_log_max_record(const spool_log_t *log) {
+    return log->flash->sector_size - SECTOR_DATA - sizeof(record_header_t);
+}
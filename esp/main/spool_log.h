@@ -0,0 +1,76 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>  // para size_t
+#include <stdint.h>
+
+/*
+ * Log circular de registros de tamanho variável sobre uma memória com
+ * semântica de NOR flash (apagar deixa 0xFF, gravar só zera bits).
+ *
+ * A memória é dividida em setores; cada setor começa com um cabeçalho
+ * {magic, seq} e os registros são {magic, estado, len, crc32} + dados,
+ * alinhados a 4 bytes. Um registro é marcado como consumido zerando o byte
+ * de estado, então o ponto de leitura sobrevive a um reboot. Na abertura o
+ * log é reconstruído a partir dos cabeçalhos: setor mais antigo e mais novo
+ * pelo seq, fim dos dados no primeiro cabeçalho inválido. Um registro
+ * cortado por queda de energia falha o CRC e é pulado.
+ *
+ * O acesso à memória é feito por um HAL, para o mesmo código rodar sobre
+ * uma partição da flash, um buffer em RAM/PSRAM ou um arquivo no host.
+ */
+
+typedef struct {
+    int (*read)(void *ctx, uint32_t offset, void *buf, size_t len);
+    int (*write)(void *ctx, uint32_t offset, const void *buf, size_t len);
+    int (*erase)(void *ctx, uint32_t offset, size_t len);  // setor inteiro
+    uint32_t size;         // múltiplo de sector_size, ao menos 2 setores
+    uint32_t sector_size;
+    void *ctx;
+} spool_flash_t;
+
+typedef enum {
+    SPOOL_LOG_OK = 0,
+    SPOOL_LOG_EMPTY = -1,
+    SPOOL_LOG_FULL = -2,     // sem setor livre e sem sobrescrita
+    SPOOL_LOG_TOO_BIG = -3,  // registro maior que um setor
+    SPOOL_LOG_IO = -4,       // erro do HAL
+} spool_log_result_t;
+
+typedef struct {
+    uint32_t appended;
+    uint32_t consumed;
+    uint32_t dropped;  // registros não lidos apagados para abrir espaço
+    uint32_t corrupt;  // registros pulados por CRC inválido
+} spool_log_stats_t;
+
+typedef struct {
+    const spool_flash_t *flash;
+    bool overwrite;  // log cheio: apaga o setor mais antigo
+    uint32_t sectors;
+    uint32_t head_sector;  // próxima escrita
+    uint32_t head_off;
+    uint32_t head_seq;
+    uint32_t tail_sector;  // próximo registro a ler
+    uint32_t tail_off;
+    uint32_t pending;      // registros ainda não consumidos
+    spool_log_stats_t stats;
+} spool_log_t;
+
+// Reconstrói o estado a partir do conteúdo da memória (formata se estiver
+// vazia). `overwrite` escolhe entre perder os mais antigos e SPOOL_LOG_FULL.
+spool_log_result_t spool_log_open(spool_log_t *log, const spool_flash_t *flash,
+                                  bool overwrite);
+spool_log_result_t spool_log_append(spool_log_t *log, const void *data,
+                                    size_t len);
+// Copia o registro mais antigo não consumido para `buf` (até `cap` bytes)
+// sem consumi-lo; `len` recebe o tamanho real.
+spool_log_result_t spool_log_peek(spool_log_t *log, void *buf, size_t cap,
+                                  size_t *len);
+// Marca como consumido o registro devolvido pelo último peek.
+spool_log_result_t spool_log_consume(spool_log_t *log);
+uint32_t spool_log_pending(const spool_log_t *log);
+// Setores do registro mais antigo não consumido até o de escrita, inclusive;
+// 0 com o log vazio.
+uint32_t spool_log_used_sectors(const spool_log_t *log);
+// Maior registro que cabe em um setor.
+size_t spool_log_max_record(const spool_log_t *log);
@@ -0,0 +1,125 @@
+#include "spsc_ring.h"
+
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#else
+#define IRAM_ATTR
+#endif
+
+#define SLOT(ring, pos) ((ring)->storage + ((pos) & (ring)->mask) * (ring)->elem_size)
+
+bool spsc_ring_init(spsc_ring_t *ring, void *storage, size_t elem_size,
+                    uint32_t capacity, spsc_ring_policy_t policy) {
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        return false;
+    }
+    ring->storage = storage;
+    ring->elem_size = elem_size;
+    ring->mask = capacity - 1;
+    ring->policy = policy;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->pushed, 0);
+    atomic_init(&ring->popped, 0);
+    atomic_init(&ring->dropped_newest, 0);
+    atomic_init(&ring->dropped_oldest, 0);
+    atomic_init(&ring->overruns, 0);
+    atomic_init(&ring->high_water, 0);
+    return true;
+}
+
+static void IRAM_ATTR copy_in(spsc_ring_t *ring, void *dst, const void *src) {
+    // Elementos do tamanho de um ponteiro são o caso comum (pool de pacotes).
+    if (ring->elem_size == sizeof(void *)) {
+        *(void **)dst = *(void *const *)src;
+    } else {
+        memcpy(dst, src, ring->elem_size);
+    }
+}
+
+spsc_ring_result_t IRAM_ATTR spsc_ring_push(spsc_ring_t *ring,
+                                            const void *elem, void *evicted) {
+    spsc_ring_result_t result = SPSC_RING_OK;
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head - tail > ring->mask) {
+        atomic_fetch_add_explicit(&ring->overruns, 1, memory_order_relaxed);
+
+        if (ring->policy == SPSC_RING_DROP_NEWEST) {
+            atomic_fetch_add_explicit(&ring->dropped_newest, 1,
+                                      memory_order_relaxed);
+            return SPSC_RING_DROPPED;
+        }
+
+        // Copia o mais antigo antes de tomar o slot: se o consumidor avançar
+        // primeiro, o CAS falha e já existe espaço livre.
+        if (evicted != NULL) {
+            copy_in(ring, evicted, SLOT(ring, tail));
+        }
+        if (atomic_compare_exchange_strong_explicit(
+                &ring->tail, &tail, tail + 1, memory_order_acq_rel,
+                memory_order_acquire)) {
+            atomic_fetch_add_explicit(&ring->dropped_oldest, 1,
+                                      memory_order_relaxed);
+            result = SPSC_RING_EVICTED;
+            tail++;
+        }
+    }
+
+    copy_in(ring, SLOT(ring, head), elem);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    atomic_fetch_add_explicit(&ring->pushed, 1, memory_order_relaxed);
+
+    unsigned used = head + 1 - tail;
+    if (used > atomic_load_explicit(&ring->high_water, memory_order_relaxed)) {
+        atomic_store_explicit(&ring->high_water, used, memory_order_relaxed);
+    }
+    return result;
+}
+
+size_t spsc_ring_pop(spsc_ring_t *ring, void *out, size_t max) {
+    uint8_t *dst = out;
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    while (1) {
+        unsigned head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        size_t n = head - tail;
+        if (n > max) {
+            n = max;
+        }
+        if (n == 0) {
+            return 0;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            copy_in(ring, dst + i * ring->elem_size, SLOT(ring, tail + i));
+        }
+
+        // Se o produtor descartou o mais antigo enquanto copiávamos, o CAS
+        // falha, `tail` é recarregado e a leitura é refeita.
+        if (atomic_compare_exchange_strong_explicit(
+                &ring->tail, &tail, tail + (unsigned)n, memory_order_acq_rel,
+                memory_order_acquire)) {
+            atomic_fetch_add_explicit(&ring->popped, n, memory_order_relaxed);
+            return n;
+        }
+    }
+}
+
+size_t spsc_ring_count(spsc_ring_t *ring) {
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    return head - tail;
+}
+
+void spsc_ring_get_stats(spsc_ring_t *ring, spsc_ring_stats_t *stats) {
+    stats->pushed = atomic_load(&ring->pushed);
+    stats->popped = atomic_load(&ring->popped);
+    stats->dropped_newest = atomic_load(&ring->dropped_newest);
+    stats->dropped_oldest = atomic_load(&ring->dropped_oldest);
+    stats->overruns = atomic_load(&ring->overruns);
+    stats->high_water = atomic_load(&ring->high_water);
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>  // para size_t
+#include <stdint.h>
+
+/*
+ * Anel lock-free de um produtor e um consumidor (SPSC).
+ *
+ * Os elementos têm tamanho fixo escolhido na inicialização e a memória é do
+ * chamador. O produtor (callback do amostrador) usa spsc_ring_push; o
+ * consumidor (send_task) drena blocos de tamanho variável com
+ * spsc_ring_pop. Quando o anel está cheio a política decide quem perde:
+ * o elemento novo (DROP_NEWEST) ou o mais antigo ainda não lido
+ * (DROP_OLDEST). Toda perda é contada.
+ *
+ * C11 puro, sem dependência do FreeRTOS: compila e roda no host com
+ * pthreads no papel do ISR e da task.
+ */
+
+typedef enum {
+    SPSC_RING_DROP_NEWEST,
+    SPSC_RING_DROP_OLDEST,
+} spsc_ring_policy_t;
+
+typedef enum {
+    SPSC_RING_OK,
+    SPSC_RING_DROPPED,  // cheio, o elemento novo foi descartado
+    SPSC_RING_EVICTED,  // cheio, o mais antigo foi substituído
+} spsc_ring_result_t;
+
+typedef struct {
+    uint32_t pushed;
+    uint32_t popped;
+    uint32_t dropped_newest;
+    uint32_t dropped_oldest;
+    uint32_t overruns;    // vezes em que o produtor encontrou o anel cheio
+    uint32_t high_water;  // maior ocupação já vista
+} spsc_ring_stats_t;
+
+typedef struct {
+    uint8_t *storage;
+    size_t elem_size;
+    uint32_t mask;  // capacidade - 1 (capacidade potência de 2)
+    spsc_ring_policy_t policy;
+    atomic_uint head;  // só o produtor escreve
+    atomic_uint tail;  // consumidor, e produtor ao descartar o mais antigo
+    atomic_uint pushed;
+    atomic_uint popped;
+    atomic_uint dropped_newest;
+    atomic_uint dropped_oldest;
+    atomic_uint overruns;
+    atomic_uint high_water;
+} spsc_ring_t;
+
+// `capacity` precisa ser potência de 2; retorna false caso contrário.
+bool spsc_ring_init(spsc_ring_t *ring, void *storage, size_t elem_size,
+                    uint32_t capacity, spsc_ring_policy_t policy);
+
+// Produtor. Com SPSC_RING_EVICTED o elemento descartado é copiado para
+// `evicted` (se não for NULL) para o chamador liberar o que ele referencia.
+spsc_ring_result_t spsc_ring_push(spsc_ring_t *ring, const void *elem,
+                                  void *evicted);
+
+// Consumidor. Copia até `max` elementos para `out`; retorna quantos.
+size_t spsc_ring_pop(spsc_ring_t *ring, void *out, size_t max);
+
+size_t spsc_ring_count(spsc_ring_t *ring);
+void spsc_ring_get_stats(spsc_ring_t *ring, spsc_ring_stats_t *stats);
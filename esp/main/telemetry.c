@@ -0,0 +1,94 @@
+#include "telemetry.h"
+
+#include <stdatomic.h>
+#include <string.h>
+
+#include "esp_system.h"
+#include "esp_wifi.h"
+#include "packet_pool.h"
+#include "sdkconfig.h"
+
+#if CONFIG_MIC_CAPTURE_CONTINUOUS
+#include "mic_adc_continuous.h"
+#endif
+
+static atomic_uint sent;
+static atomic_uint drop_queue[TELEMETRY_QUEUE_CLASSES];
+static atomic_uint drop_ws_offline;
+static atomic_uint drop_ws_error;
+static atomic_uint connects;
+static atomic_uint send_latency[TELEMETRY_LATENCY_BUCKETS];
+
+static int latency_bucket(uint32_t us) {
+    int bucket = us < 2 ? 0 : 31 - __builtin_clz(us);
+    return bucket < TELEMETRY_LATENCY_BUCKETS ? bucket
+                                              : TELEMETRY_LATENCY_BUCKETS - 1;
+}
+
+void telemetry_record_send(telemetry_send_result_t result, uint32_t latency_us) {
+    switch (result) {
+        case TELEMETRY_SEND_OK:
+            atomic_fetch_add_explicit(&sent, 1, memory_order_relaxed);
+            break;
+        case TELEMETRY_SEND_OFFLINE:
+            atomic_fetch_add_explicit(&drop_ws_offline, 1,
+                                      memory_order_relaxed);
+            return;
+        case TELEMETRY_SEND_ERROR:
+            atomic_fetch_add_explicit(&drop_ws_error, 1, memory_order_relaxed);
+            break;
+    }
+    atomic_fetch_add_explicit(&send_latency[latency_bucket(latency_us)], 1,
+                              memory_order_relaxed);
+}
+
+void telemetry_record_queue_drop(unsigned ws_class) {
+    if (ws_class < TELEMETRY_QUEUE_CLASSES) {
+        atomic_fetch_add_explicit(&drop_queue[ws_class], 1,
+                                  memory_order_relaxed);
+    }
+}
+
+void telemetry_record_connect(void) {
+    atomic_fetch_add_explicit(&connects, 1, memory_order_relaxed);
+}
+
+void telemetry_collect(spsc_ring_t *ring, TelemetryStats *out) {
+    memset(out, 0, sizeof(*out));
+
+    spsc_ring_stats_t ring_stats;
+    spsc_ring_get_stats(ring, &ring_stats);
+    packet_pool_stats_t pool_stats;
+    packet_pool_get_stats(&pool_stats);
+
+    // `pushed` inclui os pushes que descartaram o mais antigo.
+    out->produced =
+        ring_stats.pushed + ring_stats.dropped_newest + pool_stats.exhausted;
+    out->sent = atomic_load(&sent);
+    out->drop_ring = ring_stats.dropped_newest + ring_stats.dropped_oldest;
+    out->drop_pool = pool_stats.exhausted;
+#if CONFIG_MIC_CAPTURE_CONTINUOUS
+    out->drop_adc = mic_adc_continuous_overflows();
+#endif
+    for (int i = 0; i < TELEMETRY_QUEUE_CLASSES; i++) {
+        out->drop_queue[i] = atomic_load(&drop_queue[i]);
+    }
+    out->drop_ws_offline = atomic_load(&drop_ws_offline);
+    out->drop_ws_error = atomic_load(&drop_ws_error);
+    out->heap_free = esp_get_free_heap_size();
+    out->heap_min_free = esp_get_minimum_free_heap_size();
+    out->ring_high_water = (uint16_t)ring_stats.high_water;
+    out->pool_min_free = (uint16_t)pool_stats.min_free;
+
+    unsigned n = atomic_load(&connects);
+    out->reconnects = (uint16_t)(n > 0 ? n - 1 : 0);
+
+    wifi_ap_record_t ap;
+    if (esp_wifi_sta_get_ap_info(&ap) == ESP_OK) {
+        out->rssi = ap.rssi;
+    }
+
+    for (int i = 0; i < TELEMETRY_LATENCY_BUCKETS; i++) {
+        out->send_latency[i] = atomic_load(&send_latency[i]);
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sensor_manager.h"
+#include "spsc_ring.h"
+
+// Contadores de funcionamento do firmware, enviados periodicamente em um
+// pacote SENSOR_PACKET_TYPE_TELEMETRY. Os valores são acumulados desde o
+// boot: o servidor calcula as diferenças, então perder um quadro não perde
+// contagens.
+
+#define TELEMETRY_LATENCY_BUCKETS 20  // log2 em us: <2 us ... >=0,5 s
+#define TELEMETRY_QUEUE_CLASSES 3     // ws_class_t: áudio, estatísticas, leituras
+
+typedef enum {
+    TELEMETRY_SEND_OK,
+    TELEMETRY_SEND_OFFLINE,  // websocket desconectado
+    TELEMETRY_SEND_ERROR,    // esp_websocket_client_send_bin falhou
+} telemetry_send_result_t;
+
+typedef struct {
+    uint32_t produced;         // blocos completos no amostrador
+    uint32_t sent;             // pacotes binários enviados
+    uint32_t drop_ring;        // anel cheio
+    uint32_t drop_pool;        // pool sem buffer livre
+    uint32_t drop_adc;         // quadros do DMA do ADC perdidos (pool cheio)
+    uint32_t drop_queue[TELEMETRY_QUEUE_CLASSES];  // fila do escritor cheia
+    uint32_t drop_ws_offline;
+    uint32_t drop_ws_error;
+    uint32_t heap_free;
+    uint32_t heap_min_free;
+    uint16_t ring_high_water;
+    uint16_t pool_min_free;
+    uint16_t reconnects;
+    int8_t rssi;               // dBm; 0 sem AP
+    uint8_t quality;           // nível de qualidade do áudio em uso
+    // Duração das chamadas de envio; balde i: [2^i, 2^(i+1)) us.
+    uint32_t send_latency[TELEMETRY_LATENCY_BUCKETS];
+} __attribute__((packed)) TelemetryStats;
+
+typedef struct {
+    SensorPacketHeader header;
+    TelemetryStats stats;
+} __attribute__((packed)) SensorTelemetryPacket;
+
+void telemetry_record_send(telemetry_send_result_t result, uint32_t latency_us);
+// Descarte na fila da task escritora; `ws_class` é um ws_class_t.
+void telemetry_record_queue_drop(unsigned ws_class);
+void telemetry_record_connect(void);
+// `ring` é o anel do áudio (ocupação máxima e descartes).
+void telemetry_collect(spsc_ring_t *ring, TelemetryStats *out);
@@ -0,0 +1,79 @@
+#include "timing_hist.h"
+
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#else
+#define IRAM_ATTR
+#endif
+
+void timing_hist_init(timing_hist_t *hist, uint32_t width_cycles) {
+    hist->width = width_cycles ? width_cycles : 1;
+    timing_hist_reset(hist);
+}
+
+void timing_hist_reset(timing_hist_t *hist) {
+    hist->count = 0;
+    hist->min = UINT32_MAX;
+    hist->max = 0;
+    memset(hist->buckets, 0, sizeof(hist->buckets));
+}
+
+void IRAM_ATTR timing_hist_record(timing_hist_t *hist, uint32_t cycles) {
+    uint32_t bucket = cycles / hist->width;
+    if (bucket >= TIMING_HIST_BUCKETS) {
+        bucket = TIMING_HIST_BUCKETS - 1;
+    }
+    hist->buckets[bucket]++;
+    hist->count++;
+    if (cycles < hist->min) {
+        hist->min = cycles;
+    }
+    if (cycles > hist->max) {
+        hist->max = cycles;
+    }
+}
+
+uint32_t timing_hist_percentile(const timing_hist_t *hist, uint32_t permille) {
+    if (hist->count == 0) {
+        return 0;
+    }
+    // Posição (1..count) da medida que marca o percentil.
+    uint64_t rank = ((uint64_t)hist->count * permille + 999) / 1000;
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < TIMING_HIST_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            uint64_t upper = (uint64_t)(i + 1) * hist->width;
+            if (i == TIMING_HIST_BUCKETS - 1 || upper > hist->max) {
+                return hist->max;
+            }
+            return (uint32_t)upper;
+        }
+    }
+    return hist->max;
+}
+
+static uint32_t cycles_to_ns(uint32_t cycles, uint32_t cycles_per_us) {
+    return (uint32_t)((uint64_t)cycles * 1000 / cycles_per_us);
+}
+
+void timing_hist_summary(const timing_hist_t *hist, uint32_t cycles_per_us,
+                         TimingSummary *out) {
+    memset(out, 0, sizeof(*out));
+    if (hist->count == 0 || cycles_per_us == 0) {
+        return;
+    }
+    out->count = hist->count;
+    out->min_ns = cycles_to_ns(hist->min, cycles_per_us);
+    out->max_ns = cycles_to_ns(hist->max, cycles_per_us);
+    out->p50_ns = cycles_to_ns(timing_hist_percentile(hist, 500), cycles_per_us);
+    out->p99_ns = cycles_to_ns(timing_hist_percentile(hist, 990), cycles_per_us);
+    out->p999_ns =
+        cycles_to_ns(timing_hist_percentile(hist, 999), cycles_per_us);
+    out->overflow = hist->buckets[TIMING_HIST_BUCKETS - 1];
+}
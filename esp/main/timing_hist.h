@@ -0,0 +1,40 @@
+#pragma once
+#include <stdint.h>
+
+/*
+ * Histograma de baldes fixos para tempos medidos em ciclos de CPU.
+ *
+ * O registro é O(1) e sem laços, para caber no callback de amostragem; o
+ * resumo (mínimo, máximo, percentis) é calculado fora dele. Sem dependência
+ * do ESP-IDF.
+ */
+
+#define TIMING_HIST_BUCKETS 256  // o último balde acumula o transbordo
+
+typedef struct {
+    uint32_t width;  // ciclos por balde
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t buckets[TIMING_HIST_BUCKETS];
+} timing_hist_t;
+
+// Resumo exportado, em nanossegundos.
+typedef struct {
+    uint32_t count;
+    uint32_t min_ns;
+    uint32_t max_ns;
+    uint32_t p50_ns;
+    uint32_t p99_ns;
+    uint32_t p999_ns;
+    uint32_t overflow;  // medidas além do último balde
+} __attribute__((packed)) TimingSummary;
+
+void timing_hist_init(timing_hist_t *hist, uint32_t width_cycles);
+void timing_hist_reset(timing_hist_t *hist);
+void timing_hist_record(timing_hist_t *hist, uint32_t cycles);
+// Limite superior do balde que contém o percentil (em milésimos), limitado
+// ao máximo observado. 0 sem medidas.
+uint32_t timing_hist_percentile(const timing_hist_t *hist, uint32_t permille);
+void timing_hist_summary(const timing_hist_t *hist, uint32_t cycles_per_us,
+                         TimingSummary *out);
@@ -1,21 +1,112 @@
 #include "websocket_client.h"
 
-#include "cJSON.h"
+#include <stdatomic.h>
+#include <string.h>
+
+#include "esp_crt_bundle.h"
+#include "esp_event.h"
 #include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
 #include "esp_websocket_client.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 #include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "packet_header.h"
+#include "packet_pool.h"
+#include "quality_ctl.h"
 #include "sdkconfig.h"
+#include "sensor_frame.h"
+#include "sensor_json.h"
+#include "spool.h"
+#include "telemetry.h"
+#include "wifi_manager.h"
+
+_Static_assert(WS_CLASS_COUNT == TELEMETRY_QUEUE_CLASSES,
+               "telemetry.h conta descartes por classe do escritor");
 
 static const char *TAG = "websocket";
 static esp_websocket_client_handle_t client;
 
-SemaphoreHandle_t ws_mutex;
+// Só a task escritora chama o esp_websocket_client; os produtores apenas
+// enfileiram e a acordam.
+static TaskHandle_t writer_task_handle;
+
+typedef struct {
+    SensorPacket *buf;  // buffer do pool, devolvido depois do envio
+    uint16_t len;
+} audio_item_t;
+
+typedef struct {
+    uint16_t len;
+    uint8_t data[WEBSOCKET_STATS_MAX_BYTES];
+} stats_item_t;
+
+// No modo com portão o início de um evento entrega a pré-gravação inteira de
+// uma vez, sem a escritora rodar no meio (mesma prioridade e núcleo da
+// send_task); a fila precisa caber nela mais o bloco que disparou, senão o
+// começo do evento vai para o spool e volta como backfill.
+#if CONFIG_MIC_STREAM_GATED && \
+    NOISE_BLOCKS_FOR_MS(CONFIG_MIC_GATE_PREROLL_MS) >= CONFIG_WS_AUDIO_QUEUE_LEN
+#define AUDIO_QUEUE_LEN (NOISE_BLOCKS_FOR_MS(CONFIG_MIC_GATE_PREROLL_MS) + 1)
+#else
+#define AUDIO_QUEUE_LEN CONFIG_WS_AUDIO_QUEUE_LEN
+#endif
+
+static QueueHandle_t audio_queue;
+static QueueHandle_t stats_queue;
+
+// Leituras à espera do próximo envio (fila circular, descarta a mais
+// antiga). As tasks dos sensores escrevem, a escritora lê.
+static SensorReading pending[CONFIG_SENSOR_FRAME_MAX_READINGS];
+static size_t pending_head;
+static size_t pending_count;
+static portMUX_TYPE pending_lock = portMUX_INITIALIZER_UNLOCKED;
 
-static void websocket_event_handler(void *handler_args, esp_event_base_t base,
-                                    int32_t event_id, void *event_data) {
+#if CONFIG_SENSOR_PROTOCOL_BINARY
+static uint8_t frame_buf[SENSOR_FRAME_MAX_BYTES];
+#else
+// Leituras por mensagem JSON: no pior caso a mensagem ainda cabe num
+// registro do spool, que tem o tamanho de um quadro binário. O resto do lote
+// fica na fila para a mensagem seguinte.
+#define JSON_FIT_READINGS                                      \
+    ((SENSOR_FRAME_MAX_BYTES - SENSOR_JSON_MAX_BYTES(0)) /     \
+     SENSOR_JSON_READING_MAX_BYTES)
+#define JSON_BATCH_READINGS                                    \
+    (CONFIG_SENSOR_FRAME_MAX_READINGS < JSON_FIT_READINGS      \
+         ? CONFIG_SENSOR_FRAME_MAX_READINGS                    \
+         : JSON_FIT_READINGS)
+static char json_buf[SENSOR_JSON_MAX_BYTES(JSON_BATCH_READINGS)];
+#endif
+
+// Controle de qualidade: só a escritora mexe em quality_ctl; os produtores
+// leem o nível e contam descartes pelas variáveis atômicas.
+static quality_ctl_t quality_ctl;
+static bool quality_enabled;
+static atomic_uint quality_level = QUALITY_FULL;
+static atomic_uint audio_drops;
+
+#if CONFIG_SPOOL_ENABLE
+// Reenvio do spool: a task do spool deixa o quadro aqui e espera o
+// resultado; a escritora o envia quando não há tráfego ao vivo.
+static struct {
+    spool_kind_t kind;
+    const void *data;
+    size_t len;
+    bool sent;
+} backfill;
+static SemaphoreHandle_t backfill_done;
+#endif
+
+// Chamado direto pela task do cliente, sem passar pelo loop de eventos:
+// não pode bloquear.
+static void websocket_event_handler(void *arg,
+                                    esp_websocket_event_id_t event_id,
+                                    const esp_websocket_event_data_t *data) {
     if (event_id == WEBSOCKET_EVENT_CONNECTED) {
         ESP_LOGI(TAG, "WebSocket connected");
+        telemetry_record_connect();
     } else if (event_id == WEBSOCKET_EVENT_DISCONNECTED) {
         ESP_LOGI(TAG, "WebSocket disconnected");
     } else if (event_id == WEBSOCKET_EVENT_ERROR) {
@@ -23,66 +114,371 @@ static void websocket_event_handler(void *handler_args, esp_event_base_t base,
     }
 }
 
-void websocket_app_start(void) {
-    ws_mutex = xSemaphoreCreateMutex();
-    esp_websocket_client_config_t cfg = {
-        .uri = CONFIG_WEBSOCKET_URI,
-    };
+// O cliente só começa a conectar quando o Wi-Fi tem IP: tentativas antes
+// disso falhariam e levariam o backoff da reconexão a segundos.
+static atomic_bool client_started;
 
-    client = esp_websocket_client_init(&cfg);
-    esp_websocket_register_events(client, WEBSOCKET_EVENT_ANY,
-                                  websocket_event_handler, NULL);
-    esp_websocket_client_start(client);
+static void start_client(void) {
+    if (!atomic_exchange(&client_started, true)) {
+        esp_websocket_client_start(client);
+    }
+}
+
+static void got_ip_handler(void *arg, esp_event_base_t event_base,
+                           int32_t event_id, void *event_data) {
+    start_client();
+}
+
+// Envios com prazo: um enlace congestionado vira timeout (e o cliente
+// derruba a conexão) em vez de travar a escritora.
+#define WS_SEND_TIMEOUT pdMS_TO_TICKS(CONFIG_WS_SEND_TIMEOUT_MS)
+
+// Entrega a duração do envio ao controle de qualidade.
+static telemetry_send_result_t ws_result(int sent, size_t len, int64_t start) {
+    uint32_t latency_us = (uint32_t)(esp_timer_get_time() - start);
+    if (quality_enabled) {
+        quality_ctl_record_send(
+            &quality_ctl, len, latency_us,
+            sent < 0 && latency_us >= CONFIG_WS_SEND_TIMEOUT_MS * 1000);
+    }
+    return sent < 0 ? TELEMETRY_SEND_ERROR : TELEMETRY_SEND_OK;
+}
+
+static telemetry_send_result_t ws_send(bool text, const void *data,
+                                       size_t len) {
+    if (!esp_websocket_client_is_connected(client)) {
+        return TELEMETRY_SEND_OFFLINE;
+    }
+    int64_t start = esp_timer_get_time();
+    int sent = text ? esp_websocket_client_send_text(client, data, len,
+                                                     WS_SEND_TIMEOUT)
+                    : esp_websocket_client_send_bin(client, data, len,
+                                                    WS_SEND_TIMEOUT);
+    return ws_result(sent, len, start);
 }
 
-void websocket_send_readings(SensorReading *readings) {
-    cJSON *root = cJSON_CreateObject();
-    cJSON *data = cJSON_CreateArray();
+// Binário sem cópia para o tx_buffer do cliente: um frame só, com os
+// buffers mascarados no lugar durante o envio.
+static telemetry_send_result_t ws_send_iov(const esp_websocket_iovec_t *iov,
+                                           int count) {
+    if (!esp_websocket_client_is_connected(client)) {
+        return TELEMETRY_SEND_OFFLINE;
+    }
+    size_t len = 0;
+    for (int i = 0; i < count; i++) {
+        len += iov[i].len;
+    }
+    int64_t start = esp_timer_get_time();
+    int sent =
+        esp_websocket_client_send_bin_iov(client, iov, count, WS_SEND_TIMEOUT);
+    return ws_result(sent, len, start);
+}
 
-    if (strcmp(readings[0].name, "temperature") == 0 ||
-        strcmp(readings[0].name, "humidity") == 0) {
-        cJSON *entry = cJSON_CreateObject();
-        cJSON_AddNumberToObject(entry, "temperature", readings[0].value);
-        cJSON_AddNumberToObject(entry, "humidity", readings[1].value);
-        cJSON_AddNumberToObject(entry, "timestamp", readings[0].timestamp);
-        cJSON_AddItemToArray(data, entry);
+static void quality_update(void) {
+    if (!quality_enabled) {
+        return;
+    }
+    for (unsigned n = atomic_exchange(&audio_drops, 0); n > 0; n--) {
+        quality_ctl_record_drop(&quality_ctl);
+    }
+    quality_level_t level =
+        quality_ctl_update(&quality_ctl, (uint64_t)esp_timer_get_time());
+    if (atomic_exchange(&quality_level, level) != level) {
+        ESP_LOGW(TAG, "Qualidade do áudio: nível %d (vazão medida %lu B/s)",
+                 level, (unsigned long)quality_ctl.capacity_bytes_per_s);
+    }
+}
+
+static void pending_push(const SensorReading *readings, size_t count) {
+    size_t dropped = 0;
+    portENTER_CRITICAL(&pending_lock);
+    for (size_t i = 0; i < count; i++) {
+        if (pending_count == CONFIG_SENSOR_FRAME_MAX_READINGS) {
+            pending_head = (pending_head + 1) % CONFIG_SENSOR_FRAME_MAX_READINGS;
+            pending_count--;
+            dropped++;
+        }
+        size_t tail =
+            (pending_head + pending_count) % CONFIG_SENSOR_FRAME_MAX_READINGS;
+        pending[tail] = readings[i];
+        pending_count++;
+    }
+    portEXIT_CRITICAL(&pending_lock);
+
+    while (dropped--) {
+        telemetry_record_queue_drop(WS_CLASS_ENV);
+    }
+}
 
-        cJSON_AddItemToObject(root, "data", data);
-        cJSON_AddStringToObject(root, "type", "dht");
+static bool pending_empty(void) {
+    portENTER_CRITICAL(&pending_lock);
+    bool empty = pending_count == 0;
+    portEXIT_CRITICAL(&pending_lock);
+    return empty;
+}
+
+// As duas abaixo são chamadas com pending_lock.
+static const SensorReading *pending_at(size_t i) {
+    return &pending[(pending_head + i) % CONFIG_SENSOR_FRAME_MAX_READINGS];
+}
+
+static void pending_drop_front(size_t n) {
+    pending_head = (pending_head + n) % CONFIG_SENSOR_FRAME_MAX_READINGS;
+    pending_count -= n;
+}
+
+#if CONFIG_SENSOR_PROTOCOL_BINARY
+// Move para o quadro as leituras pendentes que couberem.
+static void pending_take(sensor_frame_t *frame) {
+    portENTER_CRITICAL(&pending_lock);
+    while (pending_count > 0 && sensor_frame_add_reading(frame, pending_at(0))) {
+        pending_drop_front(1);
+    }
+    portEXIT_CRITICAL(&pending_lock);
+}
+
+// Um quadro com `packet` (se houver) e as leituras pendentes que couberem;
+// o que não sair vai para o spool. O pacote é o último registro e sai do
+// próprio buffer: frame_buf leva só os cabeçalhos e as leituras.
+static void send_packet(void *packet, size_t len) {
+    sensor_frame_t frame;
+    sensor_frame_begin(&frame, frame_buf, sizeof(frame_buf),
+                       packet_header_boot_id());
+    if (packet != NULL && !sensor_frame_reserve_tail(&frame, len)) {
+        ESP_LOGE(TAG, "Pacote de %u bytes não cabe no quadro", (unsigned)len);
+        packet = NULL;
+    }
+    pending_take(&frame);
+    if (packet != NULL) {
+        sensor_frame_add_tail(&frame, ((const SensorPacketHeader *)packet)->type);
     } else {
-        cJSON *entry = cJSON_CreateObject();
-        cJSON_AddNumberToObject(entry, "sample", readings->value);
-        cJSON_AddNumberToObject(entry, "timestamp", readings->timestamp);
-        cJSON_AddItemToArray(data, entry);
+        len = 0;
+    }
+    if (sensor_frame_records(&frame) == 0) {
+        return;
+    }
 
-        cJSON_AddItemToObject(root, "data", data);
-        cJSON_AddStringToObject(root, "type", readings->name);
+    esp_websocket_iovec_t iov[] = {
+        {.data = frame_buf, .len = frame.len},
+        {.data = packet, .len = len},
+    };
+    int64_t start = esp_timer_get_time();
+    telemetry_send_result_t result = ws_send_iov(iov, packet != NULL ? 2 : 1);
+    if (packet != NULL) {
+        telemetry_record_send(result,
+                              (uint32_t)(esp_timer_get_time() - start));
+    }
+    if (result != TELEMETRY_SEND_OK) {
+        // O spool quer o quadro contíguo: o espaço reservado recebe o pacote.
+        if (len > 0) {
+            memcpy(frame_buf + frame.len, packet, len);
+        }
+        spool_put(SPOOL_KIND_BINARY, frame_buf, frame.len + len);
     }
+}
 
-    char *json = cJSON_PrintUnformatted(root);
+static void send_readings(void) { send_packet(NULL, 0); }
+#else
+static void send_packet(void *packet, size_t len) {
+    esp_websocket_iovec_t iov = {.data = packet, .len = len};
+    int64_t start = esp_timer_get_time();
+    telemetry_send_result_t result = ws_send_iov(&iov, 1);
+    telemetry_record_send(result, (uint32_t)(esp_timer_get_time() - start));
+    if (result != TELEMETRY_SEND_OK) {
+        spool_put(SPOOL_KIND_BINARY, packet, len);
+    }
+}
 
-    if (xSemaphoreTake(ws_mutex, pdMS_TO_TICKS(100))) {
-        if (esp_websocket_client_is_connected(client)) {
-            ESP_LOGI(TAG, "Sending data: %s", json);
-            esp_websocket_client_send_text(client, json, strlen(json),
-                                           portMAX_DELAY);
+// Tira da fila um lote que vira uma mensagem JSON: leituras seguidas do
+// mesmo sensor, ou pares temperatura/umidade.
+static size_t pending_take_json(SensorReading *out, size_t max) {
+    size_t n = 0;
+    portENTER_CRITICAL(&pending_lock);
+    if (pending_count > 0) {
+        uint8_t first = pending_at(0)->type;
+        bool dht = first == SENSOR_RECORD_TEMPERATURE;
+        while (n < pending_count && n < max) {
+            const SensorReading *r = pending_at(n);
+            uint8_t expected = !dht     ? first
+                               : n % 2 ? SENSOR_RECORD_HUMIDITY
+                                       : SENSOR_RECORD_TEMPERATURE;
+            if (r->type != expected) {
+                break;
+            }
+            out[n++] = *r;
+        }
+        if (dht && n % 2) {
+            n--;  // temperatura sem umidade não tem como sair
         }
-        xSemaphoreGive(ws_mutex);
+        pending_drop_front(n ? n : 1);
+    }
+    portEXIT_CRITICAL(&pending_lock);
+    return n;
+}
+
+static void send_readings(void) {
+    SensorReading batch[JSON_BATCH_READINGS];
+    size_t count = pending_take_json(batch, JSON_BATCH_READINGS);
+    if (count == 0) {
+        return;
     }
 
-    cJSON_free(json);
-    cJSON_Delete(root);
+    size_t len = sensor_json_encode(batch, count, json_buf, sizeof(json_buf));
+    if (len == 0) {
+        // Só com um nome maior que SENSOR_JSON_NAME_MAX.
+        ESP_LOGW(TAG, "JSON batch of %u readings does not fit",
+                 (unsigned)count);
+        while (count--) {
+            telemetry_record_queue_drop(WS_CLASS_ENV);
+        }
+        return;
+    }
+    ESP_LOGD(TAG, "Sending data: %s", json_buf);
+    if (ws_send(true, json_buf, len) != TELEMETRY_SEND_OK) {
+        spool_put(SPOOL_KIND_TEXT, json_buf, len);
+    }
 }
+#endif
 
-void websocket_send_noise_readings(SensorPacket *packet) {
-    if (xSemaphoreTake(ws_mutex, pdMS_TO_TICKS(5))) {
-        if (esp_websocket_client_is_connected(client)) {
-            //ESP_LOGI(TAG, "Sending noise packet: timestamp=%lu, samples[0]=%d",
-            //       (unsigned long)packet->timestamp, packet->samples[0]);
-            esp_websocket_client_send_bin(client, (const char *)packet,
-                                            sizeof(SensorPacket),
-                                            portMAX_DELAY);
+// Envia uma mensagem, da classe mais prioritária com algo na fila.
+static bool writer_step(void) {
+    audio_item_t audio;
+    if (xQueueReceive(audio_queue, &audio, 0)) {
+        send_packet(audio.buf, audio.len);
+        packet_pool_release(audio.buf);
+        return true;
+    }
+
+    static stats_item_t stats;
+    if (xQueueReceive(stats_queue, &stats, 0)) {
+        send_packet(stats.data, stats.len);
+        return true;
+    }
+
+    if (!pending_empty()) {
+        send_readings();
+        return true;
+    }
+
+#if CONFIG_SPOOL_ENABLE
+    if (backfill.data != NULL) {
+        backfill.sent = ws_send(backfill.kind == SPOOL_KIND_TEXT,
+                                backfill.data,
+                                backfill.len) == TELEMETRY_SEND_OK;
+        backfill.data = NULL;
+        xSemaphoreGive(backfill_done);
+        return true;
+    }
+#endif
+    return false;
+}
+
+static void writer_task(void *arg) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+        while (writer_step()) {
+            quality_update();
         }
-        xSemaphoreGive(ws_mutex);
+        quality_update();
+    }
+}
+
+#if CONFIG_SPOOL_ENABLE
+// Chamada pela task do spool, que espera a escritora; uma falha aqui não
+// volta para o spool.
+static bool send_spooled(spool_kind_t kind, const void *data, size_t len) {
+    if (!esp_websocket_client_is_connected(client)) {
+        return false;
     }
-}
\ No newline at end of file
+    backfill.kind = kind;
+    backfill.len = len;
+    backfill.data = data;
+    xTaskNotifyGive(writer_task_handle);
+    xSemaphoreTake(backfill_done, portMAX_DELAY);
+    return backfill.sent;
+}
+#endif
+
+void websocket_app_start(void) {
+    audio_queue = xQueueCreate(AUDIO_QUEUE_LEN, sizeof(audio_item_t));
+    stats_queue = xQueueCreate(CONFIG_WS_STATS_QUEUE_LEN, sizeof(stats_item_t));
+    esp_websocket_client_config_t cfg = {
+        .uri = CONFIG_WEBSOCKET_URI,
+        .task_prio = CONFIG_WEBSOCKET_TASK_PRIORITY,
+        .task_stack = CONFIG_WEBSOCKET_TASK_STACK,
+        .reconnect_backoff_ms = CONFIG_WEBSOCKET_RECONNECT_BACKOFF_MS,
+        // wss://: retomar a sessão TLS evita o handshake completo a cada
+        // reconexão (precisa de CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS)
+        .tls_session_resumption = true,
+#if CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+        .crt_bundle_attach = esp_crt_bundle_attach,
+#endif
+    };
+
+    client = esp_websocket_client_init(&cfg);
+    esp_websocket_register_callback(client, websocket_event_handler, NULL);
+    esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, got_ip_handler,
+                               NULL);
+    if (wifi_is_connected()) {
+        start_client();
+    }
+    xTaskCreatePinnedToCore(writer_task, "WS Writer",
+                            CONFIG_WS_WRITER_TASK_STACK, NULL,
+                            CONFIG_WS_WRITER_TASK_PRIORITY, &writer_task_handle,
+                            CONFIG_NETWORK_CORE);
+#if CONFIG_SPOOL_ENABLE
+    backfill_done = xSemaphoreCreateBinary();
+    const spool_config_t spool_config = {
+        .ram_bytes = CONFIG_SPOOL_RAM_KB * 1024,
+        .drain_bytes_per_s = CONFIG_SPOOL_DRAIN_BYTES_PER_S,
+        .drain_priority = CONFIG_SPOOL_DRAIN_TASK_PRIORITY,
+    };
+    spool_start(&spool_config, send_spooled);
+#endif
+}
+
+bool websocket_send_audio(SensorPacket *buf, size_t len) {
+    audio_item_t item = {.buf = buf, .len = (uint16_t)len};
+    if (xQueueSend(audio_queue, &item, 0) != pdTRUE) {
+        telemetry_record_queue_drop(WS_CLASS_AUDIO);
+        atomic_fetch_add(&audio_drops, 1);
+        spool_put(SPOOL_KIND_BINARY, buf, len);
+        packet_pool_release(buf);
+        return false;
+    }
+    xTaskNotifyGive(writer_task_handle);
+    return true;
+}
+
+bool websocket_send_stats(const void *packet, size_t len) {
+    static stats_item_t item;  // só a send_task produz estatísticas
+    if (len > sizeof(item.data)) {
+        return false;
+    }
+    item.len = (uint16_t)len;
+    memcpy(item.data, packet, len);
+    if (xQueueSend(stats_queue, &item, 0) != pdTRUE) {
+        telemetry_record_queue_drop(WS_CLASS_STATS);
+        spool_put(SPOOL_KIND_BINARY, packet, len);
+        return false;
+    }
+    xTaskNotifyGive(writer_task_handle);
+    return true;
+}
+
+void websocket_send_readings(const SensorReading *readings, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    pending_push(readings, count);
+    xTaskNotifyGive(writer_task_handle);
+}
+
+void websocket_quality_start(const quality_ctl_config_t *config) {
+    quality_ctl_init(&quality_ctl, config, (uint64_t)esp_timer_get_time());
+    quality_enabled = true;
+}
+
+quality_level_t websocket_quality_level(void) {
+    return (quality_level_t)atomic_load(&quality_level);
+}
@@ -1,8 +1,41 @@
 #pragma once
+#include <stdbool.h>
 #include <stddef.h>  // para size_t
 
+#include "quality_ctl.h"
 #include "sensor_manager.h"
 
+/*
+ * Uma task escritora é dona do cliente WebSocket e esvazia as filas por
+ * prioridade: áudio, depois estatísticas, depois leituras de LDR/DHT
+ * (agrupadas num envio só) e, por último, o reenvio do spool. As funções
+ * abaixo só enfileiram: não esperam a rede. O que não cabe na fila conta
+ * como descarte da classe na telemetria e vai para o spool (se habilitado).
+ */
+
+typedef enum {
+    WS_CLASS_AUDIO,  // blocos de áudio e características
+    WS_CLASS_STATS,  // heartbeat, tempos, telemetria
+    WS_CLASS_ENV,    // leituras de LDR/DHT
+    WS_CLASS_COUNT,
+} ws_class_t;
+
+// Maior pacote aceito por websocket_send_stats (telemetria: 32 + 132).
+#define WEBSOCKET_STATS_MAX_BYTES 192
+
 void websocket_app_start(void);
-void websocket_send_readings(SensorReading *readings);
-void websocket_send_noise_readings(SensorPacket *packet);
+// Leituras de LDR/DHT; saem no próximo envio (no protocolo binário, junto
+// com o áudio, se houver).
+void websocket_send_readings(const SensorReading *readings, size_t count);
+// Entrega um buffer do packet_pool com `len` bytes já serializados
+// (cabeçalho + payload). A escritora devolve o buffer ao pool depois do
+// envio; em caso de descarte ele é devolvido aqui.
+bool websocket_send_audio(SensorPacket *buf, size_t len);
+// Copia um pacote pequeno (até WEBSOCKET_STATS_MAX_BYTES) para a fila.
+bool websocket_send_stats(const void *packet, size_t len);
+
+// Liga o controle de qualidade: a escritora mede cada envio e ajusta o
+// nível lido por websocket_quality_level(). Chamar antes de
+// websocket_app_start(); sem ela o nível fica em QUALITY_FULL.
+void websocket_quality_start(const quality_ctl_config_t *config);
+quality_level_t websocket_quality_level(void);
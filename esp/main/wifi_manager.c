@@ -1,13 +1,17 @@
 #include "wifi_manager.h"
 
+#include <stdatomic.h>
+
 #include "esp_err.h"
 #include "esp_event.h"
 #include "esp_log.h"
 #include "esp_netif.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 #include "esp_wifi.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
+#include "nvs.h"
 #include "nvs_flash.h"
 #include "sdkconfig.h"
 #include "string.h"
@@ -16,23 +20,164 @@ static EventGroupHandle_t s_wifi_event_group;
 #define WIFI_CONNECTED_BIT BIT0
 #define TAG "wifi"
 
+#define NVS_NAMESPACE "wifi_mgr"
+#define NVS_KEY_AP "last_ap"
+// Falhas seguidas no AP guardado antes de voltar a varrer os canais: ele
+// pode ter mudado de canal ou saído do ar.
+#define CACHED_AP_ATTEMPTS 2
+
+typedef struct {
+    char ssid[33];  // o cache só vale para o SSID configurado
+    uint8_t bssid[6];
+    uint8_t channel;
+} cached_ap_t;
+
+static atomic_int state = WIFI_STATE_STOPPED;
+static esp_timer_handle_t retry_timer;
+static cached_ap_t cached_ap;
+static bool cached_ap_valid;
+static bool using_cached_ap;
+static int failures;  // tentativas seguidas sem chegar ao IP
+static int64_t offline_since_us;
+
+static void load_cached_ap(void) {
+#if CONFIG_WIFI_CACHE_AP
+    nvs_handle_t nvs;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return;  // primeiro boot
+    }
+    size_t len = sizeof(cached_ap);
+    cached_ap_valid =
+        nvs_get_blob(nvs, NVS_KEY_AP, &cached_ap, &len) == ESP_OK &&
+        len == sizeof(cached_ap) &&
+        strncmp(cached_ap.ssid, CONFIG_WIFI_SSID, sizeof(cached_ap.ssid)) ==
+            0 &&
+        cached_ap.channel >= 1 && cached_ap.channel <= 14;
+    nvs_close(nvs);
+#endif
+}
+
+static void save_cached_ap(const uint8_t *bssid, uint8_t channel) {
+#if CONFIG_WIFI_CACHE_AP
+    // Só grava quando muda: reconexões ao mesmo AP não gastam a flash.
+    if (cached_ap_valid && cached_ap.channel == channel &&
+        memcmp(cached_ap.bssid, bssid, sizeof(cached_ap.bssid)) == 0) {
+        return;
+    }
+    memset(&cached_ap, 0, sizeof(cached_ap));
+    strlcpy(cached_ap.ssid, CONFIG_WIFI_SSID, sizeof(cached_ap.ssid));
+    memcpy(cached_ap.bssid, bssid, sizeof(cached_ap.bssid));
+    cached_ap.channel = channel;
+    cached_ap_valid = true;
+
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(nvs, NVS_KEY_AP, &cached_ap, sizeof(cached_ap));
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Could not save the AP: %s", esp_err_to_name(err));
+    }
+#endif
+}
+
+static void apply_config(bool use_cached_ap) {
+    wifi_config_t wifi_config = {
+        .sta =
+            {
+                .ssid = CONFIG_WIFI_SSID,
+                .password = CONFIG_WIFI_PASSWORD,
+            },
+    };
+    if (use_cached_ap) {
+        // Canal e BSSID conhecidos: a busca fica num canal só e conecta no
+        // primeiro beacon desse AP.
+        wifi_config.sta.channel = cached_ap.channel;
+        wifi_config.sta.bssid_set = true;
+        memcpy(wifi_config.sta.bssid, cached_ap.bssid,
+               sizeof(wifi_config.sta.bssid));
+    }
+    esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+    using_cached_ap = use_cached_ap;
+}
+
+static void connect_now(void) {
+    atomic_store(&state, WIFI_STATE_CONNECTING);
+    esp_wifi_connect();
+}
+
+static void retry_timer_cb(void *arg) { connect_now(); }
+
+static uint32_t backoff_ms(int attempt) {
+    int shift = attempt - 1 < 16 ? attempt - 1 : 16;
+    uint32_t delay = (uint32_t)CONFIG_WIFI_RECONNECT_BACKOFF_MS << shift;
+    return delay < CONFIG_WIFI_RECONNECT_MAX_MS ? delay
+                                                : CONFIG_WIFI_RECONNECT_MAX_MS;
+}
+
+static void on_disconnected(const wifi_event_sta_disconnected_t* event) {
+    xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
+
+    if (atomic_load(&state) == WIFI_STATE_CONNECTED) {
+        // Queda: a primeira tentativa sai na hora, no AP que acabou de cair.
+        offline_since_us = esp_timer_get_time();
+        failures = 0;
+        if (!using_cached_ap && cached_ap_valid) {
+            apply_config(true);
+        }
+    } else {
+        failures++;
+        if (using_cached_ap && (failures >= CACHED_AP_ATTEMPTS ||
+                                event->reason == WIFI_REASON_NO_AP_FOUND)) {
+            ESP_LOGI(TAG, "Saved AP not found, scanning all channels");
+            apply_config(false);
+        }
+    }
+
+    if (failures == 0) {
+        ESP_LOGI(TAG, "Disconnected (reason %d), reconnecting",
+                 event->reason);
+        connect_now();
+        return;
+    }
+    uint32_t delay = backoff_ms(failures);
+    ESP_LOGI(TAG, "Disconnected (reason %d), retry %d in %lu ms",
+             event->reason, failures, (unsigned long)delay);
+    atomic_store(&state, WIFI_STATE_BACKOFF);
+    esp_timer_start_once(retry_timer, (uint64_t)delay * 1000);
+}
+
 static void wifi_event_handler(void* arg, esp_event_base_t event_base,
                                int32_t event_id, void* event_data) {
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
-        esp_wifi_connect();
+        connect_now();
+    } else if (event_base == WIFI_EVENT &&
+               event_id == WIFI_EVENT_STA_CONNECTED) {
+        wifi_event_sta_connected_t* event =
+            (wifi_event_sta_connected_t*)event_data;
+        save_cached_ap(event->bssid, event->channel);
     } else if (event_base == WIFI_EVENT &&
                event_id == WIFI_EVENT_STA_DISCONNECTED) {
-        esp_wifi_connect();
-        ESP_LOGI(TAG, "Retrying to connect...");
+        on_disconnected((wifi_event_sta_disconnected_t*)event_data);
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
         ip_event_got_ip_t* event = (ip_event_got_ip_t*)event_data;
-        ESP_LOGI(TAG, "Got IP: " IPSTR, IP2STR(&event->ip_info.ip));
+        ESP_LOGI(TAG, "Got IP: " IPSTR " after %lld ms offline%s",
+                 IP2STR(&event->ip_info.ip),
+                 (long long)(esp_timer_get_time() - offline_since_us) / 1000,
+                 using_cached_ap ? " (saved AP)" : "");
+        failures = 0;
+        atomic_store(&state, WIFI_STATE_CONNECTED);
         xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
     }
 }
 
 void wifi_init_sta(void) {
     s_wifi_event_group = xEventGroupCreate();
+    offline_since_us = esp_timer_get_time();
 
     esp_netif_init();
     esp_event_loop_create_default();
@@ -40,26 +185,42 @@ void wifi_init_sta(void) {
 
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     esp_wifi_init(&cfg);
+    // A configuração é refeita a cada boot e muda ao trocar de AP; o driver
+    // não precisa guardá-la na flash.
+    esp_wifi_set_storage(WIFI_STORAGE_RAM);
+
+    const esp_timer_create_args_t retry_timer_args = {
+        .callback = &retry_timer_cb,
+        .name = "wifi_retry",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&retry_timer_args, &retry_timer));
 
     esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID,
                                         &wifi_event_handler, NULL, NULL);
     esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP,
                                         &wifi_event_handler, NULL, NULL);
 
-    wifi_config_t wifi_config = {
-        .sta =
-            {
-                .ssid = CONFIG_WIFI_SSID,
-                .password = CONFIG_WIFI_PASSWORD,
-            },
-    };
-
+    load_cached_ap();
     esp_wifi_set_mode(WIFI_MODE_STA);
-    esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+    apply_config(cached_ap_valid);
+    atomic_store(&state, WIFI_STATE_CONNECTING);
     esp_wifi_start();
 
-    ESP_LOGI("wifi", "Connecting to Wi-Fi...");
+    ESP_LOGI(TAG, "Connecting to Wi-Fi%s...",
+             cached_ap_valid ? " (saved AP)" : "");
+}
+
+wifi_state_t wifi_get_state(void) { return atomic_load(&state); }
 
-    xEventGroupWaitBits(s_wifi_event_group, WIFI_CONNECTED_BIT, pdFALSE,
-                        pdFALSE, portMAX_DELAY);
+bool wifi_is_connected(void) {
+    return atomic_load(&state) == WIFI_STATE_CONNECTED;
+}
+
+bool wifi_wait_connected(TickType_t timeout) {
+    if (s_wifi_event_group == NULL) {
+        return false;
+    }
+    return xEventGroupWaitBits(s_wifi_event_group, WIFI_CONNECTED_BIT,
+                               pdFALSE, pdFALSE, timeout) &
+           WIFI_CONNECTED_BIT;
 }
@@ -1,3 +1,25 @@
 #pragma once
+#include <stdbool.h>
 
+#include "freertos/FreeRTOS.h"
+
+// Conexão Wi-Fi em modo estação. wifi_init_sta() só dispara a conexão e
+// retorna; o resto do firmware sobe sem esperar a rede. O último AP bom
+// (BSSID e canal) fica na NVS, e a reconexão, no boot ou depois de uma
+// queda, vai direto nele sem varrer todos os canais. Tentativas que falham
+// esperam um intervalo que dobra até CONFIG_WIFI_RECONNECT_MAX_MS.
+
+typedef enum {
+    WIFI_STATE_STOPPED,     // antes de wifi_init_sta()
+    WIFI_STATE_CONNECTING,  // associando ou esperando o DHCP
+    WIFI_STATE_BACKOFF,     // esperando para tentar de novo
+    WIFI_STATE_CONNECTED,   // com IP
+} wifi_state_t;
+
+// Chamar depois de nvs_flash_init(). Não bloqueia.
 void wifi_init_sta(void);
+// Podem ser chamadas de qualquer task; não bloqueiam.
+wifi_state_t wifi_get_state(void);
+bool wifi_is_connected(void);
+// Para quem precisa da rede: espera o IP por até `timeout`.
+bool wifi_wait_connected(TickType_t timeout);
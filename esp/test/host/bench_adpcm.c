@@ -0,0 +1,93 @@
+// IMA-ADPCM sobre api/saida.wav em blocos de 500 amostras, pelo mesmo
+// caminho do firmware (audio_codec_encode): custo por bloco, tamanho do
+// pacote e SNR da volta completa contra o PCM que entrou no codificador.
+#include <math.h>
+#include <string.h>
+
+#include "adpcm.h"
+#include "audio_codec.h"
+#include "host_test.h"
+#include "wav.h"
+
+#define MAX_SAMPLES (1 << 16)
+#define REPEAT 200  // passadas pelo arquivo na medição de tempo
+#define MIN_SNR_DB 25.0
+
+static int16_t adc[MAX_SAMPLES];
+
+static void fill_packet(SensorPacket *p, int block) {
+    memset(&p->header, 0, sizeof(p->header));
+    p->header.sample_count = NOISE_SAMPLES_PER_PACKET;
+    p->header.sample_rate_hz = NOISE_SAMPLE_RATE_HZ;
+    p->header.sequence = (uint32_t)block;
+    memcpy(p->samples, adc + block * NOISE_SAMPLES_PER_PACKET,
+           sizeof(p->samples));
+}
+
+int main(void) {
+    uint32_t rate = 0;
+    long n = wav_load_adc(SAIDA_WAV, adc, MAX_SAMPLES, &rate);
+    CHECK(n > 0);
+    if (n <= 0) {
+        return host_test_result();
+    }
+    int blocks = (int)(n / NOISE_SAMPLES_PER_PACKET);
+
+    static SensorPacket packets[MAX_SAMPLES / NOISE_SAMPLES_PER_PACKET];
+    static uint8_t encoded[MAX_SAMPLES / NOISE_SAMPLES_PER_PACKET]
+                          [AUDIO_CODEC_MAX_BYTES];
+    size_t len[MAX_SAMPLES / NOISE_SAMPLES_PER_PACKET];
+    for (int b = 0; b < blocks; b++) {
+        fill_packet(&packets[b], b);
+    }
+
+    uint64_t start = host_test_cycles();
+    for (int r = 0; r < REPEAT; r++) {
+        for (int b = 0; b < blocks; b++) {
+            len[b] = audio_codec_encode(&packets[b], SENSOR_CODEC_ADPCM,
+                                        encoded[b]);
+        }
+    }
+    double encode = (double)(host_test_cycles() - start) / REPEAT / blocks;
+
+    double signal = 0, noise = 0, decode = 0;
+    size_t bytes = 0;
+    for (int b = 0; b < blocks; b++) {
+        const SensorPacketHeader *h = (const SensorPacketHeader *)encoded[b];
+        CHECK_EQ(SENSOR_CODEC_ADPCM, h->flags & SENSOR_PACKET_CODEC_MASK);
+        AdpcmBlockHeader block;
+        memcpy(&block, encoded[b] + sizeof(*h), sizeof(block));
+        const uint8_t *codes = encoded[b] + sizeof(*h) + sizeof(block);
+
+        // Cada bloco decodifica sozinho, a partir do estado que leva.
+        int16_t pcm[NOISE_SAMPLES_PER_PACKET];
+        start = host_test_cycles();
+        for (int r = 0; r < REPEAT; r++) {
+            adpcm_state_t state = {block.predictor, block.index};
+            adpcm_decode(&state, codes, NOISE_SAMPLES_PER_PACKET, pcm);
+        }
+        decode += (double)(host_test_cycles() - start) / REPEAT;
+
+        for (int i = 0; i < NOISE_SAMPLES_PER_PACKET; i++) {
+            double ref = (packets[b].samples[i] - 2048) * 16.0;
+            signal += ref * ref;
+            noise += (pcm[i] - ref) * (pcm[i] - ref);
+        }
+        bytes += len[b];
+    }
+    double snr = 10 * log10(signal / noise);
+
+    printf("%s: %u Hz, %d blocks of %d samples\n", SAIDA_WAV, rate, blocks,
+           NOISE_SAMPLES_PER_PACKET);
+    printf("encode %.0f %s/block, decode %.0f %s/block\n", encode,
+           HOST_TEST_CYCLES_UNIT, decode / blocks, HOST_TEST_CYCLES_UNIT);
+    printf("%.1f bytes/packet vs %zu raw (%.2f:1), SNR %.1f dB\n",
+           (double)bytes / blocks, sizeof(SensorPacket),
+           (double)sizeof(SensorPacket) * blocks / bytes, snr);
+
+    CHECK_EQ(sizeof(SensorPacketHeader) + sizeof(AdpcmBlockHeader) +
+                 ADPCM_CODE_BYTES(NOISE_SAMPLES_PER_PACKET),
+             len[0]);
+    CHECK(snr >= MIN_SNR_DB);
+    return host_test_result();
+}
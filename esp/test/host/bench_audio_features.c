@@ -0,0 +1,63 @@
+// Custo das características acústicas por bloco de 500 amostras de
+// api/saida.wav: o bloco inteiro (DC, RMS, pico, cruzamentos e os 14 bins de
+// Goertzel), um bin de Goertzel sozinho e o fechamento da janela.
+#include <string.h>
+
+#include "audio_features.h"
+#include "host_test.h"
+#include "wav.h"
+
+#define N NOISE_SAMPLES_PER_PACKET
+#define MAX_SAMPLES (1 << 16)
+#define REPEAT 200
+#define GOERTZEL_BINS 14  // soma das bandas em audio_features.c
+
+static int16_t samples[MAX_SAMPLES];
+
+int main(void) {
+    uint32_t rate = 0;
+    long n = wav_load_adc(SAIDA_WAV, samples, MAX_SAMPLES, &rate);
+    CHECK(n > 0);
+    if (n <= 0) {
+        return host_test_result();
+    }
+    int blocks = (int)(n / N);
+    audio_features_init(NOISE_SAMPLE_RATE_HZ);
+
+    audio_features_acc_t acc;
+    AudioFeatures f;
+    uint64_t start = host_test_cycles();
+    for (int r = 0; r < REPEAT; r++) {
+        audio_features_reset(&acc);
+        for (int b = 0; b < blocks; b++) {
+            audio_features_add_block(&acc, samples + b * N, N);
+        }
+    }
+    double block = (double)(host_test_cycles() - start) / REPEAT / blocks;
+
+    start = host_test_cycles();
+    for (int r = 0; r < REPEAT; r++) {
+        audio_features_finish(&acc, NOISE_SAMPLE_RATE_HZ, &f);
+    }
+    double finish = (double)(host_test_cycles() - start) / REPEAT;
+
+    int32_t x[N];
+    for (int i = 0; i < N; i++) {
+        x[i] = samples[i] - 2048;
+    }
+    volatile uint64_t sink = 0;
+    start = host_test_cycles();
+    for (int r = 0; r < REPEAT * 10; r++) {
+        sink += audio_goertzel_power(x, N, 12000 + r % 64);
+    }
+    double bin = (double)(host_test_cycles() - start) / (REPEAT * 10);
+
+    printf("%d blocks: add_block %.0f, one Goertzel bin %.0f (x%d), "
+           "finish %.0f %s\n",
+           blocks, block, bin, GOERTZEL_BINS, finish, HOST_TEST_CYCLES_UNIT);
+    printf("window: rms %u peak %u zcr %u bands %d %d %d %d (0.1 dB)\n",
+           f.rms, f.peak, f.zcr, f.band_db10[0], f.band_db10[1],
+           f.band_db10[2], f.band_db10[3]);
+    CHECK(f.rms > 0);
+    return host_test_result();
+}
@@ -0,0 +1,111 @@
+// Codec Rice em blocos de 500 amostras: taxa de compressão e custo por
+// bloco em api/saida.wav, quase silêncio e ruído de 12 e 16 bits, com
+// a volta completa conferida bit a bit em todo bloco que comprime.
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "rice_codec.h"
+#include "sensor_manager.h"
+#include "wav.h"
+
+#define N NOISE_SAMPLES_PER_PACKET
+#define RAW_BYTES (N * sizeof(int16_t))
+#define MAX_BLOCKS 128
+#define REPEAT 200
+
+static int16_t samples[MAX_BLOCKS * N];
+
+typedef struct {
+    int blocks;
+    int compressed;  // blocos menores que o cru
+    size_t bytes;    // com os blocos que não comprimem contados crus
+    double encode;
+    double decode;
+} result_t;
+
+static result_t run(const char *name, int blocks) {
+    static uint8_t out[MAX_BLOCKS][RAW_BYTES];
+    size_t len[MAX_BLOCKS];
+    result_t r = {.blocks = blocks};
+
+    uint64_t start = host_test_cycles();
+    for (int rep = 0; rep < REPEAT; rep++) {
+        for (int b = 0; b < blocks; b++) {
+            len[b] = rice_encode(samples + b * N, N, out[b], RAW_BYTES - 1);
+        }
+    }
+    r.encode = (double)(host_test_cycles() - start) / REPEAT / blocks;
+
+    int16_t decoded[N];
+    uint64_t decode_cycles = 0;
+    for (int b = 0; b < blocks; b++) {
+        if (len[b] == 0) {
+            r.bytes += RAW_BYTES;
+            continue;
+        }
+        r.compressed++;
+        r.bytes += len[b];
+        start = host_test_cycles();
+        for (int rep = 0; rep < REPEAT; rep++) {
+            CHECK_EQ(N, rice_decode(out[b], len[b], decoded, N));
+        }
+        decode_cycles += host_test_cycles() - start;
+        CHECK(memcmp(decoded, samples + b * N, RAW_BYTES) == 0);
+        // Truncado, o fluxo tem que ser recusado, não lido além do fim.
+        CHECK_EQ(0, rice_decode(out[b], len[b] / 2, decoded, N));
+    }
+    r.decode = r.compressed
+                   ? (double)decode_cycles / REPEAT / r.compressed
+                   : 0;
+    printf("%-12s %3d blocks, %3d compressed, ratio %.2f:1, encode %6.0f "
+           "decode %6.0f %s/block\n",
+           name, blocks, r.compressed, (double)RAW_BYTES * blocks / r.bytes,
+           r.encode, r.decode, HOST_TEST_CYCLES_UNIT);
+    return r;
+}
+
+int main(void) {
+    uint32_t rate = 0;
+    long n = wav_load_adc(SAIDA_WAV, samples, MAX_BLOCKS * N, &rate);
+    CHECK(n > 0);
+    if (n > 0) {
+        result_t r = run("saida.wav", (int)(n / N));
+        CHECK_EQ(r.blocks, r.compressed);
+    }
+
+    // Quarto em silêncio: +/-4 LSB em torno do meio da escala.
+    srand(1);
+    for (int i = 0; i < 64 * N; i++) {
+        samples[i] = (int16_t)(2048 + rand() % 9 - 4);
+    }
+    result_t quiet = run("near silence", 64);
+    CHECK_EQ(64, quiet.compressed);
+    CHECK((double)RAW_BYTES * 64 / quiet.bytes > 3.0);
+
+    // Ruído na escala toda do ADC: só os 4 bits de cima, sempre zero, se
+    // ganham.
+    for (int i = 0; i < 64 * N; i++) {
+        samples[i] = (int16_t)(rand() % 4096);
+    }
+    run("12-bit noise", 64);
+
+    // Ruído em 16 bits não comprime: todo bloco cai para o cru.
+    for (int i = 0; i < 64 * N; i++) {
+        samples[i] = (int16_t)(rand() & 0xFFFF);
+    }
+    CHECK_EQ(0, run("16-bit noise", 64).compressed);
+
+    // Saltos de fundo a fundo de escala passam pelo código de escape.
+    for (int i = 0; i < N; i++) {
+        samples[i] = (int16_t)(i & 1 ? 4095 : 0);
+    }
+    static uint8_t big[4 * RAW_BYTES];
+    int16_t decoded[N];
+    size_t len = rice_encode(samples, N, big, sizeof(big));
+    CHECK(len > 0);
+    CHECK_EQ(N, rice_decode(big, len, decoded, N));
+    CHECK(memcmp(decoded, samples, RAW_BYTES) == 0);
+
+    return host_test_result();
+}
@@ -0,0 +1,133 @@
+// Protocolo JSON: o escritor de sensor_json.c contra o caminho antigo com
+// cJSON (criar a árvore, cJSON_PrintUnformatted, liberar), em ns e
+// alocações por leitura. As alocações são contadas com -Wl,--wrap, que só
+// pega as chamadas feitas por este executável, sensor_json.c e cJSON.c.
+// Sem cJSON (HAVE_CJSON, ver CMakeLists.txt) só o escritor é medido.
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "sensor_json.h"
+#ifdef HAVE_CJSON
+#include "cJSON.h"
+#endif
+
+#define REPEAT 200000
+#define LDR_BATCH 8
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *p, size_t size);
+
+static long allocs;
+
+void *__wrap_malloc(size_t size) {
+    allocs++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size) {
+    allocs++;
+    return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *p, size_t size) {
+    allocs++;
+    return __real_realloc(p, size);
+}
+
+static const SensorReading dht[] = {
+    {SENSOR_RECORD_TEMPERATURE, "temperature", 234, 1718000000123},
+    {SENSOR_RECORD_HUMIDITY, "humidity", 552, 1718000000123},
+};
+
+static SensorReading ldr[LDR_BATCH];
+
+typedef size_t (*encode_fn)(const SensorReading *readings, size_t count,
+                            char *buf, size_t capacity);
+
+#ifdef HAVE_CJSON
+// websocket_send_readings antes do escritor: uma entrada por mensagem.
+static size_t cjson_encode(const SensorReading *readings, size_t count,
+                           char *buf, size_t capacity) {
+    cJSON *root = cJSON_CreateObject();
+    cJSON *data = cJSON_CreateArray();
+
+    if (readings[0].type == SENSOR_RECORD_TEMPERATURE && count >= 2) {
+        cJSON *entry = cJSON_CreateObject();
+        cJSON_AddNumberToObject(entry, "temperature", readings[0].value);
+        cJSON_AddNumberToObject(entry, "humidity", readings[1].value);
+        cJSON_AddNumberToObject(entry, "timestamp", readings[0].timestamp);
+        cJSON_AddItemToArray(data, entry);
+
+        cJSON_AddItemToObject(root, "data", data);
+        cJSON_AddStringToObject(root, "type", "dht");
+    } else {
+        cJSON *entry = cJSON_CreateObject();
+        cJSON_AddNumberToObject(entry, "sample", readings->value);
+        cJSON_AddNumberToObject(entry, "timestamp", readings->timestamp);
+        cJSON_AddItemToArray(data, entry);
+
+        cJSON_AddItemToObject(root, "data", data);
+        cJSON_AddStringToObject(root, "type", readings->name);
+    }
+
+    char *json = cJSON_PrintUnformatted(root);
+    size_t len = strlen(json);
+    if (len < capacity) {
+        memcpy(buf, json, len + 1);
+    } else {
+        len = 0;
+    }
+    cJSON_free(json);
+    cJSON_Delete(root);
+    return len;
+}
+#endif
+
+static void run(const char *name, encode_fn encode,
+                const SensorReading *readings, size_t count) {
+    char buf[SENSOR_JSON_MAX_BYTES(LDR_BATCH)];
+    size_t len = 0;
+    allocs = 0;
+    uint64_t start = host_test_now_ns();
+    for (int r = 0; r < REPEAT; r++) {
+        len = encode(readings, count, buf, sizeof(buf));
+    }
+    double ns = (double)(host_test_now_ns() - start) / REPEAT / count;
+    CHECK(len > 0);
+    printf("%-24s %2zu readings, %3zu bytes: %6.1f ns/reading, "
+           "%5.2f allocs/reading\n",
+           name, count, len, ns, (double)allocs / REPEAT / count);
+}
+
+int main(void) {
+    for (int i = 0; i < LDR_BATCH; i++) {
+        ldr[i] = (SensorReading){SENSOR_RECORD_LUMINOSITY, "ldr",
+                                 1000 + 37 * i, 1718000000123 + 100 * i};
+    }
+
+    run("sensor_json dht", sensor_json_encode, dht, 2);
+    CHECK_EQ(0, allocs);
+    run("sensor_json ldr", sensor_json_encode, ldr, 1);
+    CHECK_EQ(0, allocs);
+    run("sensor_json ldr batch", sensor_json_encode, ldr, LDR_BATCH);
+    CHECK_EQ(0, allocs);
+
+#ifdef HAVE_CJSON
+    run("cJSON dht", cjson_encode, dht, 2);
+    run("cJSON ldr", cjson_encode, ldr, 1);
+
+    // Mesma saída, byte a byte, nas mensagens que o caminho antigo montava.
+    char a[SENSOR_JSON_MAX_BYTES(2)], b[SENSOR_JSON_MAX_BYTES(2)];
+    CHECK(sensor_json_encode(dht, 2, a, sizeof(a)) > 0);
+    CHECK(cjson_encode(dht, 2, b, sizeof(b)) > 0);
+    CHECK(strcmp(a, b) == 0);
+    CHECK(sensor_json_encode(ldr, 1, a, sizeof(a)) > 0);
+    CHECK(cjson_encode(ldr, 1, b, sizeof(b)) > 0);
+    CHECK(strcmp(a, b) == 0);
+#else
+    printf("cJSON not available: only the writer was measured\n");
+#endif
+    return host_test_result();
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <inttypes.h>
+#include <stdio.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Verificações mínimas para os testes de host: cada falha é impressa e o
+// teste segue, para mostrar todas as diferenças de uma vez. main() termina
+// com `return host_test_result();`.
+
+static int host_test_failures;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,         \
+                    __LINE__, #cond);                                      \
+            host_test_failures++;                                          \
+        }                                                                  \
+    } while (0)
+
+#define CHECK_EQ(expected, actual)                                         \
+    do {                                                                   \
+        long long e_ = (long long)(expected), a_ = (long long)(actual);    \
+        if (e_ != a_) {                                                    \
+            fprintf(stderr, "%s:%d: %s == %s failed: %lld != %lld\n",      \
+                    __FILE__, __LINE__, #expected, #actual, e_, a_);       \
+            host_test_failures++;                                          \
+        }                                                                  \
+    } while (0)
+
+static inline int host_test_result(void) {
+    if (host_test_failures) {
+        fprintf(stderr, "%d check(s) failed\n", host_test_failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
+
+// Relógio monotônico para os benchmarks, em nanossegundos.
+static inline uint64_t host_test_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Ciclos para os benchmarks: o TSC no x86; nos outros, nanossegundos.
+#if defined(__x86_64__) || defined(__i386__)
+#define HOST_TEST_CYCLES_UNIT "cycles"
+static inline uint64_t host_test_cycles(void) { return __rdtsc(); }
+#else
+#define HOST_TEST_CYCLES_UNIT "ns"
+static inline uint64_t host_test_cycles(void) { return host_test_now_ns(); }
+#endif
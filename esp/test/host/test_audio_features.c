@@ -0,0 +1,133 @@
+// Características acústicas: kernels em ponto fixo contra a conta em ponto
+// flutuante, e tons puros caindo na banda certa.
+#include <math.h>
+#include <stdlib.h>
+
+#include "audio_features.h"
+#include "host_test.h"
+
+#define RATE 8000
+#define N NOISE_SAMPLES_PER_PACKET
+#define AMPLITUDE 1000
+
+static void test_isqrt(void) {
+    static const uint64_t exact[] = {0, 1, 2, 3, 4, 15, 16, 17, 1000000};
+    for (size_t i = 0; i < sizeof(exact) / sizeof(exact[0]); i++) {
+        uint64_t r = (uint64_t)floor(sqrt((double)exact[i]));
+        CHECK_EQ(r, audio_isqrt64(exact[i]));
+    }
+    CHECK_EQ(UINT32_MAX, audio_isqrt64(UINT64_MAX));
+    CHECK_EQ(UINT32_MAX, audio_isqrt64((uint64_t)UINT32_MAX * UINT32_MAX));
+    CHECK_EQ(UINT32_MAX - 1,
+             audio_isqrt64((uint64_t)UINT32_MAX * UINT32_MAX - 1));
+
+    // Raiz inteira por baixo: r^2 <= v < (r+1)^2.
+    srand(7);
+    for (int i = 0; i < 100000; i++) {
+        uint64_t v = (uint64_t)rand() << 33 ^ (uint64_t)rand() << 11 ^ rand();
+        v >>= rand() % 64;
+        uint64_t r = audio_isqrt64(v);
+        CHECK(r * r <= v);
+        CHECK((r + 1) * (r + 1) > v);
+    }
+}
+
+// Log2 com fração linear (até 0,26 dB) e resultado truncado para décimos
+// (até 0,1 dB).
+static void test_power_to_db10(void) {
+    CHECK_EQ(0, audio_power_to_db10(0));
+    CHECK_EQ(0, audio_power_to_db10(1));
+    int worst = 0;
+    for (double d = 2; d < 1e15; d *= 1.037) {
+        uint64_t p = (uint64_t)d;
+        int expected = (int)lround(100 * log10((double)p));
+        int err = abs(audio_power_to_db10(p) - expected);
+        worst = err > worst ? err : worst;
+    }
+    CHECK(worst <= 4);
+}
+
+static void tone(int16_t *x, double freq, int block, int dc) {
+    for (int i = 0; i < N; i++) {
+        x[i] = (int16_t)lrint(dc + AMPLITUDE * sin(2 * M_PI * freq *
+                                                   (block * N + i) / RATE));
+    }
+}
+
+// Um tom no bin devolve A^2, qualquer que seja o tamanho do bloco.
+static void test_goertzel(void) {
+    int32_t x[N];
+    for (int i = 0; i < N; i++) {
+        x[i] = (int32_t)lrint(AMPLITUDE * sin(2 * M_PI * 400 * i / RATE));
+    }
+    int32_t coeff = (int32_t)lrint(2 * cos(2 * M_PI * 400 / RATE) * 16384);
+    double power = (double)audio_goertzel_power(x, N, coeff);
+    CHECK(fabs(10 * log10(power / ((double)AMPLITUDE * AMPLITUDE))) < 0.5);
+    // Bloco vazio: potência zero, sem dividir por zero.
+    CHECK_EQ(0, audio_goertzel_power(x, 0, coeff));
+}
+
+// Cada tom fica na sua banda, com as outras pelo menos 20 dB abaixo.
+static void test_tone_bands(void) {
+    static const struct {
+        double freq;
+        int band;
+    } tones[] = {{200, 0}, {400, 1}, {1200, 2}, {3000, 3}};
+    for (size_t t = 0; t < sizeof(tones) / sizeof(tones[0]); t++) {
+        audio_features_acc_t acc;
+        AudioFeatures f;
+        int16_t x[N];
+        audio_features_reset(&acc);
+        for (int b = 0; b < 4; b++) {
+            tone(x, tones[t].freq, b, 2048);
+            audio_features_add_block(&acc, x, N);
+        }
+        audio_features_finish(&acc, RATE, &f);
+
+        CHECK(abs(f.rms - (int)lround(AMPLITUDE / M_SQRT2)) <= 5);
+        // A média do bloco só é o nível DC com um número inteiro de
+        // períodos; 200 Hz tem 12,5 por bloco e o pico sobe ~2,6%.
+        CHECK(f.peak >= AMPLITUDE && f.peak <= AMPLITUDE * 103 / 100);
+        CHECK(fabs(f.zcr - 2 * tones[t].freq) <= 0.05 * 2 * tones[t].freq);
+        // 60 dB é a potência de um tom de amplitude 1000 (A^2).
+        CHECK(abs(f.band_db10[tones[t].band] - 600) <= 15);
+        for (int b = 0; b < AUDIO_FEATURE_BANDS; b++) {
+            if (b != tones[t].band) {
+                CHECK(f.band_db10[tones[t].band] - f.band_db10[b] >= 200);
+            }
+        }
+    }
+}
+
+static void test_dc_and_empty(void) {
+    audio_features_acc_t acc;
+    AudioFeatures f;
+    int16_t x[N];
+    for (int i = 0; i < N; i++) {
+        x[i] = 3000;
+    }
+    audio_features_reset(&acc);
+    audio_features_add_block(&acc, x, N);
+    // Bloco maior que o pacote é ignorado.
+    audio_features_add_block(&acc, x, N + 1);
+    CHECK_EQ(1, acc.blocks);
+    audio_features_finish(&acc, RATE, &f);
+    CHECK_EQ(0, f.rms);
+    CHECK_EQ(0, f.peak);
+    CHECK_EQ(0, f.zcr);
+
+    audio_features_reset(&acc);
+    audio_features_finish(&acc, RATE, &f);
+    CHECK_EQ(0, f.rms);
+    CHECK_EQ(0, f.band_db10[0]);
+}
+
+int main(void) {
+    audio_features_init(RATE);
+    test_isqrt();
+    test_power_to_db10();
+    test_goertzel();
+    test_tone_bands();
+    test_dc_and_empty();
+    return host_test_result();
+}
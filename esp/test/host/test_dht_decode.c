@@ -0,0 +1,153 @@
+// Decodificador do DHT sobre capturas no formato que o callback do RMT
+// entrega (pares nível/duração, terminados por uma duração 0), montadas com
+// os tempos dos datasheets do DHT11 e do DHT22.
+#include <stdlib.h>
+#include <string.h>
+
+#include "dht_decode.h"
+#include "host_test.h"
+
+#define MAX_PULSES 200
+
+typedef struct {
+    uint16_t host_low;   // resto do pulso de início, já dentro da captura
+    uint16_t response_low;
+    uint16_t response_high;
+    uint16_t bit_low;
+    uint16_t zero_high;
+    uint16_t one_high;
+} dht_timing_t;
+
+// Tempos típicos das folhas de dados, em us.
+static const dht_timing_t dht11 = {18, 83, 87, 54, 24, 71};
+static const dht_timing_t dht22 = {3, 80, 80, 50, 26, 70};
+
+static int jitter(int us) { return us ? rand() % (2 * us + 1) - us : 0; }
+
+// Monta a captura de `data`. `jitter_us` varia cada pulso; com
+// `trailing_low` a captura inclui o baixo final do sensor antes do repouso.
+static size_t capture(dht_pulse_t *p, const dht_timing_t *t,
+                      const uint8_t data[DHT_DATA_BYTES], int jitter_us,
+                      bool trailing_low) {
+    size_t n = 0;
+    p[n++] = (dht_pulse_t){t->host_low, 0};
+    p[n++] = (dht_pulse_t){30, 1};
+    p[n++] = (dht_pulse_t){t->response_low, 0};
+    p[n++] = (dht_pulse_t){t->response_high, 1};
+    for (int i = 0; i < DHT_DATA_BITS; i++) {
+        bool one = data[i / 8] & (0x80 >> (i % 8));
+        p[n++] = (dht_pulse_t){(uint16_t)(t->bit_low + jitter(jitter_us)), 0};
+        p[n++] = (dht_pulse_t){
+            (uint16_t)((one ? t->one_high : t->zero_high) + jitter(jitter_us)),
+            1};
+    }
+    if (trailing_low) {
+        p[n++] = (dht_pulse_t){t->bit_low, 0};
+    }
+    p[n++] = (dht_pulse_t){0, 1};  // fim da captura no RMT
+    return n;
+}
+
+static void frame(uint8_t *d, uint8_t b0, uint8_t b1, uint8_t b2,
+                  uint8_t b3) {
+    d[0] = b0;
+    d[1] = b1;
+    d[2] = b2;
+    d[3] = b3;
+    d[4] = (uint8_t)(b0 + b1 + b2 + b3);
+}
+
+static void test_random_frames(void) {
+    dht_pulse_t p[MAX_PULSES];
+    uint8_t d[DHT_DATA_BYTES], out[DHT_DATA_BYTES];
+    int failures = 0;
+    srand(9);
+    for (int i = 0; i < 10000; i++) {
+        frame(d, (uint8_t)rand(), (uint8_t)rand(), (uint8_t)rand(),
+              (uint8_t)rand());
+        size_t n = capture(p, i & 2 ? &dht22 : &dht11, d, 5, i & 1);
+        if (dht_decode(p, n, out) != DHT_DECODE_OK ||
+            memcmp(out, d, sizeof(d)) != 0) {
+            failures++;
+        }
+    }
+    CHECK_EQ(0, failures);
+}
+
+static void test_values(void) {
+    dht_pulse_t p[MAX_PULSES];
+    uint8_t d[DHT_DATA_BYTES], out[DHT_DATA_BYTES];
+    int16_t humidity, temperature;
+
+    // DHT11: 55 %UR, 23,4 °C.
+    frame(d, 55, 0, 23, 4);
+    CHECK_EQ(DHT_DECODE_OK, dht_decode(p, capture(p, &dht11, d, 0, true), out));
+    dht_decode_values(out, true, &humidity, &temperature);
+    CHECK_EQ(550, humidity);
+    CHECK_EQ(234, temperature);
+
+    // DHT22: 65,2 %UR, -10,1 °C (bit alto da temperatura é o sinal).
+    frame(d, 0x02, 0x8C, 0x80, 0x65);
+    CHECK_EQ(DHT_DECODE_OK,
+             dht_decode(p, capture(p, &dht22, d, 0, false), out));
+    dht_decode_values(out, false, &humidity, &temperature);
+    CHECK_EQ(652, humidity);
+    CHECK_EQ(-101, temperature);
+}
+
+static void test_errors(void) {
+    dht_pulse_t p[MAX_PULSES];
+    uint8_t d[DHT_DATA_BYTES], out[DHT_DATA_BYTES];
+    frame(d, 55, 0, 23, 4);
+    size_t n = capture(p, &dht11, d, 0, true);
+
+    // Baixo esticado no meio dos dados.
+    dht_pulse_t saved = p[20];
+    p[20].duration_us = 300;
+    CHECK_EQ(DHT_DECODE_TIMING, dht_decode(p, n, out));
+    p[20] = saved;
+
+    // Alto longo demais para ser bit.
+    saved = p[21];
+    p[21].duration_us = 150;
+    CHECK_EQ(DHT_DECODE_TIMING, dht_decode(p, n, out));
+
+    // Um bit trocado.
+    p[21].duration_us = saved.duration_us > 48 ? 24 : 71;
+    CHECK_EQ(DHT_DECODE_CHECKSUM, dht_decode(p, n, out));
+    p[21] = saved;
+
+    // Captura cortada no começo dos dados.
+    CHECK_EQ(DHT_DECODE_TOO_SHORT, dht_decode(p + 30, n - 30, out));
+    CHECK_EQ(DHT_DECODE_TOO_SHORT, dht_decode(p, 0, out));
+}
+
+// O RMT às vezes parte um nível em dois símbolos, com uma entrada de duração
+// zero entre eles; os pedaços precisam ser somados.
+static void test_split_runs(void) {
+    dht_pulse_t p[MAX_PULSES], q[MAX_PULSES + 8];
+    uint8_t d[DHT_DATA_BYTES], out[DHT_DATA_BYTES];
+    frame(d, 0x02, 0x8C, 0x80, 0x65);
+    size_t n = capture(p, &dht22, d, 0, true);
+    size_t m = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (i == 30 || i == 51) {  // um alto e um baixo
+            q[m++] = (dht_pulse_t){20, p[i].level};
+            q[m++] = (dht_pulse_t){0, (uint8_t)!p[i].level};
+            q[m++] = (dht_pulse_t){(uint16_t)(p[i].duration_us - 20),
+                                   p[i].level};
+        } else {
+            q[m++] = p[i];
+        }
+    }
+    CHECK_EQ(DHT_DECODE_OK, dht_decode(q, m, out));
+    CHECK(memcmp(out, d, sizeof(d)) == 0);
+}
+
+int main(void) {
+    test_random_frames();
+    test_values();
+    test_errors();
+    test_split_runs();
+    return host_test_result();
+}
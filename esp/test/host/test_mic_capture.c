@@ -0,0 +1,211 @@
+// Montador de blocos do microfone alimentado por um ADC falso no lugar de
+// mic_adc_continuous: quadros de 600 bytes com o padrão microfone/LDR, e
+// quadros perdidos como os que o driver descarta com o pool de DMA cheio.
+#include <string.h>
+
+#include "host_test.h"
+#include "mic_capture.h"
+#include "packet_pool.h"
+
+#define MIC_CHANNEL 4
+#define LDR_CHANNEL 5
+#define LDR_VALUE 1234
+#define DECIMATION 3
+#define FRAME_BYTES 600
+#define FRAME_MIC_CONVERSIONS (FRAME_BYTES / MIC_CONV_BYTES / 2)
+#define FRAME_SAMPLES (FRAME_MIC_CONVERSIONS / DECIMATION)
+#define START_US 1000000
+#define SAMPLE_US (1000000 / NOISE_SAMPLE_RATE_HZ)
+#define MAX_BLOCKS 32
+
+typedef struct {
+    int frames;             // leituras até a HAL retornar erro
+    int reads;
+    uint64_t next_conv;     // próxima conversão do microfone gerada
+    uint32_t lost;
+    // Na leitura `overflow_read` o driver já perdeu `overflow_frames`
+    // quadros, mas ainda entrega `pooled_frames` quadros de antes da perda.
+    int overflow_read;
+    int overflow_frames;
+    int pooled_frames;
+} fake_adc_t;
+
+typedef struct {
+    int count;
+    uint32_t sequence[MAX_BLOCKS];
+    uint64_t time_us[MAX_BLOCKS];
+    int first_value[MAX_BLOCKS];
+} blocks_t;
+
+static int fake_start(void *ctx) { return 0; }
+static int fake_stop(void *ctx) { return 0; }
+static int64_t fake_now_us(void *ctx) { return START_US; }
+
+static uint32_t fake_lost(void *ctx) { return ((fake_adc_t *)ctx)->lost; }
+
+static void put_conv(uint8_t *p, uint8_t channel, uint16_t data) {
+    uint16_t word = (uint16_t)(channel << 12 | (data & 0x0FFF));
+    p[0] = (uint8_t)word;
+    p[1] = (uint8_t)(word >> 8);
+}
+
+// O valor de cada conversão do microfone é o índice da amostra de saída a
+// que ela pertence (em 12 bits), então a média de cada grupo devolve esse
+// índice.
+static int fake_read(void *ctx, uint8_t *buf, size_t len, uint32_t timeout) {
+    fake_adc_t *f = ctx;
+    if (f->reads == f->frames || len < FRAME_BYTES) {
+        return -1;
+    }
+    if (f->reads == f->overflow_read) {
+        f->lost += f->overflow_frames * FRAME_MIC_CONVERSIONS;
+    }
+    if (f->reads == f->overflow_read + f->pooled_frames) {
+        f->next_conv += f->overflow_frames * FRAME_MIC_CONVERSIONS;
+    }
+    f->reads++;
+    for (int i = 0; i < FRAME_MIC_CONVERSIONS; i++) {
+        put_conv(buf + 4 * i, MIC_CHANNEL,
+                 (uint16_t)(f->next_conv++ / DECIMATION));
+        put_conv(buf + 4 * i + 2, LDR_CHANNEL, LDR_VALUE);
+    }
+    return FRAME_BYTES;
+}
+
+static void on_block(SensorPacket *packet, void *arg) {
+    blocks_t *b = arg;
+    if (b->count < MAX_BLOCKS) {
+        b->sequence[b->count] = packet->header.sequence;
+        b->time_us[b->count] = packet->header.capture_time_us;
+        b->first_value[b->count] = packet->samples[0];
+        b->count++;
+    }
+    packet_pool_release(packet);
+}
+
+static void run(fake_adc_t *fake, mic_assembler_t *a, blocks_t *blocks) {
+    static uint8_t frame[FRAME_BYTES];
+    mic_adc_hal_t hal = {
+        .start = fake_start,
+        .stop = fake_stop,
+        .read_frame = fake_read,
+        .now_us = fake_now_us,
+        .lost_conversions = fake_lost,
+        .ctx = fake,
+    };
+    packet_pool_init();
+    memset(blocks, 0, sizeof(*blocks));
+    mic_assembler_init(a, MIC_CHANNEL, LDR_CHANNEL, DECIMATION, on_block,
+                       blocks);
+    CHECK_EQ(-1, mic_capture_run(&hal, a, frame, sizeof(frame)));
+    // Nenhum buffer fica preso no montador, nem o do bloco descartado.
+    CHECK_EQ(PACKET_POOL_SIZE, packet_pool_free_count() + (a->packet != NULL));
+}
+
+static void check_block(const blocks_t *b, int i, int first_sample) {
+    CHECK_EQ(first_sample / NOISE_SAMPLES_PER_PACKET, b->sequence[i]);
+    CHECK_EQ(START_US + (int64_t)first_sample * SAMPLE_US, b->time_us[i]);
+    CHECK_EQ(MIC_CONV_DATA(first_sample), b->first_value[i]);
+}
+
+static void test_continuous(void) {
+    fake_adc_t fake = {.frames = 100, .overflow_read = -1};
+    mic_assembler_t a;
+    blocks_t blocks;
+    run(&fake, &a, &blocks);
+
+    CHECK_EQ(100 * FRAME_SAMPLES / NOISE_SAMPLES_PER_PACKET, blocks.count);
+    for (int i = 0; i < blocks.count; i++) {
+        check_block(&blocks, i, i * NOISE_SAMPLES_PER_PACKET);
+    }
+    CHECK_EQ(0, a.dropped_blocks);
+    CHECK_EQ(0, a.lost_conversions);
+    CHECK_EQ(0, a.foreign_conversions);
+    CHECK_EQ(LDR_VALUE, a.aux_last);
+}
+
+// A perda é vista antes do primeiro quadro depois do buraco: o bloco em
+// montagem (amostras 1000 a 1249) vai embora e o seguinte começa na amostra
+// 1400, com a sequência e o tempo dela.
+static void test_overflow(void) {
+    fake_adc_t fake = {
+        .frames = 60, .overflow_read = 25, .overflow_frames = 3};
+    mic_assembler_t a;
+    blocks_t blocks;
+    run(&fake, &a, &blocks);
+
+    CHECK_EQ(5, blocks.count);
+    check_block(&blocks, 0, 0);
+    check_block(&blocks, 1, 500);
+    check_block(&blocks, 2, 1400);
+    check_block(&blocks, 3, 1900);
+    check_block(&blocks, 4, 2400);
+    CHECK_EQ(1, a.dropped_blocks);
+    CHECK_EQ(3 * FRAME_MIC_CONVERSIONS, a.lost_conversions);
+    CHECK_EQ(60 * FRAME_MIC_CONVERSIONS + 3 * FRAME_MIC_CONVERSIONS,
+             a.conversions);
+}
+
+// Com dois quadros de antes da perda ainda no pool, o bloco que os usa
+// recebe o tempo de depois do buraco, mas a contagem total se mantém e o
+// bloco seguinte volta ao tempo certo.
+static void test_overflow_with_pooled_frames(void) {
+    fake_adc_t fake = {.frames = 60,
+                       .overflow_read = 25,
+                       .overflow_frames = 3,
+                       .pooled_frames = 2};
+    mic_assembler_t a;
+    blocks_t blocks;
+    run(&fake, &a, &blocks);
+
+    CHECK_EQ(5, blocks.count);
+    check_block(&blocks, 1, 500);
+    CHECK_EQ(2, blocks.sequence[2]);
+    CHECK_EQ(START_US + 1400 * SAMPLE_US, blocks.time_us[2]);
+    CHECK_EQ(1250, blocks.first_value[2]);
+    check_block(&blocks, 3, 1900);
+    check_block(&blocks, 4, 2400);
+    CHECK_EQ(1, a.dropped_blocks);
+    CHECK_EQ(3 * FRAME_MIC_CONVERSIONS, a.lost_conversions);
+}
+
+// Sem buffer livre o bloco é descartado; os seguintes mantêm a sequência.
+static void test_pool_exhausted(void) {
+    SensorPacket *held[PACKET_POOL_SIZE];
+    mic_assembler_t a;
+    blocks_t blocks;
+    memset(&blocks, 0, sizeof(blocks));
+    packet_pool_init();
+    mic_assembler_init(&a, MIC_CHANNEL, LDR_CHANNEL, DECIMATION, on_block,
+                       &blocks);
+    for (int i = 0; i < PACKET_POOL_SIZE; i++) {
+        held[i] = packet_pool_acquire();
+    }
+
+    fake_adc_t fake = {.frames = 1000, .overflow_read = -1};
+    uint8_t frame[FRAME_BYTES];
+    for (int i = 0; i < 10; i++) {  // primeiro bloco, sem buffer
+        int len = fake_read(&fake, frame, sizeof(frame), 0);
+        mic_assembler_feed(&a, frame, (size_t)len);
+    }
+    for (int i = 0; i < PACKET_POOL_SIZE; i++) {
+        packet_pool_release(held[i]);
+    }
+    for (int i = 0; i < 10; i++) {
+        int len = fake_read(&fake, frame, sizeof(frame), 0);
+        mic_assembler_feed(&a, frame, (size_t)len);
+    }
+
+    CHECK_EQ(1, a.dropped_blocks);
+    CHECK_EQ(1, blocks.count);
+    CHECK_EQ(1, blocks.sequence[0]);
+    CHECK_EQ(500, blocks.first_value[0]);
+}
+
+int main(void) {
+    test_continuous();
+    test_overflow();
+    test_overflow_with_pooled_frames();
+    test_pool_exhausted();
+    return host_test_result();
+}
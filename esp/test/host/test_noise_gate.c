@@ -0,0 +1,124 @@
+// Portão de ruído alimentado por áudio montado a partir de api/saida.wav:
+// a gravação entra duas vezes em 30 s de ruído de fundo, e os eventos
+// precisam começar no bloco em que ela entra e acabar logo depois dela. Um
+// degrau permanente no ruído de fundo abre um único evento, que fecha quando
+// o piso alcança o novo nível.
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "noise_gate.h"
+#include "wav.h"
+
+#define N NOISE_SAMPLES_PER_PACKET
+#define BLOCKS_PER_S (NOISE_SAMPLE_RATE_HZ / N)
+#define THRESHOLD_DB 12      // padrão de MIC_GATE_THRESHOLD_DB
+#define HANGOVER_BLOCKS 16   // MIC_GATE_HANGOVER_MS padrão (1 s)
+#define MAX_SAMPLES (1 << 16)
+#define TRACK_S 30
+#define TRACK_SAMPLES (TRACK_S * NOISE_SAMPLE_RATE_HZ)
+#define MAX_EVENTS 8
+
+static int16_t clip[MAX_SAMPLES];
+static int16_t track[TRACK_SAMPLES];
+
+typedef struct {
+    int count;
+    int start[MAX_EVENTS];  // blocos
+    int end[MAX_EVENTS];
+    int heartbeat_events;
+    int heartbeat_blocks;
+} events_t;
+
+// Ruído uniforme em +/-`half` LSB em torno do meio da escala (RMS ~3 LSB
+// para half = 5).
+static void background(int from, int to, int half) {
+    for (int i = from; i < to; i++) {
+        track[i] = (int16_t)(2048 + rand() % (2 * half + 1) - half);
+    }
+}
+
+static void mix(const int16_t *x, long n, int at) {
+    for (long i = 0; i < n && at + i < TRACK_SAMPLES; i++) {
+        track[at + i] = (int16_t)(track[at + i] + x[i] - 2048);
+    }
+}
+
+static void run(events_t *ev) {
+    noise_gate_t gate;
+    memset(ev, 0, sizeof(*ev));
+    noise_gate_init(&gate, THRESHOLD_DB, HANGOVER_BLOCKS);
+    for (int b = 0; b < TRACK_SAMPLES / N; b++) {
+        noise_gate_event_t e = noise_gate_feed(&gate, track + b * N, N);
+        if (e == NOISE_GATE_START && ev->count < MAX_EVENTS) {
+            ev->start[ev->count] = b;
+            ev->end[ev->count] = -1;
+            ev->count++;
+        } else if (e == NOISE_GATE_END && ev->count > 0) {
+            ev->end[ev->count - 1] = b;
+        }
+        // Batimento a cada 10 s, como o MIC_GATE_HEARTBEAT_MS padrão.
+        if (b % (10 * BLOCKS_PER_S) == 10 * BLOCKS_PER_S - 1) {
+            NoiseGateStats stats;
+            noise_gate_take_stats(&gate, &stats);
+            ev->heartbeat_events += stats.events;
+            ev->heartbeat_blocks += stats.blocks;
+            CHECK(stats.rms_min_q4 <= stats.rms_mean_q4);
+            CHECK(stats.rms_mean_q4 <= stats.rms_max_q4);
+        }
+    }
+    for (int i = 0; i < ev->count; i++) {
+        printf("event %d: %.2f s -> %.2f s\n", i,
+               (double)ev->start[i] / BLOCKS_PER_S,
+               (double)ev->end[i] / BLOCKS_PER_S);
+    }
+}
+
+static void test_clips(const int16_t *x, long n) {
+    int at[2] = {10 * NOISE_SAMPLE_RATE_HZ, 22 * NOISE_SAMPLE_RATE_HZ};
+    srand(3);
+    background(0, TRACK_SAMPLES, 5);
+    mix(x, n, at[0]);
+    mix(x, n, at[1]);
+
+    events_t ev;
+    run(&ev);
+    CHECK_EQ(2, ev.count);
+    for (int i = 0; i < 2 && i < ev.count; i++) {
+        // Abre no bloco em que a gravação entra...
+        CHECK_EQ(at[i] / N, ev.start[i]);
+        // ...e fecha até 1,5 s depois do fim dela (espera de 1 s).
+        int clip_end = (int)((at[i] + n) / N);
+        CHECK(ev.end[i] >= clip_end);
+        CHECK(ev.end[i] <= clip_end + 3 * BLOCKS_PER_S / 2);
+    }
+    CHECK_EQ(2, ev.heartbeat_events);
+    CHECK_EQ(TRACK_SAMPLES / N, ev.heartbeat_blocks);
+}
+
+// Um degrau de 16 dB no ambiente (um ventilador que liga) abre um evento
+// só; o piso sobe devagar durante o evento e o portão fecha sozinho.
+static void test_ambient_step(void) {
+    srand(4);
+    background(0, 5 * NOISE_SAMPLE_RATE_HZ, 5);
+    background(5 * NOISE_SAMPLE_RATE_HZ, TRACK_SAMPLES, 32);
+
+    events_t ev;
+    run(&ev);
+    CHECK_EQ(1, ev.count);
+    CHECK_EQ(5 * BLOCKS_PER_S, ev.start[0]);
+    CHECK(ev.end[0] > 0);
+    CHECK(ev.end[0] < TRACK_SAMPLES / N);
+}
+
+int main(void) {
+    uint32_t rate = 0;
+    long n = wav_load_adc(SAIDA_WAV, clip, MAX_SAMPLES, &rate);
+    CHECK(n > 0);
+    CHECK_EQ(NOISE_SAMPLE_RATE_HZ, rate);
+    if (n > 0) {
+        test_clips(clip, n);
+    }
+    test_ambient_step();
+    return host_test_result();
+}
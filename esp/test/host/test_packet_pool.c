@@ -0,0 +1,143 @@
+// Pool de pacotes sob disputa: várias threads pegam e devolvem buffers ao
+// mesmo tempo. Cada buffer tem um dono registrado fora do pool; se o pool
+// entregar o mesmo buffer a duas threads, ou perder um, o teste vê.
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include "host_test.h"
+#include "packet_pool.h"
+
+#define THREADS 4
+#define ITERATIONS 200000
+#define HOLD_MAX 4  // buffers que cada thread segura de uma vez
+
+static atomic_int owner[PACKET_POOL_SIZE];  // 0: livre; senão thread + 1
+static atomic_int collisions;
+static atomic_int corrupted;
+
+static SensorPacket *slots[PACKET_POOL_SIZE];  // os buffers do pool
+
+static int slot_of(SensorPacket *p) {
+    for (int i = 0; i < PACKET_POOL_SIZE; i++) {
+        if (slots[i] == p) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void *worker(void *arg) {
+    int id = (int)(intptr_t)arg + 1;
+    SensorPacket *held[HOLD_MAX];
+    int count = 0;
+    unsigned seed = (unsigned)id;
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        if (count < HOLD_MAX && (count == 0 || rand_r(&seed) & 1)) {
+            SensorPacket *p = packet_pool_acquire();
+            if (p == NULL) {
+                continue;
+            }
+            int slot = slot_of(p);
+            if (slot < 0 || atomic_exchange(&owner[slot], id) != 0) {
+                atomic_fetch_add(&collisions, 1);
+                continue;
+            }
+            // Marca o buffer; outra thread com o mesmo buffer estragaria a
+            // marca antes da devolução.
+            p->header.sequence = (uint32_t)i;
+            p->samples[0] = (int16_t)id;
+            held[count++] = p;
+        } else if (count > 0) {
+            SensorPacket *p = held[--count];
+            int slot = slot_of(p);
+            if (p->samples[0] != id) {
+                atomic_fetch_add(&corrupted, 1);
+            }
+            atomic_store(&owner[slot], 0);
+            packet_pool_release(p);
+        }
+        if ((i & 0xFF) == 0) {
+            sched_yield();
+        }
+    }
+    while (count > 0) {
+        SensorPacket *p = held[--count];
+        atomic_store(&owner[slot_of(p)], 0);
+        packet_pool_release(p);
+    }
+    return NULL;
+}
+
+// Pega todos os buffers de uma vez: precisam ser PACKET_POOL_SIZE distintos.
+static void check_all_distinct(SensorPacket **out) {
+    for (int i = 0; i < PACKET_POOL_SIZE; i++) {
+        out[i] = packet_pool_acquire();
+        CHECK(out[i] != NULL);
+        for (int j = 0; j < i; j++) {
+            CHECK(out[i] != out[j]);
+        }
+    }
+    CHECK(packet_pool_acquire() == NULL);
+}
+
+static void test_concurrent(void) {
+    packet_pool_init();
+    check_all_distinct(slots);
+    for (int i = 0; i < PACKET_POOL_SIZE; i++) {
+        packet_pool_release(slots[i]);
+    }
+
+    pthread_t threads[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        pthread_create(&threads[i], NULL, worker, (void *)(intptr_t)i);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    packet_pool_stats_t stats;
+    packet_pool_get_stats(&stats);
+    printf("%u acquires, %u exhausted, min free %u\n", stats.acquired,
+           stats.exhausted, stats.min_free);
+    CHECK_EQ(0, atomic_load(&collisions));
+    CHECK_EQ(0, atomic_load(&corrupted));
+    CHECK_EQ(stats.acquired, stats.released);
+    CHECK_EQ(0, stats.double_free);
+    CHECK_EQ(0, stats.invalid_release);
+    CHECK_EQ(PACKET_POOL_SIZE, packet_pool_free_count());
+
+    // Nenhum buffer se perdeu nem apareceu duas vezes na lista livre.
+    SensorPacket *all[PACKET_POOL_SIZE];
+    check_all_distinct(all);
+    for (int i = 0; i < PACKET_POOL_SIZE; i++) {
+        CHECK(slot_of(all[i]) >= 0);
+        packet_pool_release(all[i]);
+    }
+}
+
+// Devoluções erradas são contadas e não corrompem a lista livre.
+static void test_bad_release(void) {
+    packet_pool_init();
+    SensorPacket *p = packet_pool_acquire();
+    SensorPacket outside;
+    packet_pool_release(p);
+    packet_pool_release(p);
+    packet_pool_release(&outside);
+
+    packet_pool_stats_t stats;
+    packet_pool_get_stats(&stats);
+    CHECK_EQ(1, stats.double_free);
+    CHECK_EQ(1, stats.invalid_release);
+    CHECK_EQ(PACKET_POOL_SIZE, packet_pool_free_count());
+    SensorPacket *all[PACKET_POOL_SIZE];
+    check_all_distinct(all);
+}
+
+int main(void) {
+    test_concurrent();
+    test_bad_release();
+    return host_test_result();
+}
@@ -0,0 +1,236 @@
+// Controle de qualidade contra um enlace simulado, em tempo virtual: a cada
+// 62,5 ms sai um bloco do nível em uso; o envio espera espaço no buffer do
+// socket, que escoa na vazão da fase, e desiste no prazo de
+// CONFIG_WS_SEND_TIMEOUT_MS (o cliente derruba a conexão e o buffer se
+// perde). Com a escritora atrasada mais que a fila de áudio, o bloco é
+// descartado. O nível tem que acompanhar cada fase e voltar ao máximo
+// quando o enlace se recupera.
+#include <string.h>
+
+#include "adpcm.h"
+#include "audio_codec.h"
+#include "audio_features.h"
+#include "host_test.h"
+#include "quality_ctl.h"
+#include "sensor_frame.h"
+
+// Tamanhos como em quality_setup() de main.c.
+#define BLOCKS_PER_S (NOISE_SAMPLE_RATE_HZ / NOISE_SAMPLES_PER_PACKET)
+#define BLOCK_US (1000000 / BLOCKS_PER_S)
+#define FRAME_OVERHEAD (sizeof(SensorFrameHeader) + sizeof(SensorRecordHeader))
+#define RAW_PACKET_BYTES(n) (sizeof(SensorPacketHeader) + (n) * sizeof(int16_t))
+#define ADPCM_PACKET_BYTES(n)                                \
+    (sizeof(SensorPacketHeader) + sizeof(AdpcmBlockHeader) + \
+     ADPCM_CODE_BYTES(n))
+
+// Padrões do Kconfig.
+#define SEND_TIMEOUT_US 500000   // WS_SEND_TIMEOUT_MS
+#define AUDIO_QUEUE_LEN 8        // WS_AUDIO_QUEUE_LEN
+#define DOWN_BUSY_PCT 60         // MIC_QUALITY_DOWN_BUSY_PCT
+#define UP_WINDOWS 5             // MIC_QUALITY_UP_WINDOWS
+#define FEATURE_WINDOW_BLOCKS 4  // MIC_FEATURE_WINDOW_BLOCKS
+
+#define SOCKET_BUFFER 5744  // TCP_SND_BUF padrão do lwIP
+#define SEND_COST_US 300    // custo fixo de um envio
+
+typedef struct {
+    uint32_t bytes_per_s;
+    uint32_t seconds;
+    quality_level_t expected;  // nível do regime
+} phase_t;
+
+// Com DOWN_BUSY_PCT = 60 um nível cabe se gera até 60% da vazão; cada fase
+// fica entre o que o nível esperado precisa e o que o nível acima gera, e
+// as sondas para o nível acima congestionam de fato.
+static const phase_t phases[] = {
+    {60000, 60, QUALITY_FULL},       {15000, 60, QUALITY_DECIMATED},
+    {6000, 60, QUALITY_COMPRESSED},  {1000, 60, QUALITY_FEATURES},
+    {15000, 120, QUALITY_DECIMATED}, {60000, 120, QUALITY_FULL},
+    {0, 30, QUALITY_FEATURES},       {60000, 120, QUALITY_FULL},
+};
+#define PHASES (sizeof(phases) / sizeof(phases[0]))
+
+#define TOTAL_BLOCKS (1200 * BLOCKS_PER_S)
+
+typedef struct {
+    uint8_t level[TOTAL_BLOCKS];  // nível de cada bloco gerado
+    uint32_t blocks;
+    uint32_t level_blocks[PHASES][QUALITY_LEVELS];  // segunda metade
+    uint32_t timeouts[PHASES];
+    uint32_t drops[PHASES];
+} trace_t;
+
+static quality_ctl_config_t config(void) {
+    quality_ctl_config_t c = {
+        .window_us = 1000000,
+        .level_bytes_per_s =
+            {
+                [QUALITY_FULL] =
+                    (RAW_PACKET_BYTES(NOISE_SAMPLES_PER_PACKET) +
+                     FRAME_OVERHEAD) *
+                    BLOCKS_PER_S,
+                [QUALITY_DECIMATED] =
+                    (RAW_PACKET_BYTES(NOISE_SAMPLES_PER_PACKET / 2) +
+                     FRAME_OVERHEAD) *
+                    BLOCKS_PER_S,
+                [QUALITY_COMPRESSED] =
+                    (ADPCM_PACKET_BYTES(NOISE_SAMPLES_PER_PACKET / 2) +
+                     FRAME_OVERHEAD) *
+                    BLOCKS_PER_S,
+                [QUALITY_FEATURES] =
+                    (sizeof(SensorFeaturePacket) + FRAME_OVERHEAD) *
+                    BLOCKS_PER_S / FEATURE_WINDOW_BLOCKS,
+            },
+        .down_busy_pct = DOWN_BUSY_PCT,
+        .up_windows = UP_WINDOWS,
+    };
+    return c;
+}
+
+static void simulate(trace_t *trace) {
+    quality_ctl_config_t cfg = config();
+    quality_ctl_t ctl;
+    quality_ctl_init(&ctl, &cfg, 0);
+    quality_level_t level = QUALITY_FULL;
+    uint64_t writer_free = 0;  // fim do último envio
+    uint64_t drained_at = 0;
+    double fill = 0;           // bytes no buffer do socket
+    uint32_t block = 0;
+    memset(trace, 0, sizeof(*trace));
+
+    for (size_t p = 0; p < PHASES; p++) {
+        const double rate = phases[p].bytes_per_s;
+        for (uint32_t b = 0; b < phases[p].seconds * BLOCKS_PER_S; b++) {
+            uint64_t made = (uint64_t)block * BLOCK_US;
+            trace->level[block++] = (uint8_t)level;
+            if (b >= phases[p].seconds * BLOCKS_PER_S / 2) {
+                trace->level_blocks[p][level]++;
+            }
+
+            // O nível de características só envia a cada janela.
+            if (level == QUALITY_FEATURES &&
+                block % FEATURE_WINDOW_BLOCKS != 0) {
+                level = quality_ctl_update(&ctl, writer_free > made
+                                                     ? writer_free
+                                                     : made);
+                continue;
+            }
+            if (writer_free > made + AUDIO_QUEUE_LEN * BLOCK_US) {
+                quality_ctl_record_drop(&ctl);
+                trace->drops[p]++;
+                continue;
+            }
+
+            uint64_t start = writer_free > made ? writer_free : made;
+            fill -= rate * (start - drained_at) / 1e6;
+            fill = fill < 0 ? 0 : fill;
+            drained_at = start;
+
+            uint32_t bytes = cfg.level_bytes_per_s[level] / BLOCKS_PER_S;
+            if (level == QUALITY_FEATURES) {
+                bytes *= FEATURE_WINDOW_BLOCKS;
+            }
+            double wait_us = fill + bytes <= SOCKET_BUFFER
+                                 ? 0
+                                 : rate > 0 ? (fill + bytes - SOCKET_BUFFER) /
+                                                  rate * 1e6
+                                            : SEND_TIMEOUT_US;
+            uint32_t latency = SEND_COST_US + (uint32_t)wait_us;
+            bool timed_out = latency >= SEND_TIMEOUT_US;
+            if (timed_out) {
+                latency = SEND_TIMEOUT_US;
+                fill = 0;  // conexão derrubada; reconecta vazia
+                trace->timeouts[p]++;
+                drained_at = start + latency;
+            } else if (wait_us > 0) {
+                fill = SOCKET_BUFFER;  // cheio no instante em que o envio sai
+                drained_at = start + (uint64_t)wait_us;
+            } else {
+                fill += bytes;
+            }
+            quality_ctl_record_send(&ctl, bytes, latency, timed_out);
+            writer_free = start + latency;
+            level = quality_ctl_update(&ctl, writer_free);
+        }
+    }
+    trace->blocks = block;
+}
+
+// Com o codec ADPCM o nível decimado gera o mesmo que o comprimido: a
+// descida passa direto por ele e a subida também.
+static void test_equal_level_skipped(void) {
+    quality_ctl_config_t cfg = config();
+    cfg.level_bytes_per_s[QUALITY_FULL] =
+        (ADPCM_PACKET_BYTES(NOISE_SAMPLES_PER_PACKET) + FRAME_OVERHEAD) *
+        BLOCKS_PER_S;
+    cfg.level_bytes_per_s[QUALITY_DECIMATED] =
+        cfg.level_bytes_per_s[QUALITY_COMPRESSED];
+    quality_ctl_t ctl;
+    quality_ctl_init(&ctl, &cfg, 0);
+
+    // Vazão que não leva o nível máximo mas leva o decimado.
+    uint64_t t = 0;
+    uint32_t capacity = cfg.level_bytes_per_s[QUALITY_FULL] * 100 /
+                        DOWN_BUSY_PCT * 9 / 10;
+    quality_ctl_record_send(&ctl, capacity * 9 / 10, 900000, false);
+    t += 1000000;
+    CHECK_EQ(QUALITY_COMPRESSED, quality_ctl_update(&ctl, t));
+
+    // Janelas folgadas: a sonda sobe direto ao máximo.
+    quality_level_t level = QUALITY_COMPRESSED;
+    for (int w = 0; w < 2 * UP_WINDOWS && level != QUALITY_FULL; w++) {
+        t += 1000000;
+        level = quality_ctl_update(&ctl, t);
+        CHECK(level != QUALITY_DECIMATED);
+    }
+    CHECK_EQ(QUALITY_FULL, level);
+}
+
+static trace_t first, second;
+
+int main(void) {
+    quality_ctl_config_t cfg = config();
+    simulate(&first);
+
+    size_t block = 0;
+    for (size_t p = 0; p < PHASES; p++) {
+        uint32_t n = phases[p].seconds * BLOCKS_PER_S;
+        quality_level_t last = (quality_level_t)first.level[block + n - 1];
+        printf("%6u B/s %4us: second half per level %u/%u/%u/%u blocks, "
+               "level %d at end, %u timeouts, %u drops\n",
+               phases[p].bytes_per_s, phases[p].seconds,
+               first.level_blocks[p][0], first.level_blocks[p][1],
+               first.level_blocks[p][2], first.level_blocks[p][3], last,
+               first.timeouts[p], first.drops[p]);
+
+        // Fora as sondas e a volta depois delas, o regime fica no nível
+        // esperado.
+        quality_level_t expected = phases[p].expected;
+        CHECK(first.level_blocks[p][expected] * 4 >= (n / 2) * 3);
+        if (expected == QUALITY_FULL || phases[p].bytes_per_s == 0) {
+            CHECK_EQ(expected, last);
+        }
+        if (expected > QUALITY_FULL) {
+            CHECK(cfg.level_bytes_per_s[expected - 1] >
+                  phases[p].bytes_per_s);
+        }
+        if (expected < QUALITY_FEATURES) {
+            CHECK(cfg.level_bytes_per_s[expected] * 100 <=
+                  phases[p].bytes_per_s * DOWN_BUSY_PCT);
+        }
+        block += n;
+    }
+    // Enlace de sobra: nada se perde e o nível não sai do máximo.
+    CHECK_EQ(0, first.timeouts[0] + first.drops[0]);
+    for (uint32_t b = 0; b < phases[0].seconds * BLOCKS_PER_S; b++) {
+        CHECK_EQ(QUALITY_FULL, first.level[b]);
+    }
+
+    // Determinístico: a mesma entrada dá a mesma sequência de níveis.
+    simulate(&second);
+    CHECK_EQ(first.blocks, second.blocks);
+    CHECK(memcmp(first.level, second.level, first.blocks) == 0);
+
+    test_equal_level_skipped();
+    return host_test_result();
+}
@@ -0,0 +1,206 @@
+// Codificador do quadro multiplexado: bytes do cabeçalho e dos registros
+// conferidos contra os formatos de api/sensor_packet.py ('<BBBBI', '<BBH',
+// '<qi'), limite de espaço e de 255 registros, e a cauda reservada, que
+// tira espaço do buffer até ser fechada. Cada quadro é lido de volta como
+// parse_frame lê: registros encadeados até exatamente o fim do quadro.
+#include <string.h>
+
+#include "host_test.h"
+#include "sensor_frame.h"
+
+#define BOOT_ID 0x11223344u
+
+static uint8_t buf[SENSOR_FRAME_MAX_BYTES];
+static uint8_t big[8 + 300 * 4];
+
+static uint16_t le16(const uint8_t *p) { return p[0] | p[1] << 8; }
+
+static uint32_t le32(const uint8_t *p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint64_t le64(const uint8_t *p) {
+    return le32(p) | (uint64_t)le32(p + 4) << 32;
+}
+
+// Percorre os registros como parse_frame; retorna quantos bytes consumiu,
+// ou 0 se algum registro passar do fim.
+static size_t walk(const uint8_t *raw, size_t len) {
+    size_t pos = 8;
+    for (unsigned i = 0; i < raw[1]; i++) {
+        if (pos + 4 > len || pos + 4 + le16(raw + pos + 2) > len) {
+            return 0;
+        }
+        pos += 4 + le16(raw + pos + 2);
+    }
+    return pos;
+}
+
+static SensorReading reading(uint8_t type, int value, int64_t timestamp) {
+    return (SensorReading){.type = type, .value = value,
+                           .timestamp = timestamp};
+}
+
+static void test_layout(void) {
+    CHECK_EQ(8, sizeof(SensorFrameHeader));
+    CHECK_EQ(4, sizeof(SensorRecordHeader));
+    CHECK_EQ(12, sizeof(SensorScalarRecord));
+
+    sensor_frame_t frame;
+    sensor_frame_begin(&frame, buf, sizeof(buf), BOOT_ID);
+    CHECK_EQ(8, frame.len);
+    CHECK_EQ(0, sensor_frame_records(&frame));
+
+    SensorReading r = reading(SENSOR_RECORD_TEMPERATURE, -125,
+                              0x0102030405060708LL);
+    CHECK(sensor_frame_add_reading(&frame, &r));
+    uint8_t payload[3] = {0xAA, 0xBB, 0xCC};
+    CHECK(sensor_frame_add(&frame, SENSOR_PACKET_TYPE_FEATURES, payload,
+                           sizeof(payload)));
+    CHECK_EQ(8 + 4 + 12 + 4 + 3, frame.len);
+    CHECK_EQ(2, sensor_frame_records(&frame));
+
+    // Cabeçalho '<BBBBI': versão, registros, flags, reservado, boot_id.
+    CHECK_EQ(SENSOR_FRAME_VERSION, buf[0]);
+    CHECK_EQ(2, buf[1]);
+    CHECK_EQ(0, buf[2]);
+    CHECK_EQ(0, buf[3]);
+    CHECK_EQ(BOOT_ID, le32(buf + 4));
+    // flags no mesmo deslocamento que em SensorPacketHeader.
+    CHECK_EQ(offsetof(SensorPacketHeader, flags),
+             offsetof(SensorFrameHeader, flags));
+
+    // Registro '<BBH' + escalar '<qi'.
+    const uint8_t *p = buf + 8;
+    CHECK_EQ(SENSOR_RECORD_TEMPERATURE, p[0]);
+    CHECK_EQ(0, p[1]);
+    CHECK_EQ(12, le16(p + 2));
+    CHECK_EQ(0x0102030405060708LL, (int64_t)le64(p + 4));
+    CHECK_EQ(-125, (int32_t)le32(p + 12));
+
+    p += 4 + 12;
+    CHECK_EQ(SENSOR_PACKET_TYPE_FEATURES, p[0]);
+    CHECK_EQ(0, p[1]);
+    CHECK_EQ(3, le16(p + 2));
+    CHECK(memcmp(p + 4, payload, sizeof(payload)) == 0);
+
+    CHECK_EQ(frame.len, walk(buf, frame.len));
+}
+
+// Um pacote de áudio cru e 16 leituras enchem SENSOR_FRAME_MAX_BYTES; a
+// 17ª leitura fica para o próximo quadro sem mexer neste.
+static void test_full_frame(void) {
+    static SensorPacket packet;
+    memset(&packet, 0x5A, sizeof(packet));
+
+    sensor_frame_t frame;
+    sensor_frame_begin(&frame, buf, sizeof(buf), BOOT_ID);
+    CHECK(sensor_frame_add(&frame, SENSOR_PACKET_TYPE_AUDIO, &packet,
+                           sizeof(packet)));
+    for (int i = 0; i < 16; i++) {
+        SensorReading r = reading(SENSOR_RECORD_LUMINOSITY, i, 1000 + i);
+        CHECK(sensor_frame_add_reading(&frame, &r));
+    }
+    CHECK_EQ(SENSOR_FRAME_MAX_BYTES, frame.len);
+    CHECK_EQ(17, sensor_frame_records(&frame));
+
+    uint8_t before[SENSOR_FRAME_MAX_BYTES];
+    memcpy(before, buf, sizeof(buf));
+    SensorReading extra = reading(SENSOR_RECORD_HUMIDITY, 1, 2);
+    CHECK(!sensor_frame_add_reading(&frame, &extra));
+    CHECK(!sensor_frame_add(&frame, SENSOR_RECORD_HUMIDITY, NULL, 0));
+    CHECK_EQ(SENSOR_FRAME_MAX_BYTES, frame.len);
+    CHECK_EQ(17, sensor_frame_records(&frame));
+    CHECK(memcmp(before, buf, sizeof(buf)) == 0);
+
+    CHECK_EQ(frame.len, walk(buf, frame.len));
+    const uint8_t *last = buf + frame.len - 12;
+    CHECK_EQ(1015, (int64_t)le64(last));
+    CHECK_EQ(15, (int32_t)le32(last + 8));
+}
+
+// record_count é um byte: o 256º registro é recusado mesmo com espaço, e a
+// cauda reservada já conta como um.
+static void test_record_limit(void) {
+    sensor_frame_t frame;
+    sensor_frame_begin(&frame, big, sizeof(big), BOOT_ID);
+    for (int i = 0; i < 255; i++) {
+        CHECK(sensor_frame_add(&frame, SENSOR_RECORD_LUMINOSITY, NULL, 0));
+    }
+    CHECK_EQ(255, sensor_frame_records(&frame));
+    CHECK(!sensor_frame_add(&frame, SENSOR_RECORD_LUMINOSITY, NULL, 0));
+    CHECK_EQ(255, sensor_frame_records(&frame));
+    CHECK_EQ(8 + 255 * 4, frame.len);
+    CHECK_EQ(frame.len, walk(big, frame.len));
+
+    sensor_frame_begin(&frame, big, sizeof(big), BOOT_ID);
+    CHECK(sensor_frame_reserve_tail(&frame, 0));
+    int added = 0;
+    while (sensor_frame_add(&frame, SENSOR_RECORD_LUMINOSITY, NULL, 0)) {
+        added++;
+    }
+    CHECK_EQ(254, added);
+    sensor_frame_add_tail(&frame, SENSOR_PACKET_TYPE_AUDIO);
+    CHECK_EQ(255, sensor_frame_records(&frame));
+    CHECK_EQ(frame.len, walk(big, frame.len));
+
+    uint8_t too_long[1];
+    sensor_frame_begin(&frame, big, sizeof(big), BOOT_ID);
+    CHECK(!sensor_frame_add(&frame, SENSOR_RECORD_LUMINOSITY, too_long,
+                            UINT16_MAX + 1));
+    CHECK(!sensor_frame_reserve_tail(&frame, UINT16_MAX + 1));
+    CHECK_EQ(0, sensor_frame_records(&frame));
+}
+
+// A cauda reservada tira espaço das leituras até ser fechada; o valor dela
+// não passa pelo buffer, só o cabeçalho.
+static void test_reserved_tail(void) {
+    const size_t tail = sizeof(SensorPacket);
+    sensor_frame_t frame;
+    sensor_frame_begin(&frame, buf, sizeof(buf), BOOT_ID);
+    CHECK(sensor_frame_reserve_tail(&frame, tail));
+    CHECK(!sensor_frame_reserve_tail(&frame, 0));
+    CHECK_EQ(sizeof(buf) - 4 - tail, frame.capacity);
+
+    // Sem a cauda caberiam 80 leituras; com ela, só as 16 do quadro cheio.
+    int added = 0;
+    for (int i = 0; i < 20; i++) {
+        SensorReading r = reading(SENSOR_RECORD_HUMIDITY, i, i);
+        added += sensor_frame_add_reading(&frame, &r);
+    }
+    CHECK_EQ(16, added);
+    CHECK(!sensor_frame_add(&frame, SENSOR_RECORD_HUMIDITY, NULL, 0));
+    size_t len = frame.len;
+    CHECK_EQ(8 + 16 * 16, len);
+
+    sensor_frame_add_tail(&frame, SENSOR_PACKET_TYPE_AUDIO);
+    CHECK_EQ(17, sensor_frame_records(&frame));
+    CHECK_EQ(len + 4, frame.len);
+    CHECK_EQ(sizeof(buf), frame.capacity);
+    CHECK_EQ(0, frame.tail);
+    CHECK_EQ(SENSOR_PACKET_TYPE_AUDIO, buf[len]);
+    CHECK_EQ(tail, le16(buf + len + 2));
+
+    // O valor vai logo depois, no espaço que a reserva deixou livre.
+    memset(buf + frame.len, 0x5A, tail);
+    CHECK_EQ(frame.len + tail, walk(buf, frame.len + tail));
+    CHECK_EQ(0, walk(buf, frame.len));
+
+    // Reserva maior que o espaço livre: recusada, quadro intacto.
+    sensor_frame_begin(&frame, buf, 64, BOOT_ID);
+    CHECK(!sensor_frame_reserve_tail(&frame, 64 - 8 - 4 + 1));
+    CHECK_EQ(64, frame.capacity);
+    CHECK(sensor_frame_reserve_tail(&frame, 64 - 8 - 4));
+    CHECK(!sensor_frame_add(&frame, SENSOR_RECORD_HUMIDITY, NULL, 0));
+    sensor_frame_add_tail(&frame, SENSOR_PACKET_TYPE_FEATURES);
+    CHECK_EQ(1, sensor_frame_records(&frame));
+    CHECK_EQ(12, frame.len);
+}
+
+int main(void) {
+    test_layout();
+    test_full_frame();
+    test_record_limit();
+    test_reserved_tail();
+    return host_test_result();
+}
@@ -0,0 +1,98 @@
+// Escritor JSON das leituras: saída exata de um lote pequeno e lotes cheios
+// no pior caso (valores e timestamps mais longos, nome no limite) cabendo em
+// SENSOR_JSON_MAX_BYTES, sem folga além da vírgula que o limite já conta.
+#include <limits.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "sensor_frame.h"
+#include "sensor_json.h"
+
+#define MAX_READINGS 64  // máximo de CONFIG_SENSOR_FRAME_MAX_READINGS
+
+static char buf[SENSOR_JSON_MAX_BYTES(MAX_READINGS)];
+static SensorReading batch[MAX_READINGS];
+
+static const char long_name[SENSOR_JSON_NAME_MAX + 1] = "luminosity_sensr";
+
+static void test_exact_output(void) {
+    const SensorReading dht[] = {
+        {SENSOR_RECORD_TEMPERATURE, "temperature", -101, 1718000000123},
+        {SENSOR_RECORD_HUMIDITY, "humidity", 652, 1718000000123},
+        {SENSOR_RECORD_TEMPERATURE, "temperature", 234, 1718000002123},
+        {SENSOR_RECORD_HUMIDITY, "humidity", 550, 1718000002123},
+    };
+    const SensorReading ldr[] = {
+        {SENSOR_RECORD_LUMINOSITY, "luminosity", 1023, 1718000000500},
+        {SENSOR_RECORD_LUMINOSITY, "luminosity", 0, 1718000001500},
+    };
+    CHECK(sensor_json_encode(dht, 4, buf, sizeof(buf)) > 0);
+    CHECK(strcmp(buf,
+                 "{\"data\":[{\"temperature\":-101,\"humidity\":652,"
+                 "\"timestamp\":1718000000123},{\"temperature\":234,"
+                 "\"humidity\":550,\"timestamp\":1718000002123}],"
+                 "\"type\":\"dht\"}") == 0);
+    CHECK(sensor_json_encode(ldr, 2, buf, sizeof(buf)) > 0);
+    CHECK(strcmp(buf,
+                 "{\"data\":[{\"sample\":1023,\"timestamp\":1718000000500},"
+                 "{\"sample\":0,\"timestamp\":1718000001500}],"
+                 "\"type\":\"luminosity\"}") == 0);
+    CHECK_EQ(0, sensor_json_encode(ldr, 0, buf, sizeof(buf)));
+}
+
+static void test_full_batches(void) {
+    for (size_t n = 1; n <= MAX_READINGS; n++) {
+        for (size_t i = 0; i < n; i++) {
+            batch[i] = (SensorReading){SENSOR_RECORD_LUMINOSITY, long_name,
+                                       INT_MIN, INT64_MIN};
+        }
+        size_t cap = SENSOR_JSON_MAX_BYTES(n);
+        size_t len = sensor_json_encode(batch, n, buf, cap);
+        CHECK(len > 0);
+        CHECK_EQ(cap - 2, len);  // o limite conta n vírgulas, saem n - 1
+        CHECK_EQ(len, strlen(buf));
+        CHECK_EQ(0, sensor_json_encode(batch, n, buf, len));
+        CHECK_EQ(0, buf[0]);
+
+        // Pares do DHT com os mesmos extremos ocupam menos.
+        for (size_t i = 0; i < n; i++) {
+            batch[i] = (SensorReading){
+                i % 2 ? SENSOR_RECORD_HUMIDITY : SENSOR_RECORD_TEMPERATURE,
+                "temperature", INT_MIN, INT64_MIN};
+        }
+        CHECK(sensor_json_encode(batch, n, buf, cap) > 0);
+    }
+
+    // Nome maior que o limite não cabe; o chamador conta o descarte.
+    for (size_t i = 0; i < MAX_READINGS; i++) {
+        batch[i] = (SensorReading){SENSOR_RECORD_LUMINOSITY,
+                                   "luminosity_sensor_raw", INT_MIN, INT64_MIN};
+    }
+    CHECK_EQ(0, sensor_json_encode(batch, MAX_READINGS, buf,
+                                   SENSOR_JSON_MAX_BYTES(MAX_READINGS)));
+}
+
+// websocket_client.c limita o lote para a mensagem caber num registro do
+// spool (SENSOR_FRAME_MAX_BYTES); o limite tem que deixar lotes úteis.
+static void test_spool_record_batch(void) {
+    size_t fit = (SENSOR_FRAME_MAX_BYTES - SENSOR_JSON_MAX_BYTES(0)) /
+                 SENSOR_JSON_READING_MAX_BYTES;
+    CHECK(fit >= 16);
+    for (size_t i = 0; i < fit; i++) {
+        batch[i] = (SensorReading){SENSOR_RECORD_LUMINOSITY, long_name,
+                                   INT_MIN, INT64_MIN};
+    }
+    size_t len = sensor_json_encode(batch, fit, buf, sizeof(buf));
+    CHECK(len > 0);
+    CHECK(len <= SENSOR_FRAME_MAX_BYTES);
+    printf("worst-case JSON batch for one spool record: %zu readings, "
+           "%zu of %zu bytes\n",
+           fit, len, (size_t)SENSOR_FRAME_MAX_BYTES);
+}
+
+int main(void) {
+    test_exact_output();
+    test_full_batches();
+    test_spool_record_batch();
+    return host_test_result();
+}
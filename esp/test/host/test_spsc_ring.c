@@ -0,0 +1,163 @@
+// Anel SPSC com uma thread produtora e uma consumidora, como o amostrador e
+// a send_task. O produtor empurra números de sequência; cada número precisa
+// sair exatamente uma vez, ou pelo consumidor, em ordem, ou como descarte
+// contado. Elementos de 16 bytes verificam também que nenhuma cópia sai
+// rasgada entre o produtor e o consumidor.
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "spsc_ring.h"
+
+#define CAPACITY 16
+#define PUSHES 2000000
+#define POP_MAX 8
+
+typedef struct {
+    uint32_t seq;
+    uint32_t check[3];
+} wide_elem_t;
+
+typedef struct {
+    spsc_ring_t ring;
+    size_t elem_size;
+    uint8_t *seen;  // vezes que cada sequência saiu (pop ou descarte)
+    uint32_t evicted;
+    uint32_t popped;
+    uint32_t out_of_order;
+    uint32_t torn;
+    atomic_bool done;
+} run_t;
+
+static void make_elem(run_t *r, uint32_t seq, void *out) {
+    if (r->elem_size == sizeof(void *)) {
+        *(void **)out = (void *)(uintptr_t)seq;
+    } else {
+        wide_elem_t *e = out;
+        e->seq = seq;
+        e->check[0] = ~seq;
+        e->check[1] = seq * 2654435761u;
+        e->check[2] = seq ^ 0xA5A5A5A5u;
+    }
+}
+
+static uint32_t elem_seq(run_t *r, const void *elem) {
+    if (r->elem_size == sizeof(void *)) {
+        return (uint32_t)(uintptr_t) * (void *const *)elem;
+    }
+    const wide_elem_t *e = elem;
+    if (e->check[0] != ~e->seq || e->check[1] != e->seq * 2654435761u ||
+        e->check[2] != (e->seq ^ 0xA5A5A5A5u)) {
+        r->torn++;
+    }
+    return e->seq;
+}
+
+static void mark_seen(run_t *r, uint32_t seq) {
+    if (seq >= 1 && seq <= PUSHES) {
+        r->seen[seq]++;
+    }
+}
+
+// O descarte do mais antigo roda na thread produtora; cada thread tem os
+// próprios contadores, então não há corrida entre elas.
+static void *producer(void *arg) {
+    run_t *r = arg;
+    wide_elem_t elem, evicted;
+    unsigned seed = 2;
+    for (uint32_t seq = 1; seq <= PUSHES; seq++) {
+        make_elem(r, seq, &elem);
+        if (spsc_ring_push(&r->ring, &elem, &evicted) == SPSC_RING_EVICTED) {
+            mark_seen(r, elem_seq(r, &evicted));
+            r->evicted++;
+        }
+        // Rajadas de tamanho aleatório, em média maiores que o anel: parte
+        // cabe, parte encontra o anel cheio.
+        if (rand_r(&seed) % (2 * CAPACITY) == 0) {
+            sched_yield();
+        }
+    }
+    atomic_store(&r->done, true);
+    return NULL;
+}
+
+static void *consumer(void *arg) {
+    run_t *r = arg;
+    wide_elem_t out[POP_MAX];
+    uint32_t last = 0;
+    unsigned seed = 1;
+    while (1) {
+        bool done = atomic_load(&r->done);
+        // Lotes de tamanho variável, como os drenos da send_task.
+        size_t n = spsc_ring_pop(&r->ring, out, 1 + rand_r(&seed) % POP_MAX);
+        for (size_t i = 0; i < n; i++) {
+            uint32_t seq = elem_seq(r, (uint8_t *)out + i * r->elem_size);
+            if (seq <= last) {
+                r->out_of_order++;
+            }
+            last = seq;
+            mark_seen(r, seq);
+            r->popped++;
+        }
+        if (n == 0 && done) {
+            break;
+        }
+        if (n == 0) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void run_policy(spsc_ring_policy_t policy, size_t elem_size,
+                       const char *name) {
+    static uint8_t storage[CAPACITY * sizeof(wide_elem_t)];
+    run_t *r = calloc(1, sizeof(*r));
+    r->seen = calloc(PUSHES + 1, 1);
+    r->elem_size = elem_size;
+    CHECK(spsc_ring_init(&r->ring, storage, elem_size, CAPACITY, policy));
+
+    pthread_t p, c;
+    pthread_create(&c, NULL, consumer, r);
+    pthread_create(&p, NULL, producer, r);
+    pthread_join(p, NULL);
+    pthread_join(c, NULL);
+
+    spsc_ring_stats_t stats;
+    spsc_ring_get_stats(&r->ring, &stats);
+    uint32_t never = 0, twice = 0;
+    for (uint32_t seq = 1; seq <= PUSHES; seq++) {
+        never += r->seen[seq] == 0;
+        twice += r->seen[seq] > 1;
+    }
+    printf("%-12s %2zu B: %u popped, %u dropped newest, %u dropped oldest, "
+           "high water %u\n",
+           name, elem_size, stats.popped, stats.dropped_newest,
+           stats.dropped_oldest, stats.high_water);
+
+    CHECK_EQ(0, r->out_of_order);
+    CHECK_EQ(0, r->torn);
+    CHECK_EQ(0, twice);
+    CHECK_EQ(r->popped, stats.popped);
+    CHECK_EQ(r->evicted, stats.dropped_oldest);
+    CHECK_EQ(PUSHES, stats.pushed + stats.dropped_newest);
+    CHECK_EQ(stats.pushed, stats.popped + stats.dropped_oldest);
+    // Só o descarte do novo some sem passar pelo consumidor ou por
+    // `evicted`; todo o resto foi visto exatamente uma vez.
+    CHECK_EQ(stats.dropped_newest, never);
+    CHECK(stats.high_water <= CAPACITY);
+    CHECK_EQ(0, spsc_ring_count(&r->ring));
+
+    free(r->seen);
+    free(r);
+}
+
+int main(void) {
+    run_policy(SPSC_RING_DROP_NEWEST, sizeof(void *), "drop newest");
+    run_policy(SPSC_RING_DROP_NEWEST, sizeof(wide_elem_t), "drop newest");
+    run_policy(SPSC_RING_DROP_OLDEST, sizeof(void *), "drop oldest");
+    run_policy(SPSC_RING_DROP_OLDEST, sizeof(wide_elem_t), "drop oldest");
+    return host_test_result();
+}
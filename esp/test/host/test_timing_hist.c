@@ -0,0 +1,157 @@
+// Percentis do histograma de tempos sobre distribuições conhecidas: vazio,
+// tudo num balde, transbordo e o arredondamento da posição do percentil.
+// O valor devolvido é o limite superior do balde, limitado ao máximo.
+#include <string.h>
+
+#include "host_test.h"
+#include "timing_hist.h"
+
+static timing_hist_t hist;
+
+static void test_empty(void) {
+    timing_hist_init(&hist, 100);
+    CHECK_EQ(0, hist.count);
+    CHECK_EQ(0, timing_hist_percentile(&hist, 0));
+    CHECK_EQ(0, timing_hist_percentile(&hist, 500));
+    CHECK_EQ(0, timing_hist_percentile(&hist, 1000));
+
+    TimingSummary s;
+    memset(&s, 0xA5, sizeof(s));
+    timing_hist_summary(&hist, 160, &s);
+    TimingSummary zero = {0};
+    CHECK(memcmp(&s, &zero, sizeof(s)) == 0);
+
+    // Sem frequência conhecida também não há resumo.
+    timing_hist_record(&hist, 1000);
+    memset(&s, 0xA5, sizeof(s));
+    timing_hist_summary(&hist, 0, &s);
+    CHECK(memcmp(&s, &zero, sizeof(s)) == 0);
+
+    // Largura 0 vira 1 em vez de dividir por zero.
+    timing_hist_init(&hist, 0);
+    CHECK_EQ(1, hist.width);
+    timing_hist_record(&hist, 7);
+    CHECK_EQ(1, hist.buckets[7]);
+}
+
+// Todas as medidas no balde [200, 300): o limite do balde passa do máximo,
+// então todos os percentis são o máximo observado.
+static void test_one_bucket(void) {
+    timing_hist_init(&hist, 100);
+    for (uint32_t c = 210; c <= 290; c += 10) {
+        timing_hist_record(&hist, c);
+    }
+    CHECK_EQ(9, hist.count);
+    CHECK_EQ(9, hist.buckets[2]);
+    CHECK_EQ(210, hist.min);
+    CHECK_EQ(290, hist.max);
+    CHECK_EQ(290, timing_hist_percentile(&hist, 0));
+    CHECK_EQ(290, timing_hist_percentile(&hist, 500));
+    CHECK_EQ(290, timing_hist_percentile(&hist, 999));
+
+    // Uma medida mais lenta: a mediana passa a ser o limite do balde.
+    timing_hist_record(&hist, 550);
+    CHECK_EQ(300, timing_hist_percentile(&hist, 500));
+    CHECK_EQ(300, timing_hist_percentile(&hist, 900));
+    CHECK_EQ(550, timing_hist_percentile(&hist, 901));
+    CHECK_EQ(550, timing_hist_percentile(&hist, 999));
+
+    // Medida exatamente no limite vai para o balde seguinte.
+    timing_hist_init(&hist, 100);
+    timing_hist_record(&hist, 100);
+    timing_hist_record(&hist, 399);
+    CHECK_EQ(1, hist.buckets[1]);
+    CHECK_EQ(200, timing_hist_percentile(&hist, 500));
+
+    timing_hist_reset(&hist);
+    CHECK_EQ(0, hist.count);
+    CHECK_EQ(0, hist.buckets[1]);
+    CHECK_EQ(0, timing_hist_percentile(&hist, 500));
+}
+
+// A posição é ceil(count * permille / 1000), no mínimo 1.
+static void test_rank_rounding(void) {
+    timing_hist_init(&hist, 10);
+    timing_hist_record(&hist, 10);
+    timing_hist_record(&hist, 20);
+    timing_hist_record(&hist, 30);
+    CHECK_EQ(20, timing_hist_percentile(&hist, 0));     // posição 1
+    CHECK_EQ(20, timing_hist_percentile(&hist, 333));   // 0,999 -> 1
+    CHECK_EQ(30, timing_hist_percentile(&hist, 334));   // 1,002 -> 2
+    CHECK_EQ(30, timing_hist_percentile(&hist, 500));   // 1,5 -> 2
+    CHECK_EQ(30, timing_hist_percentile(&hist, 999));   // 2,997 -> 3
+    CHECK_EQ(30, timing_hist_percentile(&hist, 1000));
+
+    // 0..999 em baldes de 10: p50 e p99 caem no limite de um balde cheio,
+    // p99.9 no último, cujo limite passa do máximo.
+    timing_hist_init(&hist, 10);
+    for (uint32_t c = 0; c < 1000; c++) {
+        timing_hist_record(&hist, c);
+    }
+    CHECK_EQ(500, timing_hist_percentile(&hist, 500));
+    CHECK_EQ(990, timing_hist_percentile(&hist, 990));
+    CHECK_EQ(999, timing_hist_percentile(&hist, 999));
+
+    // Com 1001 medidas o p50 é a 501ª, já no balde seguinte.
+    timing_hist_record(&hist, 999);
+    CHECK_EQ(510, timing_hist_percentile(&hist, 500));
+    CHECK_EQ(999, timing_hist_percentile(&hist, 999));
+}
+
+// Medidas além do último balde caem nele e são contadas em overflow; o
+// percentil que cai ali é o máximo, não o limite do histograma.
+static void test_overflow(void) {
+    const uint32_t width = 100;
+    timing_hist_init(&hist, width);
+    for (int i = 0; i < 999; i++) {
+        timing_hist_record(&hist, 150);
+    }
+    timing_hist_record(&hist, 5 * TIMING_HIST_BUCKETS * width);
+    timing_hist_record(&hist, UINT32_MAX);
+    CHECK_EQ(2, hist.buckets[TIMING_HIST_BUCKETS - 1]);
+    CHECK_EQ(UINT32_MAX, hist.max);
+    CHECK_EQ(200, timing_hist_percentile(&hist, 500));
+    CHECK_EQ(200, timing_hist_percentile(&hist, 998));  // posição 999
+    CHECK_EQ(UINT32_MAX, timing_hist_percentile(&hist, 999));
+
+    // Só transbordo: até a mediana é o máximo.
+    timing_hist_init(&hist, width);
+    timing_hist_record(&hist, TIMING_HIST_BUCKETS * width);
+    timing_hist_record(&hist, TIMING_HIST_BUCKETS * width + 1);
+    CHECK_EQ(TIMING_HIST_BUCKETS * width + 1,
+             timing_hist_percentile(&hist, 0));
+}
+
+// Resumo em ns a 160 ciclos/us: 990 medidas de 160 ciclos (1 us), 9 de
+// 1600 (10 us) e uma que transborda.
+static void test_summary(void) {
+    const uint32_t width = 16;  // 100 ns por balde
+    timing_hist_init(&hist, width);
+    for (int i = 0; i < 990; i++) {
+        timing_hist_record(&hist, 160);
+    }
+    for (int i = 0; i < 9; i++) {
+        timing_hist_record(&hist, 1600);
+    }
+    timing_hist_record(&hist, 16000);
+
+    TimingSummary s;
+    timing_hist_summary(&hist, 160, &s);
+    CHECK_EQ(1000, s.count);
+    CHECK_EQ(1000, s.min_ns);
+    CHECK_EQ(100000, s.max_ns);
+    CHECK_EQ(1100, s.p50_ns);   // balde [1000, 1100) ns
+    CHECK_EQ(1100, s.p99_ns);   // posição 990, ainda no primeiro grupo
+    CHECK_EQ(10100, s.p999_ns);
+    CHECK_EQ(1, s.overflow);
+    CHECK_EQ(28, sizeof(TimingSummary));
+}
+
+int main(void) {
+    test_empty();
+    test_one_bucket();
+    test_rank_rounding();
+    test_overflow();
+    test_summary();
+    return host_test_result();
+}
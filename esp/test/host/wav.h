@@ -0,0 +1,70 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Leitor mínimo de WAV PCM mono (8 ou 16 bits) para os testes de host. As
+// amostras saem como as do ADC: 12 bits sem sinal, centradas em 2048.
+
+#define SAIDA_WAV HOST_TEST_API_DIR "/saida.wav"
+
+static inline uint32_t wav_le(const uint8_t *p, int bytes) {
+    uint32_t v = 0;
+    for (int i = bytes - 1; i >= 0; i--) {
+        v = v << 8 | p[i];
+    }
+    return v;
+}
+
+// Retorna o número de amostras lidas (até `max`), ou -1 se o arquivo não
+// abre ou não é PCM mono.
+static inline long wav_load_adc(const char *path, int16_t *out, size_t max,
+                                uint32_t *rate_hz) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return -1;
+    }
+    uint8_t riff[12], chunk[8], fmt[16];
+    int bits = 0;
+    long n = -1;
+    if (fread(riff, 1, 12, f) != 12 || memcmp(riff, "RIFF", 4) != 0 ||
+        memcmp(riff + 8, "WAVE", 4) != 0) {
+        goto done;
+    }
+    while (fread(chunk, 1, 8, f) == 8) {
+        uint32_t size = wav_le(chunk + 4, 4);
+        if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+            if (fread(fmt, 1, 16, f) != 16) {
+                goto done;
+            }
+            fseek(f, (long)(size - 16 + (size & 1)), SEEK_CUR);
+            bits = (int)wav_le(fmt + 14, 2);
+            *rate_hz = wav_le(fmt + 4, 4);
+            if (wav_le(fmt, 2) != 1 || wav_le(fmt + 2, 2) != 1 ||
+                (bits != 8 && bits != 16)) {
+                goto done;
+            }
+        } else if (memcmp(chunk, "data", 4) == 0 && bits != 0) {
+            size_t bytes = bits / 8;
+            uint8_t s[2];
+            n = 0;
+            while ((size_t)n < max && (size_t)n * bytes < size &&
+                   fread(s, 1, bytes, f) == bytes) {
+                out[n++] = bits == 8
+                               ? (int16_t)(s[0] << 4)
+                               : (int16_t)(((int16_t)wav_le(s, 2) >> 4) +
+                                           2048);
+            }
+            goto done;
+        } else {
+            fseek(f, (long)(size + (size & 1)), SEEK_CUR);
+        }
+    }
+done:
+    fclose(f);
+    if (n < 0) {
+        fprintf(stderr, "%s: not a mono PCM WAV file\n", path);
+    }
+    return n;
+}